@@ -8,23 +8,29 @@ static void* adminConsoleThread(void* data) {
     char cmd[256];
     
     printf("Admin Console Started\n");
-    printf("Commands: list, add, delete <id>, help, quit\n");
+    printf("Commands: list, add, delete <id>, sail <id> on|off, wake, pairs, help, quit\n");
     
     while (console->isRunning) {
         printf("admin> ");
         if (fgets(cmd, sizeof(cmd), stdin) == NULL) break;
         
+        // The room's worker steps these ships, so every command waits for the tick to finish
+        pthread_mutex_lock(console->lock);
         if (strncmp(cmd, "list", 4) == 0) {
             printf("Ships (%d total):\n", console->ships->count);
             for (int i = 0; i < console->ships->count; i++) {
                 Ship* ship = &console->ships->ships[i];
-                printf("[%d] Pos: (%.1f, %.1f)\n", 
-                       i, ship->physicsPos.x, ship->physicsPos.y);
+                printf("[%d] Pos: (%.1f, %.1f) %s\n", 
+                       i, ship->physicsPos.x, ship->physicsPos.y,
+                       (ship->flags & SHIP_FLAG_SAILING) ? "sailing" : "anchored");
             }
         }
         else if (strncmp(cmd, "add", 3) == 0) {
-            // Create ship using proper Box2D initialization
-            b2BodyId newShipId = createShipHull(console->worldId, 0, 0, (b2Rot){1, 0});
+            // Create ship using proper Box2D initialization. The origin cell
+            // always exists, so this thread never opens a new one.
+            b2Vec2 local;
+            b2WorldId world = worldCellWorldAt(console->cells, (b2Vec2){0, 0}, &local);
+            b2BodyId newShipId = createShipHull(world, local.x, local.y, (b2Rot){1, 0});
             if (b2Body_IsValid(newShipId)) {
                 Ship ship = {
                     .id = newShipId,
@@ -32,6 +38,7 @@ static void* adminConsoleThread(void* data) {
                     .screenPos = {0, 0}
                 };
                 addShip(console->ships, ship);
+                recordJournalEvent(console->journal, JOURNAL_SHIP_ADD, 0, 0, 0.0f, 0.0f);
                 printf("Added new ship at origin\n");
             } else {
                 printf("Failed to create ship body\n");
@@ -46,30 +53,69 @@ static void* adminConsoleThread(void* data) {
                     console->ships->ships[i] = console->ships->ships[i + 1];
                 }
                 console->ships->count--;
+                recordJournalEvent(console->journal, JOURNAL_SHIP_DELETE, (uint32_t)id, 0, 0.0f, 0.0f);
                 printf("Deleted ship %d\n", id);
             }
         }
+        else if (strncmp(cmd, "sail", 4) == 0) {
+            int id;
+            char state[8];
+            if (sscanf(cmd, "sail %d %7s", &id, state) == 2 && id >= 0 && id < console->ships->count) {
+                Ship* ship = &console->ships->ships[id];
+                bool sailing = strcmp(state, "on") == 0;
+                // The mirror sync picks the change up and wakes the ship if it is dormant
+                ship->flags = sailing ? SHIP_FLAG_SAILING : SHIP_FLAG_ANCHORED;
+                recordJournalEvent(console->journal, JOURNAL_SHIP_FLAGS, (uint32_t)id, ship->flags, 0.0f, 0.0f);
+                printf("Ship %d %s\n", id, sailing ? "making sail" : "at anchor");
+            }
+        }
+        else if (strncmp(cmd, "wake", 4) == 0) {
+            // Bodies are enabled from the room's tick, not this thread
+            console->wakeRequested = true;
+            printf("Waking dormant ships\n");
+        }
+        else if (strncmp(cmd, "pairs", 5) == 0) {
+            const CollisionPairCounters* pairs = console->collisionPairs;
+            printf("Broadphase pairs at tick %u: %d (peak %d)\n", pairs->tick, pairs->pairs, pairs->peakPairs);
+            for (int a = 0; a < COLLISION_LAYER_COUNT; a++) {
+                for (int b = a; b < COLLISION_LAYER_COUNT; b++) {
+                    if (pairs->kept[a][b] == 0 && pairs->pruned[a][b] == 0) continue;
+                    printf("  %-10s %-10s %6d kept %6d pruned\n", collisionLayerName(a), collisionLayerName(b),
+                           pairs->kept[a][b], pairs->pruned[a][b]);
+                }
+            }
+        }
         else if (strncmp(cmd, "help", 4) == 0) {
             printf("Available commands:\n");
             printf("  list              - List all ships\n");
             printf("  add               - Add a new ship\n");
             printf("  delete <id>       - Delete ship by ID\n");
+            printf("  sail <id> on|off  - Make sail or drop anchor\n");
+            printf("  wake              - Wake all dormant ships\n");
+            printf("  pairs             - Broadphase pairs by collision layer\n");
             printf("  help              - Show this help\n");
             printf("  quit              - Exit admin console\n");
         }
         else if (strncmp(cmd, "quit", 4) == 0) {
+            pthread_mutex_unlock(console->lock);
             break;
         }
+        pthread_mutex_unlock(console->lock);
     }
     
     console->isRunning = false;
     return NULL;
 }
 
-void initAdminConsole(AdminConsole* console, b2WorldId worldId, ShipArray* ships) {
-    console->worldId = worldId;
+void initAdminConsole(AdminConsole* console, WorldCells* cells, ShipArray* ships, pthread_mutex_t* lock,
+                      InputJournal* journal, const CollisionPairCounters* collisionPairs) {
+    console->cells = cells;
     console->ships = ships;
+    console->lock = lock;
+    console->journal = journal;
+    console->collisionPairs = collisionPairs;
     console->isRunning = true;
+    console->wakeRequested = false;
 }
 
 void startAdminConsoleThread(AdminConsole* console) {
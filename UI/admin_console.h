@@ -2,6 +2,7 @@
 #define ADMIN_CONSOLE_H
 
 #include <box2d/box2d.h>  // Add this for b2Body_IsValid
+#include <pthread.h>
 #include <stdbool.h>
 #include "../core/includes.h"
 
@@ -9,12 +10,17 @@
 void addShip(ShipArray* array, Ship ship);
 
 typedef struct {
-    b2WorldId worldId;
+    WorldCells* cells;
     ShipArray* ships;
+    pthread_mutex_t* lock;         // Room lock, held while touching ships or cells
+    InputJournal* journal;         // Room's input journal, edits are replayed from it
+    const CollisionPairCounters* collisionPairs;  // Room's, sampled once a second
     bool isRunning;
+    volatile bool wakeRequested;   // Forwarded to the room by the main loop
 } AdminConsole;
 
-void initAdminConsole(AdminConsole* console, b2WorldId worldId, ShipArray* ships);
+void initAdminConsole(AdminConsole* console, WorldCells* cells, ShipArray* ships, pthread_mutex_t* lock,
+                      InputJournal* journal, const CollisionPairCounters* collisionPairs);
 void startAdminConsoleThread(AdminConsole* console);
 void stopAdminConsole(AdminConsole* console);
 
@@ -21,9 +21,11 @@ bool GuiButtonUpdate(GuiButton* button) {
 }
 
 // Move coordinate conversion function from main.c
-void initAdminWindow(AdminWindow* admin, b2WorldId worldId, ShipArray* ships, Camera2DState* camera) {
-    admin->worldId = worldId;
+void initAdminWindow(AdminWindow* admin, WorldCells* cells, ShipArray* ships, Camera2DState* camera,
+                     InputJournal* journal) {
+    admin->cells = cells;
     admin->ships = ships;
+    admin->journal = journal;
     admin->isOpen = true;
     admin->selectedShipIndex = -1;
     admin->isPositioningShip = false;
@@ -55,7 +57,9 @@ void updateAdminWindow(AdminWindow* admin) {
                 if (isfinite(physicsPos.x) && isfinite(physicsPos.y)) {
                     // Create ship with proper orientation
                     b2Rot rotation = {1.0f, 0.0f};  // Default facing right
-                    b2BodyId newShip = createShipHull(admin->worldId, physicsPos.x, physicsPos.y, rotation);
+                    b2Vec2 local;
+                    b2WorldId world = worldCellWorldAt(admin->cells, physicsPos, &local);
+                    b2BodyId newShip = createShipHull(world, local.x, local.y, rotation);
                     
                     if (b2Body_IsValid(newShip)) {
                         Ship ship = {
@@ -64,6 +68,7 @@ void updateAdminWindow(AdminWindow* admin) {
                             .screenPos = mousePos
                         };
                         addShip(admin->ships, ship);
+                        recordJournalEvent(admin->journal, JOURNAL_SHIP_ADD, 0, 0, physicsPos.x, physicsPos.y);
                         printf("Created new ship at position (%.2f, %.2f)\n", physicsPos.x, physicsPos.y);
                     } else {
                         printf("ERROR: Failed to create ship body at (%.2f, %.2f)\n", physicsPos.x, physicsPos.y);
@@ -111,7 +116,7 @@ void updateAdminWindow(AdminWindow* admin) {
             Ship* ship = &admin->ships->ships[i];
             if (!b2Body_IsValid(ship->id)) continue;  // Skip invalid ships
             
-            b2Vec2 pos = b2Body_GetPosition(ship->id);
+            b2Vec2 pos = worldCellBodyPosition(ship->id);
             char label[64];
             sprintf(label, "Brigantine %d: (%.1f, %.1f)", i, pos.x, pos.y);
             
@@ -134,6 +139,7 @@ void updateAdminWindow(AdminWindow* admin) {
                            (admin->ships->count - i - 1) * sizeof(Ship));
                 }
                 admin->ships->count--;
+                recordJournalEvent(admin->journal, JOURNAL_SHIP_DELETE, (uint32_t)i, 0, 0.0f, 0.0f);
                 admin->selectedShipIndex = -1;
                 break;
             }
@@ -17,13 +17,14 @@ typedef struct {
 } GuiButton;
 
 typedef struct {
-    b2WorldId worldId;
+    WorldCells* cells;
     ShipArray* ships;
     bool isOpen;
     struct nk_context* ctx;
     int selectedShipIndex;
     bool isPositioningShip;  // Add this flag
     Camera2DState* camera;   // Add camera reference
+    InputJournal* journal;   // Room's input journal, edits are replayed from it
 } AdminWindow;
 
 // GuiButton functions declarations
@@ -37,7 +38,8 @@ void addShip(ShipArray* array, Ship ship);
 b2Vec2 screenToPhysics(Vector2 screenPos, const Camera2DState* camera);
 
 // Admin window functions
-void initAdminWindow(AdminWindow* admin, b2WorldId worldId, ShipArray* ships, Camera2DState* camera);
+void initAdminWindow(AdminWindow* admin, WorldCells* cells, ShipArray* ships, Camera2DState* camera,
+                     InputJournal* journal);
 void updateAdminWindow(AdminWindow* admin);
 void closeAdminWindow(AdminWindow* admin);
 
@@ -0,0 +1,182 @@
+// Snapshot bitstream benchmark - round-trips random entity records through
+// the delta encoder at every supported angle precision, checks each decoded
+// field lands within half a quantization step, and reports bytes and encode
+// time per entity for full records and for typical small-move deltas.
+// Exits non-zero if any field is out of bounds.
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../network/bitstream.h"
+
+#define BENCH_ENTITIES 100000
+#define BENCH_WORLD_EXTENT 4000.0f      // Positions in +-4km, many cells either side of the origin
+#define BENCH_MOVE_SPEED 5.0f           // Per-snapshot moves for the delta case
+#define BENCH_SNAPSHOT_DT 0.05f         // 20Hz
+
+typedef struct {
+    double position;                    // Worst error seen, in units of the half step
+    double velocity;
+    double angle;
+    int failures;
+} BoundCheck;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static float randomRange(float min, float max) {
+    return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+// Half a step plus float rounding at the magnitude the quantizer works at
+static void checkBound(BoundCheck* check, double* worst, float error, float halfStep, float magnitude) {
+    float slack = 4.0f * FLT_EPSILON * fmaxf(fabsf(magnitude), 1.0f);
+    double ratio = fabsf(error) / halfStep;
+    if (ratio > *worst) *worst = ratio;
+    if (fabsf(error) > halfStep + slack) check->failures++;
+}
+
+static void checkRecord(BoundCheck* check, const QuantizationConfig* config, const GameEntityState* sent,
+                        const GameEntityState* decoded) {
+    float positionHalf = config->cellSize / (float)(1u << config->positionBits) * 0.5f;
+    float velocityHalf = 2.0f * config->maxSpeed / (float)((1u << config->velocityBits) - 1) * 0.5f;
+    float angleHalf = 3.14159265359f / (float)(1u << config->angleBits);
+
+    // Offsets are taken within the cell, so rounding is at least the cell size's
+    checkBound(check, &check->position, decoded->pos_x - sent->pos_x, positionHalf,
+               fmaxf(fabsf(sent->pos_x), config->cellSize));
+    checkBound(check, &check->position, decoded->pos_y - sent->pos_y, positionHalf,
+               fmaxf(fabsf(sent->pos_y), config->cellSize));
+    checkBound(check, &check->velocity, decoded->velocity_x - sent->velocity_x, velocityHalf, config->maxSpeed);
+    checkBound(check, &check->velocity, decoded->velocity_y - sent->velocity_y, velocityHalf, config->maxSpeed);
+    checkBound(check, &check->angle, remainderf(decoded->rotation - sent->rotation, 6.28318530718f), angleHalf,
+               6.28318530718f);
+}
+
+static GameEntityState randomEntity(uint32_t id, float maxSpeed) {
+    return (GameEntityState){
+        .entity_id = id,
+        .entity_type = (uint8_t)(id & 1),
+        .pos_x = randomRange(-BENCH_WORLD_EXTENT, BENCH_WORLD_EXTENT),
+        .pos_y = randomRange(-BENCH_WORLD_EXTENT, BENCH_WORLD_EXTENT),
+        .velocity_x = randomRange(-maxSpeed, maxSpeed),
+        .velocity_y = randomRange(-maxSpeed, maxSpeed),
+        .rotation = randomRange(-3.14159265f, 3.14159265f),
+        .state_flags = (uint8_t)(rand() & 0xFF)
+    };
+}
+
+// A snapshot's worth of motion, velocity and heading drift a little
+static GameEntityState movedEntity(const GameEntityState* from, float maxSpeed) {
+    GameEntityState moved = *from;
+    moved.velocity_x = fminf(fmaxf(from->velocity_x + randomRange(-0.5f, 0.5f), -maxSpeed), maxSpeed);
+    moved.velocity_y = fminf(fmaxf(from->velocity_y + randomRange(-0.5f, 0.5f), -maxSpeed), maxSpeed);
+    moved.pos_x += randomRange(-BENCH_MOVE_SPEED, BENCH_MOVE_SPEED) * BENCH_SNAPSHOT_DT;
+    moved.pos_y += randomRange(-BENCH_MOVE_SPEED, BENCH_MOVE_SPEED) * BENCH_SNAPSHOT_DT;
+    moved.rotation = remainderf(from->rotation + randomRange(-0.1f, 0.1f), 6.28318530718f);
+    return moved;
+}
+
+// Encodes every record into one stream, then decodes and checks it.
+// baselines may be NULL for full records. Returns encode seconds.
+static double roundTrip(const QuantizationConfig* config, const GameEntityState* baselines,
+                        const GameEntityState* states, GameEntityState* applied, bool* written, int count,
+                        uint8_t* buffer, size_t capacity, size_t* bytes, BoundCheck* check) {
+    BitWriter writer;
+    bitWriterInit(&writer, buffer, capacity);
+    double start = nowSeconds();
+    for (int i = 0; i < count; i++) {
+        written[i] = writeEntityDeltaBits(&writer, config, baselines ? &baselines[i] : NULL, &states[i],
+                                          &applied[i]) > 0;
+    }
+    double elapsed = nowSeconds() - start;
+    *bytes = bitWriterBytes(&writer);
+    if (writer.overflow) {
+        fprintf(stderr, "[Bench] Bitstream buffer overflow\n");
+        check->failures++;
+        return elapsed;
+    }
+
+    // Records with no changed field are skipped by the writer, like the snapshot does
+    BitReader reader;
+    bitReaderInit(&reader, buffer, *bytes);
+    for (int i = 0; i < count; i++) {
+        if (!written[i]) continue;
+        uint32_t id;
+        uint8_t type, fields;
+        GameEntityState decoded = baselines ? baselines[i] : (GameEntityState){0};
+        if (!readEntityDeltaHeader(&reader, &id, &type, &fields) ||
+            !readEntityDeltaFields(&reader, config, fields, &decoded) || id != states[i].entity_id) {
+            fprintf(stderr, "[Bench] Failed to decode record %d\n", i);
+            check->failures++;
+            return elapsed;
+        }
+        decoded.entity_id = id;
+        decoded.entity_type = type;
+        checkRecord(check, config, &states[i], &decoded);
+        // What the client reconstructs must match what the server assumes it has
+        if (memcmp(&decoded, &applied[i], sizeof(GameEntityState)) != 0) check->failures++;
+    }
+    return elapsed;
+}
+
+int main(void) {
+    GameEntityState* states = malloc(BENCH_ENTITIES * sizeof(GameEntityState));
+    GameEntityState* applied = malloc(BENCH_ENTITIES * sizeof(GameEntityState));
+    GameEntityState* moved = malloc(BENCH_ENTITIES * sizeof(GameEntityState));
+    GameEntityState* deltaApplied = malloc(BENCH_ENTITIES * sizeof(GameEntityState));
+    QuantizationConfig widest = defaultQuantizationConfig();
+    widest.angleBits = QUANT_MAX_ANGLE_BITS;
+    size_t capacity = (maxEntityDeltaBits(&widest) * BENCH_ENTITIES + 7) / 8;
+    uint8_t* buffer = malloc(capacity);
+    bool* written = malloc(BENCH_ENTITIES * sizeof(bool));
+    if (!states || !applied || !moved || !deltaApplied || !buffer || !written) {
+        fprintf(stderr, "[Bench] Out of memory for %d entities\n", BENCH_ENTITIES);
+        return 1;
+    }
+
+    int failures = 0;
+    printf("[\n");
+    for (int bits = QUANT_MIN_ANGLE_BITS; bits <= QUANT_MAX_ANGLE_BITS; bits++) {
+        QuantizationConfig config = defaultQuantizationConfig();
+        config.angleBits = bits;
+
+        srand(1);
+        for (int i = 0; i < BENCH_ENTITIES; i++) states[i] = randomEntity((uint32_t)i + 1, config.maxSpeed);
+        BoundCheck check = {0};
+        size_t fullBytes = 0, deltaBytes = 0;
+        double fullSeconds = roundTrip(&config, NULL, states, applied, written, BENCH_ENTITIES, buffer, capacity,
+                                       &fullBytes, &check);
+
+        // Deltas against what the client holds after the full records
+        for (int i = 0; i < BENCH_ENTITIES; i++) moved[i] = movedEntity(&states[i], config.maxSpeed);
+        double deltaSeconds = roundTrip(&config, applied, moved, deltaApplied, written, BENCH_ENTITIES, buffer, capacity,
+                                        &deltaBytes, &check);
+
+        printf("  {\"angle_bits\": %d, \"entities\": %d, \"full_bytes_per_entity\": %.2f, "
+               "\"full_encode_ns\": %.1f, \"delta_bytes_per_entity\": %.2f, \"delta_encode_ns\": %.1f, "
+               "\"max_position_error_half_steps\": %.3f, \"max_velocity_error_half_steps\": %.3f, "
+               "\"max_angle_error_half_steps\": %.3f, \"failures\": %d}%s\n",
+               bits, BENCH_ENTITIES, (double)fullBytes / BENCH_ENTITIES, fullSeconds / BENCH_ENTITIES * 1e9,
+               (double)deltaBytes / BENCH_ENTITIES, deltaSeconds / BENCH_ENTITIES * 1e9, check.position,
+               check.velocity, check.angle, check.failures, bits == QUANT_MAX_ANGLE_BITS ? "" : ",");
+        failures += check.failures;
+    }
+    printf("]\n");
+
+    if (failures > 0) fprintf(stderr, "[Bench] %d fields outside half a quantization step\n", failures);
+    free(states);
+    free(applied);
+    free(moved);
+    free(deltaApplied);
+    free(buffer);
+    free(written);
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,173 @@
+// Lag compensation benchmark - records moving players and a ship into the
+// rewind history for longer than it holds, then casts rays and circles
+// against a rewound tick. Checks that a shot aimed where a target was hits
+// it there and misses it at the latest tick, that the shooter is skipped,
+// that box hits land on the hull's edge and that ticks past the ring are
+// refused. Reports ns per ray over a crowd of bystanders, exits non-zero
+// on any failed check.
+#include <box2d/box2d.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../core/game_state.h"
+#include "../network/game_protocol.h"
+#include "../physics/lag_compensation.h"
+#include "../physics/player/player_physics.h"
+
+#define BENCH_BYSTANDERS 2000
+#define BENCH_TICKS (LAG_HISTORY_SIZE + 16)  // Wraps the ring
+#define BENCH_TICK_DT (1.0f / 60.0f)
+#define BENCH_LATENCY 0.1f                  // Seconds, 6 ticks at 60Hz
+#define BENCH_TARGET_SPEED 40.0f            // Far enough over the rewind that the latest tick misses
+#define BENCH_SHIP_SPEED 20.0f
+#define BENCH_RAYS 100000
+#define BENCH_FRACTION_SLACK 1e-3f
+
+#define BENCH_TARGET ENTITY_KEY(ENTITY_TYPE_PLAYER, 1)
+#define BENCH_SHOOTER ENTITY_KEY(ENTITY_TYPE_PLAYER, 2)  // Moves with the target, between it and the gun
+#define BENCH_SHIP ENTITY_KEY(ENTITY_TYPE_SHIP, 3)
+#define BENCH_BYSTANDER_ID 100
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static float randomRange(float min, float max) {
+    return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+static b2BodyId createMover(b2WorldId worldId, b2Vec2 position, b2Vec2 velocity) {
+    b2BodyDef bodyDef = b2DefaultBodyDef();
+    bodyDef.type = b2_kinematicBody;
+    bodyDef.position = position;
+    bodyDef.linearVelocity = velocity;
+    return b2CreateBody(worldId, &bodyDef);
+}
+
+static int check(bool ok, const char* what) {
+    if (ok) return 0;
+    fprintf(stderr, "[Bench] Check failed: %s\n", what);
+    return 1;
+}
+
+static bool overlapHas(LagHistory* history, uint32_t tick, b2Vec2 center, EntityKey key) {
+    EntityKey found[16];
+    int count = lagHistoryOverlapCircle(history, tick, center, 0.5f, 0, found, 16);
+    for (int i = 0; i < count; i++) {
+        if (found[i] == key) return true;
+    }
+    return false;
+}
+
+int main(void) {
+    int total = BENCH_BYSTANDERS + 3;
+    b2BodyId* bodies = malloc(total * sizeof(b2BodyId));
+    EntityKey* keys = malloc(total * sizeof(EntityKey));
+    b2Vec2* targetAt = malloc((BENCH_TICKS + 1) * sizeof(b2Vec2));
+    b2Vec2* shipAt = malloc((BENCH_TICKS + 1) * sizeof(b2Vec2));
+    LagHistory* history = malloc(sizeof(LagHistory));
+    if (!bodies || !keys || !targetAt || !shipAt || !history || !initLagHistory(history)) {
+        fprintf(stderr, "[Bench] Out of memory for %d entities\n", total);
+        return 1;
+    }
+
+    // A plain world, its bodies read as global
+    b2WorldDef worldDef = b2DefaultWorldDef();
+    worldDef.gravity = (b2Vec2){0.0f, 0.0f};
+    b2WorldId worldId = b2CreateWorld(&worldDef);
+
+    bodies[0] = createMover(worldId, (b2Vec2){0.0f, 0.0f}, (b2Vec2){BENCH_TARGET_SPEED, 0.0f});
+    bodies[1] = createMover(worldId, (b2Vec2){0.0f, -20.0f}, (b2Vec2){BENCH_TARGET_SPEED, 0.0f});
+    bodies[2] = createMover(worldId, (b2Vec2){0.0f, -300.0f}, (b2Vec2){BENCH_SHIP_SPEED, 0.0f});
+    keys[0] = BENCH_TARGET;
+    keys[1] = BENCH_SHOOTER;
+    keys[2] = BENCH_SHIP;
+
+    // Bystanders stay well clear of the checked rays, they only load the grid
+    srand(1);
+    for (int i = 3; i < total; i++) {
+        b2Vec2 position = {randomRange(-500.0f, 500.0f), randomRange(80.0f, 600.0f)};
+        b2Vec2 velocity = {randomRange(-10.0f, 10.0f), randomRange(-10.0f, 10.0f)};
+        bodies[i] = createMover(worldId, position, velocity);
+        keys[i] = ENTITY_KEY((i & 1) ? ENTITY_TYPE_SHIP : ENTITY_TYPE_PLAYER, BENCH_BYSTANDER_ID + i);
+    }
+
+    double recordSeconds = 0.0;
+    for (uint32_t tick = 1; tick <= BENCH_TICKS; tick++) {
+        b2World_Step(worldId, BENCH_TICK_DT, 4);
+        double start = nowSeconds();
+        LagHistoryFrame* frame = beginLagHistoryFrame(history, tick, total);
+        for (int i = 0; i < total; i++) recordLagHistoryBody(frame, keys[i], bodies[i]);
+        finishLagHistoryFrame(history, frame);
+        recordSeconds += nowSeconds() - start;
+        targetAt[tick] = b2Body_GetPosition(bodies[0]);
+        shipAt[tick] = b2Body_GetPosition(bodies[2]);
+    }
+
+    int failures = 0;
+    uint32_t latest = BENCH_TICKS;
+    uint32_t rewind = lagHistoryRewindTick(history, BENCH_LATENCY, BENCH_TICK_DT);
+    failures += check(rewind == latest - (uint32_t)(BENCH_LATENCY / BENCH_TICK_DT + 0.5f), "rewind tick");
+    failures += check(lagHistoryRewindTick(history, 10.0f, BENCH_TICK_DT) == latest - (LAG_HISTORY_SIZE - 1),
+                      "rewind clamped to the oldest tick");
+
+    // Shot from below, aimed at where the target was at the rewound tick
+    b2Vec2 origin = {targetAt[rewind].x, -50.0f};
+    b2Vec2 translation = {0.0f, 100.0f};
+    LagHistoryHit hit;
+    bool found = lagHistoryRayCast(history, rewind, origin, translation, BENCH_SHOOTER, &hit);
+    failures += check(found && hit.key == BENCH_TARGET, "rewound ray hits the target");
+    failures += check(found && fabsf(hit.fraction - (50.0f - PLAYER_RADIUS) / 100.0f) < BENCH_FRACTION_SLACK,
+                      "rewound ray fraction");
+    failures += check(found && hit.normal.y < -0.99f, "rewound ray normal faces the shot");
+    failures += check(!lagHistoryRayCast(history, latest, origin, translation, BENCH_SHOOTER, &hit),
+                      "the same ray misses at the latest tick");
+
+    found = lagHistoryRayCast(history, rewind, origin, translation, 0, &hit);
+    failures += check(found && hit.key == BENCH_SHOOTER &&
+                      fabsf(hit.fraction - (30.0f - PLAYER_RADIUS) / 100.0f) < BENCH_FRACTION_SLACK,
+                      "without an ignore the shooter is hit first");
+
+    b2Vec2 shipOrigin = {shipAt[rewind].x, -350.0f};
+    found = lagHistoryRayCast(history, rewind, shipOrigin, translation, 0, &hit);
+    failures += check(found && hit.key == BENCH_SHIP &&
+                      fabsf(hit.fraction - (50.0f - PHYSICS_SHIP_WIDTH * 0.5f) / 100.0f) < BENCH_FRACTION_SLACK,
+                      "rewound ray hits the hull edge");
+
+    failures += check(overlapHas(history, rewind, targetAt[rewind], BENCH_TARGET), "rewound overlap finds the target");
+    failures += check(!overlapHas(history, latest, targetAt[rewind], BENCH_TARGET),
+                      "the same overlap misses at the latest tick");
+    failures += check(!lagHistoryRayCast(history, latest - LAG_HISTORY_SIZE, origin, translation, 0, &hit),
+                      "ticks past the ring are refused");
+
+    // Random shots through the crowd at the rewound tick
+    int rayHits = 0;
+    double start = nowSeconds();
+    for (int i = 0; i < BENCH_RAYS; i++) {
+        b2Vec2 from = {randomRange(-500.0f, 500.0f), randomRange(80.0f, 600.0f)};
+        float angle = randomRange(-3.14159265f, 3.14159265f);
+        b2Vec2 shot = {cosf(angle) * 50.0f, sinf(angle) * 50.0f};
+        rayHits += lagHistoryRayCast(history, rewind, from, shot, 0, &hit);
+    }
+    double raySeconds = nowSeconds() - start;
+
+    printf("{\"entities\": %d, \"ticks\": %d, \"record_us_per_tick\": %.1f, \"rays\": %d, \"ray_hits\": %d, "
+           "\"ray_ns\": %.1f, \"failures\": %d}\n",
+           total, BENCH_TICKS, recordSeconds / BENCH_TICKS * 1e6, BENCH_RAYS, rayHits,
+           raySeconds / BENCH_RAYS * 1e9, failures);
+
+    if (failures > 0) fprintf(stderr, "[Bench] %d lag compensation checks failed\n", failures);
+    cleanupLagHistory(history);
+    b2DestroyWorld(worldId);
+    free(history);
+    free(bodies);
+    free(keys);
+    free(targetAt);
+    free(shipAt);
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,90 @@
+// Player movement benchmark - per-player force calls against the batched
+// kernel, on a headless world with 1k/5k/10k players under random inputs.
+#include <box2d/box2d.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../physics/player/player_physics.h"
+
+#define BENCH_TICKS 600         // 10s at 60Hz
+#define BENCH_SPACING 3.0f      // meters between players, so nobody touches
+
+static const int benchCounts[] = {1000, 5000, 10000};
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Held keys change every so often, like real players
+static void scriptInputs(uint16_t* flags, int count, int tick) {
+    for (int i = 0; i < count; i++) {
+        if ((tick + i) % 30 == 0) flags[i] = (uint16_t)(rand() & (INPUT_FORWARD | INPUT_BACKWARD | INPUT_LEFT | INPUT_RIGHT));
+    }
+}
+
+static void benchCount(int count) {
+    b2WorldDef worldDef = b2DefaultWorldDef();
+    worldDef.gravity = (b2Vec2){0.0f, 0.0f};
+    b2WorldId worldId = b2CreateWorld(&worldDef);
+
+    b2BodyId* bodies = malloc(count * sizeof(b2BodyId));
+    uint16_t* flags = calloc(count, sizeof(uint16_t));
+    if (!bodies || !flags) {
+        fprintf(stderr, "[Bench] Out of memory for %d players\n", count);
+        free(bodies);
+        free(flags);
+        b2DestroyWorld(worldId);
+        return;
+    }
+
+    int side = 1;
+    while (side * side < count) side++;
+    for (int i = 0; i < count; i++) {
+        bodies[i] = createPlayerBody(worldId, (i % side) * BENCH_SPACING, (i / side) * BENCH_SPACING);
+    }
+
+    PlayerMovementBatch batch = {0};
+    reservePlayerMovementBatch(&batch, count);
+    double perPlayer = 0.0, batched = 0.0;
+    const float dt = 1.0f / 60.0f;
+
+    srand(1);
+    for (int tick = 0; tick < BENCH_TICKS; tick++) {
+        scriptInputs(flags, count, tick);
+
+        // Alternate ticks so both paths see the same world state
+        double start = nowSeconds();
+        if (tick & 1) {
+            for (int i = 0; i < count; i++) addPlayerMovement(&batch, bodies[i], flags[i]);
+            computePlayerMovementForces(&batch);
+            applyPlayerMovementBatch(&batch);
+            batched += nowSeconds() - start;
+        } else {
+            for (int i = 0; i < count; i++) {
+                applyPlayerMovement(bodies[i], flags[i]);
+                limitPlayerVelocity(bodies[i]);
+            }
+            perPlayer += nowSeconds() - start;
+        }
+        b2World_Step(worldId, dt, 4);
+    }
+
+    int ticks = BENCH_TICKS / 2;
+    printf("%6d players: per-player %8.1f us/tick, batched %8.1f us/tick (%.2fx)\n", count,
+           perPlayer / ticks * 1e6, batched / ticks * 1e6, batched > 0.0 ? perPlayer / batched : 0.0);
+
+    freePlayerMovementBatch(&batch);
+    free(bodies);
+    free(flags);
+    b2DestroyWorld(worldId);
+}
+
+int main(void) {
+    for (size_t i = 0; i < sizeof(benchCounts) / sizeof(benchCounts[0]); i++) {
+        benchCount(benchCounts[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,304 @@
+// Physics capacity benchmark - N ships and M players in one headless world,
+// stepped at 60Hz under scripted inputs, in sparse, clustered and colliding
+// layouts. Prints one JSON object per layout with step time percentiles and
+// memory, so capacity can be tracked across releases.
+//
+//   bench_physics [--ships N] [--players M] [--ticks T] [--substeps S] [--layout sparse|clustered|colliding]
+//                 [--collision PAIRS] [--sail]
+//
+// --collision takes a COLLISION_LAYERS list, "all" gives the unfiltered baseline.
+// --sail drives the ships with the wind field and sailing batch instead of
+// scripted thrust, inside the timed tick.
+#include <box2d/box2d.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "../physics/collision_layers.h"
+#include "../physics/player/player_physics.h"
+#include "../physics/ship/ship_sailing.h"
+#include "../physics/ship/ship_shapes.h"
+#include "../world/wind_field.h"
+
+#define BENCH_DEFAULT_SHIPS 200
+#define BENCH_DEFAULT_PLAYERS 2000
+#define BENCH_DEFAULT_TICKS 1800        // 30s at 60Hz
+#define BENCH_WARMUP_TICKS 60           // Not timed, lets the broadphase settle
+#define BENCH_CLUSTER_SIZE 16           // Entities per cluster in the clustered layout
+#define BENCH_SHIP_THRUST 4000.0f       // Newtons along the hull
+#define BENCH_SHIP_TORQUE 1500.0f
+
+typedef enum {
+    LAYOUT_SPARSE,                      // Nothing touches
+    LAYOUT_CLUSTERED,                   // Tight groups far apart, contacts inside each group
+    LAYOUT_COLLIDING,                   // One packed crowd, everyone pushing into it
+    LAYOUT_COUNT
+} BenchLayout;
+
+static const char* layoutNames[LAYOUT_COUNT] = {"sparse", "clustered", "colliding"};
+
+typedef struct {
+    int ships;
+    int players;
+    int ticks;
+    int subSteps;
+    bool sail;
+} BenchConfig;
+
+// Ship and coordinate helpers log through the server's logDebug
+void logDebug(const char* format, ...) {
+    (void)format;
+}
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Resident set in KiB, from /proc - 0 where it isn't available
+static long residentKiB(void) {
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (!file) return 0;
+    long pages = 0, resident = 0;
+    if (fscanf(file, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    fclose(file);
+    return resident * 4;
+}
+
+static long peakResidentKiB(void) {
+    struct rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+}
+
+static int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Position of entity i of count in a layout. Ships and players share the
+// layout so clustered and colliding worlds mix both kinds.
+static b2Vec2 layoutPosition(BenchLayout layout, int i, int count, float spacing) {
+    int side = 1;
+    switch (layout) {
+        case LAYOUT_SPARSE:
+            while (side * side < count) side++;
+            return (b2Vec2){(i % side) * spacing, (i / side) * spacing};
+        case LAYOUT_CLUSTERED: {
+            int clusters = (count + BENCH_CLUSTER_SIZE - 1) / BENCH_CLUSTER_SIZE;
+            while (side * side < clusters) side++;
+            int cluster = i / BENCH_CLUSTER_SIZE;
+            int member = i % BENCH_CLUSTER_SIZE;
+            float cx = (cluster % side) * 100.0f;
+            float cy = (cluster / side) * 100.0f;
+            return (b2Vec2){cx + (member % 4) * spacing * 0.6f, cy + (member / 4) * spacing * 0.6f};
+        }
+        case LAYOUT_COLLIDING:
+        default:
+            while (side * side < count) side++;
+            return (b2Vec2){(i % side) * spacing * 0.4f, (i / side) * spacing * 0.4f};
+    }
+}
+
+// Held keys change every half second or so, staggered like real players
+static void scriptPlayerInputs(uint16_t* flags, int count, int tick, BenchLayout layout) {
+    for (int i = 0; i < count; i++) {
+        if ((tick + i) % 30 != 0) continue;
+        uint16_t keys = (uint16_t)(rand() & (INPUT_FORWARD | INPUT_BACKWARD | INPUT_LEFT | INPUT_RIGHT));
+        // The crowd keeps pushing forward so contacts never settle
+        if (layout == LAYOUT_COLLIDING) keys |= INPUT_FORWARD;
+        flags[i] = keys;
+    }
+}
+
+// Ships hold a thrust and rudder for two seconds at a time
+static void scriptShipInputs(b2BodyId* ships, float* rudder, int count, int tick) {
+    for (int i = 0; i < count; i++) {
+        if ((tick + i * 7) % 120 == 0) rudder[i] = (float)(rand() % 3 - 1);
+        b2Rot rot = b2Body_GetRotation(ships[i]);
+        b2Body_ApplyForceToCenter(ships[i], (b2Vec2){rot.c * BENCH_SHIP_THRUST, rot.s * BENCH_SHIP_THRUST}, true);
+        if (rudder[i] != 0.0f) b2Body_ApplyTorque(ships[i], rudder[i] * BENCH_SHIP_TORQUE, true);
+    }
+}
+
+// Every ship under sail, gathered straight from the bodies - the room reads
+// the same columns from its entity mirror
+static void sailShips(SailingBatch* batch, const b2BodyId* ships, int count, WindField* wind, int tick) {
+    updateWindField(wind, (uint32_t)tick);
+    batch->count = 0;
+    if (!reserveSailingBatch(batch, count)) return;
+    for (int i = 0; i < count; i++) {
+        b2Vec2 p = b2Body_GetPosition(ships[i]);
+        b2Rot rot = b2Body_GetRotation(ships[i]);
+        b2Vec2 v = b2Body_GetLinearVelocity(ships[i]);
+        b2Vec2 air, water;
+        sampleWindField(wind, p.x, p.y, &air, &water);
+        int n = batch->count++;
+        batch->bodies[n] = ships[i];
+        batch->mass[n] = b2Body_GetMass(ships[i]);
+        batch->x[n] = p.x;
+        batch->y[n] = p.y;
+        batch->cos[n] = rot.c;
+        batch->sin[n] = rot.s;
+        batch->vx[n] = v.x;
+        batch->vy[n] = v.y;
+        batch->windX[n] = air.x;
+        batch->windY[n] = air.y;
+        batch->currentX[n] = water.x;
+        batch->currentY[n] = water.y;
+    }
+    computeSailingForces(batch);
+    applySailingForces(batch);
+}
+
+static void benchLayout(BenchLayout layout, const BenchConfig* config, bool last) {
+    long rssBefore = residentKiB();
+
+    b2WorldDef worldDef = b2DefaultWorldDef();
+    worldDef.gravity = (b2Vec2){0.0f, 0.0f};
+    worldDef.enableSleep = true;
+    b2WorldId worldId = b2CreateWorld(&worldDef);
+
+    b2BodyId* ships = malloc((config->ships > 0 ? config->ships : 1) * sizeof(b2BodyId));
+    float* rudder = calloc(config->ships > 0 ? config->ships : 1, sizeof(float));
+    b2BodyId* players = malloc((config->players > 0 ? config->players : 1) * sizeof(b2BodyId));
+    uint16_t* flags = calloc(config->players > 0 ? config->players : 1, sizeof(uint16_t));
+    double* stepTimes = malloc(config->ticks * sizeof(double));
+    if (!ships || !rudder || !players || !flags || !stepTimes) {
+        fprintf(stderr, "[Bench] Out of memory for %d ships and %d players\n", config->ships, config->players);
+        free(ships);
+        free(rudder);
+        free(players);
+        free(flags);
+        free(stepTimes);
+        b2DestroyWorld(worldId);
+        return;
+    }
+
+    // Ships take the first slots of the layout, players the rest
+    int total = config->ships + config->players;
+    for (int i = 0; i < config->ships; i++) {
+        b2Vec2 p = layoutPosition(layout, i, total, 12.0f);
+        ships[i] = createShipHull(worldId, p.x, p.y, b2MakeRot((float)(i % 8) * 0.785f));
+    }
+    for (int i = 0; i < config->players; i++) {
+        b2Vec2 p = layoutPosition(layout, config->ships + i, total, 12.0f);
+        players[i] = createPlayerBody(worldId, p.x, p.y);
+    }
+
+    PlayerMovementBatch batch = {0};
+    reservePlayerMovementBatch(&batch, config->players);
+    SailingBatch sailing = {0};
+    static WindField wind;
+    initWindField(&wind, WIND_DEFAULT_SPEED, 0);
+    const float dt = 1.0f / 60.0f;
+    double contacts = 0.0;
+    int islands = 0;
+
+    srand(1);
+    for (int tick = -BENCH_WARMUP_TICKS; tick < config->ticks; tick++) {
+        scriptPlayerInputs(flags, config->players, tick + BENCH_WARMUP_TICKS, layout);
+
+        // Timed like a room tick: inputs in, then the step
+        double start = nowSeconds();
+        batch.count = 0;
+        for (int i = 0; i < config->players; i++) addPlayerMovement(&batch, players[i], flags[i]);
+        computePlayerMovementForces(&batch);
+        applyPlayerMovementBatch(&batch);
+        if (config->sail) sailShips(&sailing, ships, config->ships, &wind, tick + BENCH_WARMUP_TICKS);
+        else scriptShipInputs(ships, rudder, config->ships, tick + BENCH_WARMUP_TICKS);
+        b2World_Step(worldId, dt, config->subSteps);
+        double elapsed = nowSeconds() - start;
+
+        if (tick < 0) continue;
+        stepTimes[tick] = elapsed;
+        b2Counters counters = b2World_GetCounters(worldId);
+        contacts += counters.contactCount;
+        islands = counters.islandCount;
+    }
+
+    b2Counters counters = b2World_GetCounters(worldId);
+    long rssAfter = residentKiB();
+    qsort(stepTimes, config->ticks, sizeof(double), compareDoubles);
+    double p50 = stepTimes[config->ticks / 2];
+    double p99 = stepTimes[(int)(config->ticks * 0.99)];
+    double worst = stepTimes[config->ticks - 1];
+    double budget = 1.0 / 60.0;
+
+    printf("  {\"layout\": \"%s\", \"ships\": %d, \"players\": %d, \"ticks\": %d, \"substeps\": %d, \"sail\": %s, "
+           "\"p50_us\": %.1f, \"p99_us\": %.1f, \"max_us\": %.1f, \"p99_budget_pct\": %.1f, "
+           "\"collision_matrix\": %u, \"avg_contacts\": %.0f, \"islands\": %d, \"box2d_bytes\": %d, "
+           "\"rss_kib\": %ld, \"rss_delta_kib\": %ld, \"peak_rss_kib\": %ld}%s\n",
+           layoutNames[layout], config->ships, config->players, config->ticks, config->subSteps,
+           config->sail ? "true" : "false", p50 * 1e6,
+           p99 * 1e6, worst * 1e6, p99 / budget * 100.0, getCollisionMatrix(), contacts / config->ticks, islands, counters.byteCount,
+           rssAfter, rssAfter - rssBefore, peakResidentKiB(), last ? "" : ",");
+    fflush(stdout);
+
+    freePlayerMovementBatch(&batch);
+    freeSailingBatch(&sailing);
+    free(ships);
+    free(rudder);
+    free(players);
+    free(flags);
+    free(stepTimes);
+    b2DestroyWorld(worldId);
+}
+
+int main(int argc, char** argv) {
+    BenchConfig config = {BENCH_DEFAULT_SHIPS, BENCH_DEFAULT_PLAYERS, BENCH_DEFAULT_TICKS, 1, false};
+    int only = -1;
+
+    for (int i = 1; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--sail") == 0) {
+            config.sail = true;
+            continue;
+        }
+        if (strcmp(argv[i], "--ships") == 0 && value) {
+            config.ships = atoi(value);
+        } else if (strcmp(argv[i], "--players") == 0 && value) {
+            config.players = atoi(value);
+        } else if (strcmp(argv[i], "--ticks") == 0 && value) {
+            config.ticks = atoi(value);
+        } else if (strcmp(argv[i], "--substeps") == 0 && value) {
+            config.subSteps = atoi(value);
+        } else if (strcmp(argv[i], "--collision") == 0 && value) {
+            if (!configureCollisionLayers(value)) return 2;
+        } else if (strcmp(argv[i], "--layout") == 0 && value) {
+            for (int l = 0; l < LAYOUT_COUNT; l++) {
+                if (strcmp(value, layoutNames[l]) == 0) only = l;
+            }
+            if (only < 0) {
+                fprintf(stderr, "[Bench] Unknown layout %s\n", value);
+                return 2;
+            }
+        } else {
+            fprintf(stderr, "Usage: %s [--ships N] [--players M] [--ticks T] [--substeps S] "
+                            "[--layout sparse|clustered|colliding] [--collision PAIRS] [--sail]\n", argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    if (config.ships < 0 || config.players < 0 || config.ticks < 1 || config.subSteps < 1) {
+        fprintf(stderr, "[Bench] Counts must be positive\n");
+        return 2;
+    }
+
+    // Same ship shapes the server builds
+    initShipPrototypes();
+
+    printf("[\n");
+    for (int l = 0; l < LAYOUT_COUNT; l++) {
+        if (only >= 0 && l != only) continue;
+        bool last = only >= 0 || l == LAYOUT_COUNT - 1;
+        benchLayout((BenchLayout)l, &config, last);
+    }
+    printf("]\n");
+    return 0;
+}
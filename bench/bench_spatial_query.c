@@ -0,0 +1,260 @@
+// Spatial query benchmark - scatters tagged bodies over a 3x3 block of world
+// cells and runs the same radius and box queries three ways: direct on a
+// fresh tick (memo misses), repeated within the tick (memo hits) and queued
+// as one batch on the next tick, with clustered queries so groups merge.
+// Every result is checked against a brute-force scan of the bodies, and the
+// memo and batch paths against the direct one. Reports ns per query and
+// overlap calls per path, exits non-zero on any mismatch.
+#include <box2d/box2d.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../core/game_state.h"
+#include "../network/game_protocol.h"
+#include "../physics/spatial_query.h"
+
+#define BENCH_BODIES 20000
+#define BENCH_QUERIES 512               // Half radius, half box - within the memo's comfortable load
+#define BENCH_CLUSTER_SIZE 8            // Queries around one point, so batch groups can merge
+#define BENCH_WORLD_EXTENT 1400.0f      // Bodies in +-1.4km, cells (-1..1, -1..1) at the default size
+#define BENCH_BODY_RADIUS 1.0f
+#define BENCH_BOUND_SLACK 0.01f         // Bodies this close to a query's edge may fall either way
+
+typedef struct {
+    b2Vec2* positions;                  // Global, by slot
+    int count;
+} BenchBodies;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static float randomRange(float min, float max) {
+    return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+static bool createBodies(WorldCells* cells, BenchBodies* bodies) {
+    for (int i = 0; i < bodies->count; i++) {
+        b2Vec2 position = {randomRange(-BENCH_WORLD_EXTENT, BENCH_WORLD_EXTENT),
+                           randomRange(-BENCH_WORLD_EXTENT, BENCH_WORLD_EXTENT)};
+        b2Vec2 local;
+        b2WorldId worldId = worldCellWorldAt(cells, position, &local);
+        if (B2_IS_NULL(worldId)) {
+            fprintf(stderr, "[Bench] No cell for body %d at (%.1f, %.1f)\n", i, position.x, position.y);
+            return false;
+        }
+
+        b2BodyDef bodyDef = b2DefaultBodyDef();
+        bodyDef.position = local;
+        bodyDef.userData = ENTITY_MIRROR_TAG(ENTITY_TYPE_PLAYER, i);
+        b2BodyId body = b2CreateBody(worldId, &bodyDef);
+        b2ShapeDef shapeDef = b2DefaultShapeDef();
+        b2Circle circle = {{0.0f, 0.0f}, BENCH_BODY_RADIUS};
+        b2CreateCircleShape(body, &shapeDef, &circle);
+        bodies->positions[i] = position;
+    }
+    return true;
+}
+
+static SpatialQuery randomQuery(int index, b2Vec2 clusterCenter) {
+    b2Vec2 center = {clusterCenter.x + randomRange(-10.0f, 10.0f), clusterCenter.y + randomRange(-10.0f, 10.0f)};
+    float extent = randomRange(5.0f, 40.0f);
+    SpatialQuery query = {
+        .box = {{center.x - extent, center.y - extent}, {center.x + extent, center.y + extent}},
+        .filter = b2DefaultQueryFilter()
+    };
+    if (index & 1) {
+        query.center = center;
+        query.radius = extent;
+    }
+    return query;
+}
+
+static SpatialQueryResult runDirect(SpatialQueryService* service, const SpatialQuery* query) {
+    return query->radius > 0.0f ? querySpatialRadius(service, query->center, query->radius, query->filter)
+                                : querySpatialAABB(service, query->box, query->filter);
+}
+
+static int queueBatched(SpatialQueryService* service, const SpatialQuery* query) {
+    return query->radius > 0.0f ? queueSpatialRadius(service, query->center, query->radius, query->filter)
+                                : queueSpatialAABB(service, query->box, query->filter);
+}
+
+// Signed distance from a body's bounds to the query's edge, positive inside
+static float queryMargin(const SpatialQuery* query, b2Vec2 p) {
+    float inside = fminf(fminf(p.x + BENCH_BODY_RADIUS - query->box.lowerBound.x,
+                               query->box.upperBound.x - (p.x - BENCH_BODY_RADIUS)),
+                         fminf(p.y + BENCH_BODY_RADIUS - query->box.lowerBound.y,
+                               query->box.upperBound.y - (p.y - BENCH_BODY_RADIUS)));
+    if (query->radius > 0.0f) {
+        float dx = p.x - query->center.x;
+        float dy = p.y - query->center.y;
+        inside = fminf(inside, query->radius - sqrtf(dx * dx + dy * dy));
+    }
+    return inside;
+}
+
+static int compareInts(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Slots of a result, sorted
+static int resultSlots(const SpatialQueryService* service, SpatialQueryResult result, int* out) {
+    const SpatialQueryHit* hits = spatialQueryHits(service, result);
+    for (int i = 0; i < result.count; i++) out[i] = hits[i].slot;
+    qsort(out, result.count, sizeof(int), compareInts);
+    return result.count;
+}
+
+// Mismatches between a result and the brute-force scan, ignoring bodies on the edge
+static int checkAgainstScan(const SpatialQueryService* service, SpatialQueryResult result,
+                            const SpatialQuery* query, const BenchBodies* bodies, bool* seen) {
+    int mismatches = 0;
+    const SpatialQueryHit* hits = spatialQueryHits(service, result);
+    for (int i = 0; i < result.count; i++) {
+        int slot = hits[i].slot;
+        if (slot < 0 || slot >= bodies->count || seen[slot]) {
+            mismatches++;
+            continue;
+        }
+        seen[slot] = true;
+        if (queryMargin(query, bodies->positions[slot]) < -BENCH_BOUND_SLACK) mismatches++;
+    }
+    for (int slot = 0; slot < bodies->count; slot++) {
+        if (!seen[slot] && queryMargin(query, bodies->positions[slot]) > BENCH_BOUND_SLACK) mismatches++;
+        seen[slot] = false;
+    }
+    return mismatches;
+}
+
+static int compareResults(const SpatialQueryService* service, SpatialQueryResult a, const int* expected,
+                          int expectedCount, int* scratch) {
+    if (a.count != expectedCount) return 1;
+    resultSlots(service, a, scratch);
+    return memcmp(scratch, expected, (size_t)expectedCount * sizeof(int)) != 0;
+}
+
+int main(void) {
+    BenchBodies bodies = {malloc(BENCH_BODIES * sizeof(b2Vec2)), BENCH_BODIES};
+    SpatialQuery* queries = malloc(BENCH_QUERIES * sizeof(SpatialQuery));
+    int* handles = malloc(BENCH_QUERIES * sizeof(int));
+    int* expectedFirst = malloc(BENCH_QUERIES * sizeof(int));
+    int* expectedCount = malloc(BENCH_QUERIES * sizeof(int));
+    int* scratch = malloc(BENCH_BODIES * sizeof(int));
+    bool* seen = calloc(BENCH_BODIES, sizeof(bool));
+    if (!bodies.positions || !queries || !handles || !expectedFirst || !expectedCount || !scratch || !seen) {
+        fprintf(stderr, "[Bench] Out of memory for %d queries\n", BENCH_QUERIES);
+        return 1;
+    }
+
+    WorldCells cells;
+    b2WorldDef worldDef = b2DefaultWorldDef();
+    worldDef.gravity = (b2Vec2){0.0f, 0.0f};
+    SpatialQueryService service;
+    if (!initWorldCells(&cells, WORLD_CELL_DEFAULT_SIZE, &worldDef, 0, 0) ||
+        !initSpatialQueryService(&service, &cells)) {
+        return 1;
+    }
+
+    srand(1);
+    if (!createBodies(&cells, &bodies)) return 1;
+    b2Vec2 clusterCenter = {0.0f, 0.0f};
+    for (int i = 0; i < BENCH_QUERIES; i++) {
+        if (i % BENCH_CLUSTER_SIZE == 0) {
+            clusterCenter = (b2Vec2){randomRange(-BENCH_WORLD_EXTENT, BENCH_WORLD_EXTENT),
+                                     randomRange(-BENCH_WORLD_EXTENT, BENCH_WORLD_EXTENT)};
+        }
+        queries[i] = randomQuery(i, clusterCenter);
+    }
+
+    int failures = 0;
+
+    // Fresh tick - every query misses the memo and goes to the broadphase
+    beginSpatialQueryTick(&service, 1);
+    double start = nowSeconds();
+    for (int i = 0; i < BENCH_QUERIES; i++) {
+        SpatialQueryResult result = runDirect(&service, &queries[i]);
+        expectedFirst[i] = result.first;
+        expectedCount[i] = result.count;
+    }
+    double missSeconds = nowSeconds() - start;
+    uint32_t missOverlaps = service.overlapCalls;
+    if (service.memoHits != 0) failures++;
+
+    // Sorted slots of each direct result, what the other paths must return
+    int slotCount = 0;
+    for (int i = 0; i < BENCH_QUERIES; i++) slotCount += expectedCount[i];
+    int* expectedSlots = malloc(((size_t)slotCount + 1) * sizeof(int));
+    if (!expectedSlots) {
+        fprintf(stderr, "[Bench] Out of memory for %d expected hits\n", slotCount);
+        return 1;
+    }
+    for (int i = 0, offset = 0; i < BENCH_QUERIES; i++) {
+        SpatialQueryResult result = {expectedFirst[i], expectedCount[i]};
+        failures += checkAgainstScan(&service, result, &queries[i], &bodies, seen);
+        resultSlots(&service, result, expectedSlots + offset);
+        expectedFirst[i] = offset;
+        offset += result.count;
+    }
+
+    // Same tick again - memoized queries skip the broadphase, the rest (if
+    // the probe window was full) are resolved again
+    start = nowSeconds();
+    for (int i = 0; i < BENCH_QUERIES; i++) {
+        SpatialQueryResult result = runDirect(&service, &queries[i]);
+        failures += compareResults(&service, result, expectedSlots + expectedFirst[i], expectedCount[i], scratch);
+    }
+    double hitSeconds = nowSeconds() - start;
+    uint32_t memoHits = service.memoHits;
+    if (memoHits == 0 || service.overlapCalls - missOverlaps != BENCH_QUERIES - memoHits) failures++;
+
+    // Next tick, batched - the memo has expired and each cluster shares a pass
+    beginSpatialQueryTick(&service, 2);
+    start = nowSeconds();
+    for (int i = 0; i < BENCH_QUERIES; i++) handles[i] = queueBatched(&service, &queries[i]);
+    runSpatialQueryBatch(&service);
+    double batchSeconds = nowSeconds() - start;
+    uint32_t batchOverlaps = service.overlapCalls;
+    if (service.memoHits != 0) failures++;
+    for (int i = 0; i < BENCH_QUERIES; i++) {
+        SpatialQueryResult result = spatialQueryBatchResult(&service, handles[i]);
+        failures += compareResults(&service, result, expectedSlots + expectedFirst[i], expectedCount[i], scratch);
+    }
+
+    // Repeats queued after the run are answered from the memo the batch left
+    for (int i = 0; i < BENCH_QUERIES; i++) handles[i] = queueBatched(&service, &queries[i]);
+    runSpatialQueryBatch(&service);
+    if (service.memoHits == 0 || service.overlapCalls - batchOverlaps > BENCH_QUERIES - service.memoHits) failures++;
+    for (int i = 0; i < BENCH_QUERIES; i++) {
+        SpatialQueryResult result = spatialQueryBatchResult(&service, handles[i]);
+        failures += compareResults(&service, result, expectedSlots + expectedFirst[i], expectedCount[i], scratch);
+    }
+
+    printf("{\"bodies\": %d, \"queries\": %d, \"cells\": %d, \"hits_per_query\": %.2f, "
+           "\"miss_ns\": %.1f, \"miss_overlap_calls\": %u, \"repeat_ns\": %.1f, \"memo_hits\": %u, "
+           "\"batch_ns\": %.1f, \"batch_overlap_calls\": %u, \"failures\": %d}\n",
+           BENCH_BODIES, BENCH_QUERIES, cells.cellCount, (double)slotCount / BENCH_QUERIES,
+           missSeconds / BENCH_QUERIES * 1e9, missOverlaps, hitSeconds / BENCH_QUERIES * 1e9, memoHits,
+           batchSeconds / BENCH_QUERIES * 1e9, batchOverlaps, failures);
+
+    if (failures > 0) fprintf(stderr, "[Bench] %d query results disagree\n", failures);
+    cleanupSpatialQueryService(&service);
+    cleanupWorldCells(&cells);
+    free(bodies.positions);
+    free(queries);
+    free(handles);
+    free(expectedFirst);
+    free(expectedCount);
+    free(expectedSlots);
+    free(scratch);
+    free(seen);
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+#include "game_state.h"
+#include "../network/game_protocol.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+bool reserveEntityStateArrays(EntityStateArrays* arrays, int count) {
+    if (arrays->capacity >= count) return true;
+
+    int new_capacity = arrays->capacity ? arrays->capacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    float* x = realloc(arrays->x, new_capacity * sizeof(float));
+    if (x) arrays->x = x;
+    float* y = realloc(arrays->y, new_capacity * sizeof(float));
+    if (y) arrays->y = y;
+    float* vx = realloc(arrays->vx, new_capacity * sizeof(float));
+    if (vx) arrays->vx = vx;
+    float* vy = realloc(arrays->vy, new_capacity * sizeof(float));
+    if (vy) arrays->vy = vy;
+    float* rot = realloc(arrays->rot, new_capacity * sizeof(float));
+    if (rot) arrays->rot = rot;
+    uint8_t* flags = realloc(arrays->flags, new_capacity * sizeof(uint8_t));
+    if (flags) arrays->flags = flags;
+    uint8_t* stateFlags = realloc(arrays->stateFlags, new_capacity * sizeof(uint8_t));
+    if (stateFlags) arrays->stateFlags = stateFlags;
+    uint32_t* ids = realloc(arrays->ids, new_capacity * sizeof(uint32_t));
+    if (ids) arrays->ids = ids;
+    b2BodyId* bodies = realloc(arrays->bodies, new_capacity * sizeof(b2BodyId));
+    if (bodies) arrays->bodies = bodies;
+    uint32_t* changed = realloc(arrays->changedTick, new_capacity * sizeof(uint32_t));
+    if (changed) arrays->changedTick = changed;
+    int* dirty = realloc(arrays->dirty, new_capacity * sizeof(int));
+    if (dirty) arrays->dirty = dirty;
+
+    if (!x || !y || !vx || !vy || !rot || !flags || !stateFlags || !ids || !bodies || !changed || !dirty) {
+        fprintf(stderr, "[Mirror] Failed to grow entity state arrays to %d\n", new_capacity);
+        return false;
+    }
+
+    // New slots start empty so the first sync fills them
+    memset(flags + arrays->capacity, 0, new_capacity - arrays->capacity);
+    memset(stateFlags + arrays->capacity, 0, new_capacity - arrays->capacity);
+    memset(bodies + arrays->capacity, 0, (new_capacity - arrays->capacity) * sizeof(b2BodyId));
+    memset(changed + arrays->capacity, 0, (new_capacity - arrays->capacity) * sizeof(uint32_t));
+    arrays->capacity = new_capacity;
+    return true;
+}
+
+// Each slot is listed at most once per sync, ticks start at 1
+void markEntityStateDirty(EntityStateArrays* arrays, int slot, uint32_t tick) {
+    if (arrays->changedTick[slot] == tick) return;
+    arrays->changedTick[slot] = tick;
+    arrays->dirty[arrays->dirtyCount++] = slot;
+}
+
+// Point a slot at a body and read its state directly - only needed when the
+// owning array changed, every other update comes from move events
+void setEntityStateSlot(EntityStateArrays* arrays, uint8_t kind, int slot, b2BodyId body, uint32_t id,
+                        uint32_t tick) {
+    if (slot < 0 || slot >= arrays->capacity) return;
+
+    markEntityStateDirty(arrays, slot, tick);
+    arrays->bodies[slot] = body;
+    arrays->ids[slot] = id;
+    if (!b2Body_IsValid(body)) {
+        arrays->flags[slot] = 0;
+        arrays->x[slot] = arrays->y[slot] = 0.0f;
+        arrays->vx[slot] = arrays->vy[slot] = 0.0f;
+        arrays->rot[slot] = 0.0f;
+        return;
+    }
+
+    b2Transform xf = worldCellBodyTransform(body);
+    b2Vec2 vel = b2Body_GetLinearVelocity(body);
+    arrays->x[slot] = xf.p.x;
+    arrays->y[slot] = xf.p.y;
+    arrays->vx[slot] = vel.x;
+    arrays->vy[slot] = vel.y;
+    arrays->rot[slot] = atan2f(xf.q.s, xf.q.c);
+    arrays->flags[slot] = ENTITY_STATE_ACTIVE;
+    b2Body_SetUserData(body, ENTITY_MIRROR_TAG(kind, slot));
+}
+
+static EntityStateArrays* mirrorArrays(EntityStateMirror* mirror, uint8_t kind) {
+    switch (kind) {
+        case ENTITY_TYPE_PLAYER: return &mirror->players;
+        case ENTITY_TYPE_SHIP:   return &mirror->ships;
+        default:                 return NULL;
+    }
+}
+
+// Only bodies that moved this step produce events. Velocity isn't carried
+// in the event, so it's the one Box2D read left per moving body.
+void applyEntityMoveEvents(EntityStateMirror* mirror, const WorldCells* cells, uint32_t tick) {
+    mirror->tick = tick;
+    mirror->lastMoveCount = 0;
+    mirror->players.dirtyCount = 0;
+    mirror->ships.dirtyCount = 0;
+
+    for (int c = 0; c < cells->cellCount; c++) {
+        b2BodyEvents events = b2World_GetBodyEvents(cells->cells[c].worldId);
+        b2Vec2 origin = cells->cells[c].origin;
+
+        for (int i = 0; i < events.moveCount; i++) {
+            const b2BodyMoveEvent* event = &events.moveEvents[i];
+            if (!event->userData) continue;
+
+            EntityStateArrays* arrays = mirrorArrays(mirror, ENTITY_MIRROR_TAG_KIND(event->userData));
+            int slot = ENTITY_MIRROR_TAG_SLOT(event->userData);
+            if (!arrays || !entityStateSlotMatches(arrays, slot, event->bodyId)) continue;
+
+            b2Vec2 vel = b2Body_GetLinearVelocity(event->bodyId);
+            arrays->x[slot] = origin.x + event->transform.p.x;
+            arrays->y[slot] = origin.y + event->transform.p.y;
+            arrays->vx[slot] = vel.x;
+            arrays->vy[slot] = vel.y;
+            arrays->rot[slot] = atan2f(event->transform.q.s, event->transform.q.c);
+            arrays->flags[slot] = event->fellAsleep
+                ? (ENTITY_STATE_ACTIVE | ENTITY_STATE_ASLEEP) : ENTITY_STATE_ACTIVE;
+            markEntityStateDirty(arrays, slot, tick);
+            mirror->lastMoveCount++;
+        }
+    }
+}
+
+// Re-pointing a slot changes membership: dormancy, snapshots and anything
+// else keyed by slot rebuild from membershipTick
+void repointEntityStateSlot(EntityStateMirror* mirror, EntityStateArrays* arrays, uint8_t kind, int slot,
+                            b2BodyId body, uint32_t id, uint32_t tick) {
+    setEntityStateSlot(arrays, kind, slot, body, id, tick);
+    mirror->membershipTick = tick;
+}
+
+void syncPlayerStateSlot(EntityStateMirror* mirror, int slot, b2BodyId body, uint32_t id, bool suspended,
+                         bool onDeck, uint32_t tick) {
+    EntityStateArrays* players = &mirror->players;
+    if (!B2_ID_EQUALS(players->bodies[slot], body) || players->ids[slot] != id) {
+        repointEntityStateSlot(mirror, players, ENTITY_TYPE_PLAYER, slot, body, id, tick);
+    }
+    // Suspended bodies are disabled and produce no move events, crew are
+    // written by the deck pass
+    if (suspended && !onDeck && (players->vx[slot] != 0.0f || players->vy[slot] != 0.0f)) {
+        players->vx[slot] = players->vy[slot] = 0.0f;
+        markEntityStateDirty(players, slot, tick);
+    }
+}
+
+void finishPlayerStateSlots(EntityStateMirror* mirror, int count, uint32_t tick) {
+    if (mirror->players.count != count) mirror->membershipTick = tick;
+    mirror->players.count = count;
+}
+
+void syncShipStateSlots(EntityStateMirror* mirror, const ShipArray* ships, uint32_t tick) {
+    EntityStateArrays* mirrored = &mirror->ships;
+    if (!reserveEntityStateArrays(mirrored, ships->count)) return;
+
+    for (int i = 0; i < ships->count; i++) {
+        const Ship* ship = &ships->ships[i];
+        if (!B2_ID_EQUALS(mirrored->bodies[i], ship->id) || mirrored->ids[i] != ship->entity_id) {
+            repointEntityStateSlot(mirror, mirrored, ENTITY_TYPE_SHIP, i, ship->id, ship->entity_id, tick);
+        }
+        // Replicated, and a dormant ship marked dirty is woken by its own move
+        if (mirrored->stateFlags[i] != ship->flags) {
+            mirrored->stateFlags[i] = ship->flags;
+            markEntityStateDirty(mirrored, i, tick);
+        }
+    }
+    if (mirrored->count != ships->count) mirror->membershipTick = tick;
+    mirrored->count = ships->count;
+}
+
+static void freeEntityStateArrays(EntityStateArrays* arrays) {
+    free(arrays->x);
+    free(arrays->y);
+    free(arrays->vx);
+    free(arrays->vy);
+    free(arrays->rot);
+    free(arrays->flags);
+    free(arrays->stateFlags);
+    free(arrays->ids);
+    free(arrays->bodies);
+    free(arrays->changedTick);
+    free(arrays->dirty);
+    memset(arrays, 0, sizeof(EntityStateArrays));
+}
+
+void cleanupEntityStateMirror(EntityStateMirror* mirror) {
+    if (!mirror) return;
+    freeEntityStateArrays(&mirror->players);
+    freeEntityStateArrays(&mirror->ships);
+}
@@ -5,6 +5,7 @@
 #include <box2d/box2d.h>
 #include "../database/db_client.h"    // Add this include for DatabaseClient
 #include "../database/protocol/db_protocol.h" // Add this include for DatabaseHealth
+#include "../world/world_cells.h"
 
 // Unified scale constants
 #define PIXELS_PER_METER 100.0f       // Screen pixels per physics meter
@@ -16,18 +17,97 @@
 #define PHYSICS_SHIP_LENGTH 4.5f      // Length of ship in meters
 #define PHYSICS_SHIP_WIDTH 1.8f       // Width of ship in meters
 
+// Entity key - entity type in the high word, id in the low word.
+// Sorting by key groups entities by type, then id.
+typedef uint64_t EntityKey;
+#define ENTITY_KEY(type, id) (((uint64_t)(type) << 32) | (uint32_t)(id))
+#define ENTITY_KEY_TYPE(key) ((uint8_t)((key) >> 32))
+#define ENTITY_KEY_ID(key) ((uint32_t)(key))
+
+// Ship state flags, replicated as the ship's state_flags
+#define SHIP_FLAG_ANCHORED 0x01
+#define SHIP_FLAG_SAILING 0x02
+
 typedef struct {
     b2BodyId id;
     Vector2 screenPos;
     b2Vec2 physicsPos;
+    uint32_t entity_id;    // Network id, assigned by addShip
+    uint8_t flags;         // SHIP_FLAG_*, ships start anchored
 } Ship;
 
 typedef struct {
     Ship* ships;
     int capacity;
     int count;
+    uint32_t nextEntityId;
 } ShipArray;
 
+// Struct-of-arrays copy of body state, one set of arrays per entity kind.
+// Refreshed once per physics step from Box2D move events, so snapshots, AOI
+// and the dashboard scan contiguous floats instead of querying each body.
+// Slot i mirrors element i of the owning array (connections or ships), and
+// each body's user data holds its kind and slot. Each sync also lists the
+// slots it changed, so consumers can skip entities that didn't move.
+// Positions are global, cell origin included.
+#define ENTITY_STATE_ACTIVE 0x01    // Slot holds a valid body
+#define ENTITY_STATE_ASLEEP 0x02    // Body fell asleep, state is at rest
+#define ENTITY_STATE_ON_DECK 0x04   // Crew aboard a ship, state comes from the deck pass
+
+// Body user data - kind in the top byte, slot + 1 below so NULL means untracked
+#define ENTITY_MIRROR_TAG(kind, slot) ((void*)(uintptr_t)(((uintptr_t)(kind) << 24) | (uintptr_t)((slot) + 1)))
+#define ENTITY_MIRROR_TAG_KIND(tag) ((uint8_t)((uintptr_t)(tag) >> 24))
+#define ENTITY_MIRROR_TAG_SLOT(tag) ((int)((uintptr_t)(tag) & 0xFFFFFF) - 1)
+
+typedef struct {
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    float* rot;                     // Radians
+    uint8_t* flags;                 // ENTITY_STATE_*
+    uint8_t* stateFlags;            // Replicated owner flags, SHIP_FLAG_* for ships
+    uint32_t* ids;                  // Network entity id
+    b2BodyId* bodies;
+    uint32_t* changedTick;          // Step that last changed the slot
+    int* dirty;                     // Slots changed by the latest sync
+    int dirtyCount;
+    int count;
+    int capacity;
+} EntityStateArrays;
+
+typedef struct EntityStateMirror {
+    EntityStateArrays players;      // Parallel to PlayerConnectionManager.connections
+    EntityStateArrays ships;        // Parallel to ShipArray.ships
+    uint32_t tick;                  // Step the mirror was last synced for
+    uint32_t membershipTick;        // Step that last re-pointed a slot or changed a count
+    int lastMoveCount;              // Move events applied by the last step
+} EntityStateMirror;
+
+bool reserveEntityStateArrays(EntityStateArrays* arrays, int count);
+void setEntityStateSlot(EntityStateArrays* arrays, uint8_t kind, int slot, b2BodyId body, uint32_t id,
+                        uint32_t tick);
+void markEntityStateDirty(EntityStateArrays* arrays, int slot, uint32_t tick);
+void applyEntityMoveEvents(EntityStateMirror* mirror, const WorldCells* cells, uint32_t tick);
+void cleanupEntityStateMirror(EntityStateMirror* mirror);
+
+// Slot pass after applyEntityMoveEvents, shared by the room and the replay
+// runner. Slots are re-pointed only where the owning arrays changed, and any
+// re-pointed slot or count change advances membershipTick. Reserve the
+// player arrays before the per-slot calls.
+void repointEntityStateSlot(EntityStateMirror* mirror, EntityStateArrays* arrays, uint8_t kind, int slot,
+                            b2BodyId body, uint32_t id, uint32_t tick);
+void syncPlayerStateSlot(EntityStateMirror* mirror, int slot, b2BodyId body, uint32_t id, bool suspended,
+                         bool onDeck, uint32_t tick);
+void finishPlayerStateSlots(EntityStateMirror* mirror, int count, uint32_t tick);
+void syncShipStateSlots(EntityStateMirror* mirror, const ShipArray* ships, uint32_t tick);
+
+// True when slot still mirrors body - owning arrays can change between steps
+static inline bool entityStateSlotMatches(const EntityStateArrays* arrays, int slot, b2BodyId body) {
+    return slot >= 0 && slot < arrays->count && (arrays->flags[slot] & ENTITY_STATE_ACTIVE) &&
+           B2_ID_EQUALS(arrays->bodies[slot], body);
+}
+
 typedef struct {
     Vector2 target;
     float zoom;
@@ -37,7 +117,6 @@ typedef struct {
     int shipsCreated;
     bool isPlacingShip;
     Vector2 placementPreview;
-    ShipArray ships;
 } Camera2DState;
 
 typedef struct {
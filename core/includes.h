@@ -3,6 +3,9 @@
 
 // Core includes
 #include "game_state.h"
+#include "room.h"
+#include "state_hash.h"
+#include "input_journal.h"
 
 // Network includes
 #include "../network/common_protocol.h"
@@ -13,6 +16,8 @@
 #include "../network/server_messages.h"
 #include "../network/player_connection.h"
 #include "../network/websockets/ws_protocol.h"
+#include "../network/bitstream.h"
+#include "../network/snapshot.h"
 
 // Database includes
 #include "../database/db_client.h"
@@ -21,6 +26,14 @@
 // Physics includes
 #include "../physics/player/player_physics.h"
 #include "../physics/ship/ship_shapes.h"
+#include "../physics/ship/ship_deck.h"
+#include "../physics/ship/ship_sailing.h"
+#include "../physics/lag_compensation.h"
+#include "../physics/projectile.h"
+#include "../physics/dormancy.h"
+#include "../physics/spatial_query.h"
+#include "../physics/collision_layers.h"
+#include "../physics/collision_pairs.h"
 
 // UI includes
 #include "../UI/admin_console.h"
@@ -28,6 +41,9 @@
 
 // World includes
 #include "../world/coord_utils.h"
+#include "../world/spatial_grid.h"
+#include "../world/world_cells.h"
+#include "../world/wind_field.h"
 
 // External includes
 #include "../env_loader.h"
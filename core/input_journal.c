@@ -0,0 +1,89 @@
+#include "input_journal.h"
+#include <errno.h>
+#include <string.h>
+
+bool openInputJournal(InputJournal* journal, const char* path, InputJournalHeader* header) {
+    memset(journal, 0, sizeof(InputJournal));
+    journal->tick = header->startTick;
+    journal->file = fopen(path, "wb");
+    if (!journal->file) {
+        fprintf(stderr, "[Journal] Failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    header->magic = INPUT_JOURNAL_MAGIC;
+    header->version = INPUT_JOURNAL_VERSION;
+    if (fwrite(header, sizeof(*header), 1, journal->file) != 1 || fflush(journal->file) != 0) {
+        fprintf(stderr, "[Journal] Failed to write %s: %s\n", path, strerror(errno));
+        fclose(journal->file);
+        journal->file = NULL;
+        return false;
+    }
+    return true;
+}
+
+static void writeJournalEvent(InputJournal* journal, const InputJournalEvent* event) {
+    if (fwrite(event, sizeof(*event), 1, journal->file) != 1) {
+        // A journal with a gap replays into a different world, stop instead
+        fprintf(stderr, "[Journal] Write failed at tick %u, journaling stopped: %s\n", journal->tick,
+                strerror(errno));
+        fclose(journal->file);
+        journal->file = NULL;
+        return;
+    }
+    journal->events++;
+    journal->pending = true;
+}
+
+void recordJournalEvent(InputJournal* journal, InputJournalEventType type, uint32_t id, uint16_t flags, float x,
+                        float y) {
+    if (!journal || !journal->file) return;
+
+    InputJournalEvent event = {
+        .tick = journal->tick,
+        .type = (uint8_t)type,
+        .flags = flags,
+        .id = id,
+        .x = x,
+        .y = y
+    };
+    writeJournalEvent(journal, &event);
+}
+
+void recordJournalTargetEvent(InputJournal* journal, InputJournalEventType type, uint32_t id, uint32_t target) {
+    if (!journal || !journal->file) return;
+
+    InputJournalEvent event = {
+        .tick = journal->tick,
+        .type = (uint8_t)type,
+        .id = id,
+        .target = target
+    };
+    writeJournalEvent(journal, &event);
+}
+
+// Once per room pass, so a crash loses at most the ticks of one pass
+void flushInputJournal(InputJournal* journal) {
+    if (!journal->file || !journal->pending) return;
+    fflush(journal->file);
+    journal->pending = false;
+}
+
+void closeInputJournal(InputJournal* journal) {
+    if (!journal->file) return;
+    recordJournalEvent(journal, JOURNAL_END, 0, 0, 0.0f, 0.0f);
+    if (!journal->file) return;
+    fclose(journal->file);
+    journal->file = NULL;
+}
+
+bool readInputJournalHeader(FILE* file, InputJournalHeader* header) {
+    if (fread(header, sizeof(*header), 1, file) != 1) return false;
+    if (header->magic != INPUT_JOURNAL_MAGIC || header->version != INPUT_JOURNAL_VERSION) return false;
+    header->room[sizeof(header->room) - 1] = '\0';
+    return true;
+}
+
+bool readInputJournalEvent(FILE* file, InputJournalEvent* event) {
+    return fread(event, sizeof(*event), 1, file) == 1;
+}
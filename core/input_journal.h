@@ -0,0 +1,81 @@
+#ifndef INPUT_JOURNAL_H
+#define INPUT_JOURNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Append-only record of everything that feeds a room's simulation: the input
+// flags each player had applied, joins, leaves, suspends and resumes, and
+// admin edits, each tagged with the tick it took effect on. Decisions made
+// from wall-clock time or the network (auth, resume grace, socket drops) are
+// journaled as their outcome, so tools/replay_runner.c can re-simulate the
+// room headless from the journal alone.
+//
+// Layout: one InputJournalHeader, then fixed-size InputJournalEvents in the
+// order they were applied. Events for tick T were applied before or during
+// the step that simulated T. JOURNAL_END closes a cleanly shut down journal.
+#define INPUT_JOURNAL_MAGIC 0x4A534750u  // "PGSJ"
+#define INPUT_JOURNAL_VERSION 5
+
+typedef enum {
+    JOURNAL_PLAYER_JOIN = 1,             // id - spawns at the origin like a live join
+    JOURNAL_PLAYER_LEAVE,                // id - body destroyed
+    JOURNAL_PLAYER_SUSPEND,              // id - frozen and disabled
+    JOURNAL_PLAYER_RESUME,               // id
+    JOURNAL_PLAYER_INPUT,                // id, flags - only written when the applied flags change
+    JOURNAL_SHIP_ADD,                    // x, y - global position
+    JOURNAL_SHIP_DELETE,                 // id = ship index
+    JOURNAL_WAKE_ALL,                    // Wake every dormant ship during this tick's step
+    JOURNAL_PLAYER_BOARD,                // id, target = ship entity id - only written when boarding succeeded
+    JOURNAL_PLAYER_DISEMBARK,            // id - left the deck on request
+    JOURNAL_SHIP_FLAGS,                  // id = ship index, flags = new SHIP_FLAG_* set
+    JOURNAL_END                          // tick = first tick that was never simulated
+} InputJournalEventType;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t tickRate;
+    uint32_t startTick;                  // Room tick when the journal was opened
+    float cellSize;                      // Room settings the replay must match
+    float dormancyIdle;
+    int32_t projectilePool;
+    int32_t cellThreads;
+    int32_t maxCells;                    // The room's share of the world table
+    uint32_t collisionMatrix;            // getCollisionMatrix() of the writer
+    float windSpeed;                     // Mean wind, the field itself follows from the tick
+    char room[32];
+} __attribute__((packed)) InputJournalHeader;
+
+typedef struct {
+    uint32_t tick;
+    uint8_t type;                        // InputJournalEventType
+    uint8_t reserved;
+    uint16_t flags;
+    uint32_t id;
+    uint32_t target;                     // Second entity id, for events between two entities
+    float x;
+    float y;
+} __attribute__((packed)) InputJournalEvent;
+
+typedef struct {
+    FILE* file;                          // NULL while journaling is off
+    uint32_t tick;                       // Tick new events are tagged with, kept by the room
+    uint32_t events;
+    bool pending;                        // Written since the last flush
+} InputJournal;
+
+// Fills in magic and version, the caller sets the rest of the header
+bool openInputJournal(InputJournal* journal, const char* path, InputJournalHeader* header);
+void recordJournalEvent(InputJournal* journal, InputJournalEventType type, uint32_t id, uint16_t flags, float x,
+                        float y);
+void recordJournalTargetEvent(InputJournal* journal, InputJournalEventType type, uint32_t id, uint32_t target);
+void flushInputJournal(InputJournal* journal);
+void closeInputJournal(InputJournal* journal);
+
+// Readers, for tools - false at end of file or on a malformed log
+bool readInputJournalHeader(FILE* file, InputJournalHeader* header);
+bool readInputJournalEvent(FILE* file, InputJournalEvent* event);
+
+#endif // INPUT_JOURNAL_H
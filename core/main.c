@@ -129,6 +129,7 @@ void initShipArray(ShipArray* array, int initialCapacity) {
     array->ships = (Ship*)malloc(initialCapacity * sizeof(Ship));
     array->capacity = initialCapacity;
     array->count = 0;
+    array->nextEntityId = 1;
 }
 
 void addShip(ShipArray* array, Ship ship) {
@@ -136,23 +137,35 @@ void addShip(ShipArray* array, Ship ship) {
         array->capacity *= 2;
         array->ships = (Ship*)realloc(array->ships, array->capacity * sizeof(Ship));
     }
+    if (ship.entity_id == 0) {
+        ship.entity_id = array->nextEntityId++;
+    }
+    if (!(ship.flags & (SHIP_FLAG_ANCHORED | SHIP_FLAG_SAILING))) {
+        ship.flags |= SHIP_FLAG_ANCHORED;
+    }
     array->ships[array->count] = ship;
     array->count++;
 }
 
 // Add this function before main():
-void updateShipPositions(b2WorldId worldId, Camera2DState* camera) {
-    for (int i = 0; i < camera->ships.count; i++) {
-        Ship* ship = &camera->ships.ships[i];
-        b2Vec2 pos = b2Body_GetPosition(ship->id);
-        b2Rot rot = b2Body_GetRotation(ship->id);
+void updateShipPositions(Camera2DState* camera, ShipArray* ships, const EntityStateMirror* mirror) {
+    const EntityStateArrays* mirrored = &mirror->ships;
+    for (int i = 0; i < ships->count; i++) {
+        Ship* ship = &ships->ships[i];
+        b2Vec2 pos = ship->physicsPos;
+        float angle;
+        if (entityStateSlotMatches(mirrored, i, ship->id)) {
+            angle = mirrored->rot[i];
+        } else {
+            // Added or removed since the last physics step
+            if (!b2Body_IsValid(ship->id)) continue;
+            pos = worldCellBodyPosition(ship->id);
+            angle = b2Body_GetAngle(ship->id);
+        }
         Vector2 screenPos = physicsToScreen(pos, camera);
         
         // Update stored positions
         ship->screenPos = screenPos;
-        ship->physicsPos = pos;
-        
-        float angle = atan2f(rot.s, rot.c);
         
         // Now properly declared in ship_shapes.h
         DrawShipHull(screenPos, angle, BLUE, camera);
@@ -168,7 +181,6 @@ typedef enum {
     CMD_HELP
 } AdminCommand;
 
-// Add ship management functions
 void printShipList(const ShipArray* ships) {
     printf("\n--- Ships List ---\n");
     for (int i = 0; i < ships->count; i++) {
@@ -292,24 +304,13 @@ int main() {
     InitWindow(1280, 720, "Game Dashboard");
     SetTargetFPS(TARGET_FPS);
     
-    // Create physics world
-    b2WorldDef worldDef = b2DefaultWorldDef();
-    worldDef.gravity = (b2Vec2){0.0f, 0.0f};
-    worldDef.enableSleep = false;
-    b2WorldId worldId = b2CreateWorld(&worldDef);
+    initShipPrototypes();
     logDebug("Core systems initialized");
 
     // Initialize visual components
     Camera2DState camera = {0};
     camera.zoom = 1.0f;
-    initShipArray(&camera.ships, 10);
     
-    AdminConsole adminConsole;
-    initAdminConsole(&adminConsole, worldId, &camera.ships);
-    startAdminConsoleThread(&adminConsole);
-    
-    AdminWindow adminWindow;
-    initAdminWindow(&adminWindow, worldId, &camera.ships, &camera);
     logDebug("Visual components initialized");
 
     // Get executable path and workspace directory
@@ -361,6 +362,19 @@ int main() {
     // Remove auth port from environment variables since it's fixed
     const char* game_port_str = getEnvOrDefault("GAME_SERVER_PORT", "8080");
     int game_port = atoi(game_port_str);
+    float snapshot_rate = (float)atof(getEnvOrDefault("SNAPSHOT_RATE_HZ", "20"));
+    float view_radius = (float)atof(getEnvOrDefault("AOI_VIEW_RADIUS", "150"));
+    float client_bandwidth = (float)atof(getEnvOrDefault("SNAPSHOT_CLIENT_BANDWIDTH", "65536"));
+    QuantizationConfig quantization = defaultQuantizationConfig();
+    quantization.angleBits = atoi(getEnvOrDefault("SNAPSHOT_ANGLE_BITS", "14"));
+    int projectile_pool = atoi(getEnvOrDefault("PROJECTILE_POOL_SIZE", "4096"));
+    float wind_speed = (float)atof(getEnvOrDefault("WIND_SPEED", "8"));
+    float dormancy_idle = (float)atof(getEnvOrDefault("DORMANCY_IDLE_SECONDS", "30"));
+    float cell_size = (float)atof(getEnvOrDefault("WORLD_CELL_SIZE", "1000"));
+    int cell_threads = atoi(getEnvOrDefault("WORLD_CELL_THREADS", "2"));
+    const char* room_names = getEnvOrDefault("GAME_ROOMS", ROOM_DEFAULT_NAMES);
+    int room_workers = atoi(getEnvOrDefault("ROOM_WORKERS", "1"));
+    const char* collision_layers = getEnvOrDefault("COLLISION_LAYERS", COLLISION_DEFAULT_PAIRS);
 
     if (!server_id || !server_token) {
         logDebug("ERROR: Required environment variables GAME_SERVER_ID and GAME_SERVER_TOKEN must be set");
@@ -378,11 +392,53 @@ int main() {
         // Continue without database connection
     }
 
-    // Initialize player manager but don't require database connection
-    PlayerConnectionManager playerManager = {0};
-    playerManager.worldId = worldId;
-    playerManager.db_client = &dbState.dbClient;
-    
+    // Shape filters are built from the matrix, so it is set before any room creates bodies
+    if (!configureCollisionLayers(collision_layers)) {
+        logDebug("Invalid COLLISION_LAYERS, using %s", COLLISION_DEFAULT_PAIRS);
+        configureCollisionLayers(COLLISION_DEFAULT_PAIRS);
+    }
+
+    // Every room gets its own world cells, players, snapshots, lag history,
+    // projectiles and dormancy, all built from the same settings
+    RoomConfig roomConfig = {
+        .snapshotRate = snapshot_rate,
+        .viewRadius = view_radius,
+        .clientBandwidth = client_bandwidth,
+        .quantization = quantization,
+        .projectilePool = projectile_pool,
+        .dormancyIdle = dormancy_idle,
+        .windSpeed = wind_speed,
+        .cellSize = cell_size,
+        .cellThreads = cell_threads,
+        .resumeGrace = atoi(getEnvOrDefault("SESSION_RESUME_GRACE", "10")),
+        .stateHashLog = getEnvOrDefault("STATE_HASH_LOG", NULL),
+        .inputJournal = getEnvOrDefault("INPUT_JOURNAL", NULL),
+    };
+    RoomManager rooms;
+    if (!initRoomManager(&rooms, room_names, room_workers, &roomConfig, &dbState.dbClient)) {
+        logDebug("ERROR: Failed to create game rooms");
+        return -1;
+    }
+    logDebug("Game rooms: %d on %d workers, default room '%s'", rooms.roomCount, rooms.workerCount,
+             rooms.rooms[0].name);
+
+    // The dashboard and admin tools look at the default room
+    GameRoom* dashboardRoom = &rooms.rooms[0];
+
+    AdminConsole adminConsole;
+    initAdminConsole(&adminConsole, &dashboardRoom->cells, &dashboardRoom->ships, &dashboardRoom->lock,
+                     &dashboardRoom->journal, &dashboardRoom->collisionPairs);
+    startAdminConsoleThread(&adminConsole);
+
+    AdminWindow adminWindow;
+    initAdminWindow(&adminWindow, &dashboardRoom->cells, &dashboardRoom->ships, &camera, &dashboardRoom->journal);
+
+    if (!startRoomWorkers(&rooms)) {
+        logDebug("ERROR: Failed to start room workers");
+        cleanupRoomManager(&rooms);
+        return -1;
+    }
+
     // Start WebSocket server but don't accept connections until database is ready
     if (!ws_start_server(NULL, game_port)) {
         logDebug("Warning: Failed to start WebSocket server - player connections disabled");
@@ -395,9 +451,8 @@ int main() {
     int frameCount = 0;
     float lastCameraZoom = 1.0f;
 
-    // Main game loop
-    double lastPhysicsUpdate = GetTime();
-    double lastVisualUpdate = GetTime();
+    // Main loop - rooms tick on their own workers, this thread runs the
+    // dashboard, the database client and the listener
     logDebug("Entering main loop - Dashboard active, waiting for database connection");
     
     while (!WindowShouldClose()) {
@@ -422,11 +477,19 @@ int main() {
                 }
             }
         }
+        atomic_store_explicit(&rooms.dbReady, dbState.isDbHealthy, memory_order_release);
+
+        // Hand new sockets to the room their connect URL names
+        while (ws_has_pending_connections()) {
+            WebSocket* ws = ws_accept_connection();
+            if (ws) {
+                routeConnection(&rooms, ws);
+            }
+        }
 
-        // Update physics at fixed timestep
-        if (currentTime - lastPhysicsUpdate >= PHYSICS_TIME_STEP) {
-            b2World_Step(worldId, PHYSICS_TIME_STEP, 1);
-            lastPhysicsUpdate = currentTime;
+        if (adminConsole.wakeRequested) {
+            adminConsole.wakeRequested = false;
+            atomic_store_explicit(&dashboardRoom->wakeRequested, true, memory_order_release);
         }
 
         // Start drawing
@@ -435,7 +498,9 @@ int main() {
 
         // Draw game elements
         DrawPhysicsGrid(50.0f, &camera);
-        updateShipPositions(worldId, &camera);
+        pthread_mutex_lock(&dashboardRoom->lock);
+        updateShipPositions(&camera, &dashboardRoom->ships, &dashboardRoom->mirror);
+        pthread_mutex_unlock(&dashboardRoom->lock);
 
         // Draw UI elements last
         ConnectionStatus status = getConnectionStatus(&dbState);
@@ -459,7 +524,9 @@ int main() {
 
         // Draw admin window last
         if (adminWindow.isOpen) {
+            pthread_mutex_lock(&dashboardRoom->lock);
             updateAdminWindow(&adminWindow);
+            pthread_mutex_unlock(&dashboardRoom->lock);
         }
 
         EndDrawing();
@@ -475,11 +542,10 @@ int main() {
     }
 
     logDebug("Cleaning up...");
-    cleanupPlayerConnectionManager(&playerManager);
     closeAdminWindow(&adminWindow);
     stopAdminConsole(&adminConsole);
+    cleanupRoomManager(&rooms);
     // db_client_cleanup(&dbState.dbClient);
-    b2DestroyWorld(worldId);
     ws_stop_server();
     CloseWindow();
     logDebug("Shutdown complete");
@@ -0,0 +1,482 @@
+#define _GNU_SOURCE
+#include "room.h"
+#include <limits.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+
+static double monotonicSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Only ships that moved this step get a new position, anchored ones are skipped
+static void applyShipMoves(ShipArray* ships, const EntityStateMirror* mirror) {
+    const EntityStateArrays* mirrored = &mirror->ships;
+    for (int d = 0; d < mirrored->dirtyCount; d++) {
+        int i = mirrored->dirty[d];
+        if (i >= ships->count || !entityStateSlotMatches(mirrored, i, ships->ships[i].id)) continue;
+        ships->ships[i].physicsPos = (b2Vec2){mirrored->x[i], mirrored->y[i]};
+    }
+}
+
+// A body crossed into another world cell - its owner takes the new id.
+// The mirror tag carried over says which slot owned it at the last slot
+// pass, which runs after this one. Departures and ship deletes earlier in
+// the tick shift owners down, so a stale tag falls back to a search.
+static bool onBodyMigrated(void* context, b2BodyId from, b2BodyId to) {
+    GameRoom* room = context;
+    void* tag = b2Body_GetUserData(to);
+    int slot = ENTITY_MIRROR_TAG_SLOT(tag);
+
+    switch (ENTITY_MIRROR_TAG_KIND(tag)) {
+        case ENTITY_TYPE_PLAYER: {
+            PlayerConnectionManager* players = &room->players;
+            int count = (int)players->count;
+            if (slot < 0 || slot >= count || !B2_ID_EQUALS(players->connections[slot].physics_body, from)) {
+                for (slot = 0; slot < count && !B2_ID_EQUALS(players->connections[slot].physics_body, from); slot++);
+            }
+            if (slot < count) {
+                players->connections[slot].physics_body = to;
+                return true;
+            }
+            break;
+        }
+        case ENTITY_TYPE_SHIP: {
+            ShipArray* ships = &room->ships;
+            if (slot < 0 || slot >= ships->count || !B2_ID_EQUALS(ships->ships[slot].id, from)) {
+                for (slot = 0; slot < ships->count && !B2_ID_EQUALS(ships->ships[slot].id, from); slot++);
+            }
+            if (slot < ships->count) {
+                ships->ships[slot].id = to;
+                return true;
+            }
+            break;
+        }
+    }
+    fprintf(stderr, "[Room] %s: migrated body has no owner, left in its cell\n", room->name);
+    return false;
+}
+
+// Refresh the entity state mirror after a physics step. Moved bodies come
+// from move events, slots are only re-pointed where the owning arrays changed.
+static void syncEntityMirror(GameRoom* room) {
+    EntityStateMirror* mirror = &room->mirror;
+    const PlayerConnectionManager* manager = &room->players;
+    const ShipArray* ships = &room->ships;
+    uint32_t tick = room->tick;
+
+    applyEntityMoveEvents(mirror, &room->cells, tick);
+    // Handoffs replace bodies, the slot pass below re-points them
+    updateWorldCellBorders(&room->cells);
+
+    if (reserveEntityStateArrays(&mirror->players, (int)manager->count)) {
+        for (size_t i = 0; i < manager->count; i++) {
+            const PlayerConnection* player = &manager->connections[i];
+            b2BodyId body = player->authenticated ? player->physics_body : b2_nullBodyId;
+            syncPlayerStateSlot(mirror, (int)i, body, player->player_id, player->suspended,
+                                player->deck.shipId != 0, tick);
+        }
+        finishPlayerStateSlots(mirror, (int)manager->count, tick);
+    }
+    syncShipStateSlots(mirror, ships, tick);
+}
+
+// Remember where every body was this tick, for lag-compensated hit checks.
+// Crew have no enabled body to hit, shots land on their ship.
+static void recordLagHistoryTick(GameRoom* room) {
+    const PlayerConnectionManager* manager = &room->players;
+    const ShipArray* ships = &room->ships;
+    LagHistoryFrame* frame = beginLagHistoryFrame(&room->lagHistory, room->tick,
+                                                  (int)manager->count + ships->count);
+    if (!frame) return;
+
+    for (size_t i = 0; i < manager->count; i++) {
+        const PlayerConnection* player = &manager->connections[i];
+        if (!player->authenticated || player->deck.shipId != 0 || !b2Body_IsValid(player->physics_body)) continue;
+        recordLagHistoryBody(frame, ENTITY_KEY(ENTITY_TYPE_PLAYER, player->player_id), player->physics_body);
+    }
+    for (int i = 0; i < ships->count; i++) {
+        if (!b2Body_IsValid(ships->ships[i].id)) continue;
+        recordLagHistoryBody(frame, ENTITY_KEY(ENTITY_TYPE_SHIP, ships->ships[i].entity_id), ships->ships[i].id);
+    }
+    finishLagHistoryFrame(&room->lagHistory, frame);
+}
+
+static void stepGameRoom(GameRoom* room) {
+    bool wake = atomic_exchange_explicit(&room->wakeRequested, false, memory_order_acq_rel);
+    if (wake) {
+        recordJournalEvent(&room->journal, JOURNAL_WAKE_ALL, 0, 0, 0.0f, 0.0f);
+    }
+    removeDisconnectedPlayers(&room->players);
+    processPlayerInputs(&room->players, &room->projectiles, &room->mirror, room->tick);
+    stepWorldCells(&room->cells, ROOM_TICK_STEP, 1);
+    room->tick++;
+    room->journal.tick = room->tick;
+    updateWindField(&room->wind, room->tick);
+    syncEntityMirror(room);
+    // Ships have moved, so crew follow before anything reads player state
+    stepPlayerCrew(&room->players, &room->mirror, room->tick, ROOM_TICK_STEP);
+    beginSpatialQueryTick(&room->queries, room->tick);
+    if (wake) {
+        wakeAllDormant(&room->dormancy, &room->mirror, room->tick);
+    }
+    // Before projectiles cast, so shots reach ships they wake
+    updateDormancy(&room->dormancy, &room->mirror, room->projectiles.lastX, room->projectiles.lastY,
+                   room->projectiles.count, room->tick);
+    // Forces act in the next step, ships woken above included
+    collectSailingShips(&room->sailing, &room->ships, &room->mirror.ships, &room->wind);
+    computeSailingForces(&room->sailing);
+    applySailingForces(&room->sailing);
+    stepProjectiles(&room->projectiles, &room->cells, &room->mirror, room->tick, ROOM_TICK_STEP);
+    applyShipMoves(&room->ships, &room->mirror);
+    trackSnapshotChanges(&room->snapshots, &room->mirror);
+    recordLagHistoryTick(room);
+    if (room->stateHash.file) {
+        recordStateHash(&room->stateHash, room->tick, hashEntityState(&room->mirror));
+    }
+    if (room->tick % COLLISION_PAIR_SAMPLE_TICKS == 0) {
+        sampleCollisionPairs(&room->collisionPairs, &room->cells, &room->mirror, room->tick);
+    }
+}
+
+// Ahead of the snapshot: clients about to get a full world state get the
+// whole field, everyone gets the cells that moved past the send thresholds
+static void broadcastWindChanges(GameRoom* room) {
+    WindField* field = &room->wind;
+    GameWindCell cells[WIND_GRID_CELLS];
+    bool fieldBuilt = false;
+
+    for (size_t i = 0; i < room->players.count; i++) {
+        PlayerConnection* conn = &room->players.connections[i];
+        if (!conn->authenticated || conn->suspended || !conn->needs_full_snapshot) continue;
+        if (!fieldBuilt) {
+            for (int cell = 0; cell < WIND_GRID_CELLS; cell++) {
+                cells[cell] = (GameWindCell){(uint16_t)cell, windCellDirection(field, cell),
+                                             windCellSpeed(field, cell)};
+            }
+            fieldBuilt = true;
+        }
+        sendFramedRecords(&room->snapshots, &conn->ws, GAME_MSG_WIND_UPDATE, cells, sizeof(GameWindCell),
+                          WIND_GRID_CELLS);
+    }
+
+    if (field->changedCount == 0) return;
+    for (int i = 0; i < field->changedCount; i++) {
+        int cell = field->changed[i];
+        cells[i] = (GameWindCell){(uint16_t)cell, windCellDirection(field, cell), windCellSpeed(field, cell)};
+    }
+    broadcastFramedRecords(&room->snapshots, &room->players, GAME_MSG_WIND_UPDATE, cells, sizeof(GameWindCell),
+                           field->changedCount);
+    markWindChangesSent(field);
+}
+
+// Sockets the listener routed here since the last pass
+static void adoptArrivals(GameRoom* room, bool dbReady) {
+    pthread_mutex_lock(&room->arrivalLock);
+    WebSocket** arrivals = room->arrivals;
+    int count = room->arrivalCount;
+    room->arrivals = NULL;
+    room->arrivalCount = 0;
+    room->arrivalCapacity = 0;
+    pthread_mutex_unlock(&room->arrivalLock);
+
+    room->players.db_ready = dbReady;
+    for (int i = 0; i < count; i++) {
+        // The connection keeps a copy of the socket, only the holder is freed
+        if (!handleNewPlayerConnection(&room->players, NULL, arrivals[i])) {
+            ws_disconnect(arrivals[i]);
+        }
+        free(arrivals[i]);
+    }
+    free(arrivals);
+}
+
+static void pinToCore(int worker) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores <= 1) return;
+
+    // Core 0 is left to the listener and dashboard
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(1 + worker % (cores - 1), &set);
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        fprintf(stderr, "[Room] Worker %d: failed to pin to a core: %s\n", worker, strerror(err));
+    }
+}
+
+// Each worker owns rooms worker, worker + workerCount, ... and sleeps until
+// the earliest of their next ticks
+static void* roomWorkerThread(void* data) {
+    RoomWorker* worker = data;
+    RoomManager* manager = worker->manager;
+    pinToCore(worker->index);
+
+    while (atomic_load_explicit(&manager->running, memory_order_acquire)) {
+        double now = monotonicSeconds();
+        double wake = now + ROOM_TICK_STEP;
+
+        for (int r = worker->index; r < manager->roomCount; r += manager->workerCount) {
+            GameRoom* room = &manager->rooms[r];
+            pthread_mutex_lock(&room->lock);
+            adoptArrivals(room, atomic_load_explicit(&manager->dbReady, memory_order_acquire));
+
+            int ticks = 0;
+            while (now >= room->nextTick && ticks < ROOM_MAX_CATCHUP_TICKS) {
+                stepGameRoom(room);
+                room->nextTick += ROOM_TICK_STEP;
+                ticks++;
+            }
+            if (now >= room->nextTick) room->nextTick = now + ROOM_TICK_STEP;
+            flushInputJournal(&room->journal);
+
+            // Broadcast one batched snapshot per client at the snapshot rate
+            if (snapshotBroadcastDue(&room->snapshots, now)) {
+                broadcastWindChanges(room);
+                broadcastWorldSnapshot(&room->snapshots, &room->players, &room->mirror, &room->projectiles,
+                                       room->tick, now);
+                clearProjectileEvents(&room->projectiles);
+            }
+            pthread_mutex_unlock(&room->lock);
+
+            if (room->nextTick < wake) wake = room->nextTick;
+        }
+
+        double delay = wake - monotonicSeconds();
+        if (delay > 0.0) {
+            struct timespec ts = {(time_t)delay, (long)((delay - (time_t)delay) * 1e9)};
+            while (nanosleep(&ts, &ts) != 0 && errno == EINTR);
+        }
+    }
+    return NULL;
+}
+
+static void cleanupGameRoom(GameRoom* room) {
+    for (int i = 0; i < room->arrivalCount; i++) {
+        ws_disconnect(room->arrivals[i]);
+        free(room->arrivals[i]);
+    }
+    free(room->arrivals);
+    cleanupPlayerConnectionManager(&room->players);
+    cleanupSnapshotBroadcaster(&room->snapshots);
+    cleanupLagHistory(&room->lagHistory);
+    cleanupProjectileSystem(&room->projectiles);
+    cleanupDormancySystem(&room->dormancy);
+    cleanupSpatialQueryService(&room->queries);
+    freeSailingBatch(&room->sailing);
+    closeStateHashLog(&room->stateHash);
+    closeInputJournal(&room->journal);
+    cleanupEntityStateMirror(&room->mirror);
+    cleanupWorldCells(&room->cells);
+    free(room->ships.ships);
+    pthread_mutex_destroy(&room->lock);
+    pthread_mutex_destroy(&room->arrivalLock);
+}
+
+// Logs what failed and releases whatever the room had set up so far
+static bool failGameRoom(GameRoom* room, const char* what) {
+    fprintf(stderr, "[Room] %s: failed to %s\n", room->name, what);
+    cleanupGameRoom(room);
+    return false;
+}
+
+static bool initGameRoom(GameRoom* room, const char* name, size_t nameLength, const RoomConfig* config,
+                         DatabaseClient* dbClient, int maxCells) {
+    memset(room, 0, sizeof(GameRoom));
+    memcpy(room->name, name, nameLength);
+    atomic_init(&room->wakeRequested, false);
+    pthread_mutex_init(&room->lock, NULL);
+    pthread_mutex_init(&room->arrivalLock, NULL);
+
+    // Resting bodies sleep and stop producing move events
+    b2WorldDef worldDef = b2DefaultWorldDef();
+    worldDef.gravity = (b2Vec2){0.0f, 0.0f};
+    worldDef.enableSleep = true;
+    if (!initWorldCells(&room->cells, config->cellSize, &worldDef, config->cellThreads, maxCells)) {
+        return failGameRoom(room, "create the physics world");
+    }
+    room->cells.onMigrate = onBodyMigrated;
+    room->cells.migrateContext = room;
+
+    initShipArray(&room->ships, 10);
+    if (!initPlayerConnectionManager(&room->players, dbClient, &room->cells)) {
+        return failGameRoom(room, "allocate connections");
+    }
+    room->players.resume_grace = config->resumeGrace;
+
+    if (!initSnapshotBroadcaster(&room->snapshots, config->snapshotRate, config->viewRadius,
+                                 config->clientBandwidth, &config->quantization)) {
+        return failGameRoom(room, "allocate snapshot state");
+    }
+    if (!initLagHistory(&room->lagHistory)) {
+        return failGameRoom(room, "allocate lag compensation history");
+    }
+    if (!initProjectileSystem(&room->projectiles, config->projectilePool)) {
+        return failGameRoom(room, "allocate projectile pool");
+    }
+    if (!initDormancySystem(&room->dormancy, config->dormancyIdle, ROOM_TICK_STEP)) {
+        return failGameRoom(room, "initialize dormancy tracking");
+    }
+    if (!initSpatialQueryService(&room->queries, &room->cells)) {
+        return failGameRoom(room, "initialize spatial queries");
+    }
+    initWindField(&room->wind, config->windSpeed, room->tick);
+    if (config->stateHashLog && *config->stateHashLog) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s.%s", config->stateHashLog, room->name);
+        if (openStateHashLog(&room->stateHash, path, room->name, ROOM_TICK_HZ)) {
+            fprintf(stderr, "[Room] %s: logging state hashes to %s\n", room->name, path);
+        }
+    }
+    if (config->inputJournal && *config->inputJournal) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s.%s", config->inputJournal, room->name);
+        InputJournalHeader header = {
+            .tickRate = ROOM_TICK_HZ,
+            .startTick = room->tick,
+            .cellSize = room->cells.cellSize,
+            .dormancyIdle = config->dormancyIdle,
+            .projectilePool = config->projectilePool,
+            .cellThreads = config->cellThreads,
+            .maxCells = room->cells.maxCells,
+            .windSpeed = room->wind.meanSpeed,
+            .collisionMatrix = getCollisionMatrix()
+        };
+        strncpy(header.room, room->name, sizeof(header.room) - 1);
+        if (openInputJournal(&room->journal, path, &header)) {
+            room->players.journal = &room->journal;
+            fprintf(stderr, "[Room] %s: journaling inputs to %s\n", room->name, path);
+        }
+    }
+    room->nextTick = monotonicSeconds();
+    return true;
+}
+
+bool initRoomManager(RoomManager* rooms, const char* roomNames, int workerCount, const RoomConfig* config,
+                     DatabaseClient* dbClient) {
+    memset(rooms, 0, sizeof(RoomManager));
+    atomic_init(&rooms->running, false);
+    atomic_init(&rooms->dbReady, false);
+    if (!roomNames || !*roomNames) roomNames = ROOM_DEFAULT_NAMES;
+
+    rooms->rooms = calloc(ROOM_MAX, sizeof(GameRoom));
+    if (!rooms->rooms) return false;
+
+    // Every room's cells come out of Box2D's one world table, split evenly
+    int requested = 0;
+    for (const char* name = roomNames; *name && requested < ROOM_MAX;) {
+        size_t length = strcspn(name, ",");
+        if (length > 0 && length <= ROOM_NAME_MAX) requested++;
+        name += length;
+        if (*name == ',') name++;
+    }
+    int maxCells = requested > 0 ? WORLD_CELL_WORLD_SLOTS / requested : WORLD_CELL_MAX;
+
+    const char* name = roomNames;
+    while (*name && rooms->roomCount < ROOM_MAX) {
+        size_t length = strcspn(name, ",");
+        if (length > ROOM_NAME_MAX) {
+            fprintf(stderr, "[Room] Room name '%.*s' longer than %d, skipped\n", (int)length, name, ROOM_NAME_MAX);
+        } else if (length > 0) {
+            // A room that can't be set up has torn itself down and is refused,
+            // the rest still open
+            if (initGameRoom(&rooms->rooms[rooms->roomCount], name, length, config, dbClient, maxCells)) {
+                rooms->roomCount++;
+            } else {
+                fprintf(stderr, "[Room] Room '%.*s' not opened\n", (int)length, name);
+            }
+        }
+        name += length;
+        if (*name == ',') name++;
+    }
+    if (rooms->roomCount == 0) {
+        fprintf(stderr, "[Room] No valid room names in '%s'\n", roomNames);
+        free(rooms->rooms);
+        rooms->rooms = NULL;
+        return false;
+    }
+
+    if (workerCount < 1) workerCount = 1;
+    if (workerCount > ROOM_MAX_WORKERS) workerCount = ROOM_MAX_WORKERS;
+    if (workerCount > rooms->roomCount) workerCount = rooms->roomCount;
+    rooms->workerCount = workerCount;
+    return true;
+}
+
+bool startRoomWorkers(RoomManager* rooms) {
+    atomic_store_explicit(&rooms->running, true, memory_order_release);
+    int requested = rooms->workerCount;
+    for (int i = 0; i < requested; i++) {
+        rooms->workers[i] = (RoomWorker){rooms, i};
+        if (pthread_create(&rooms->threads[i], NULL, roomWorkerThread, &rooms->workers[i]) != 0) {
+            fprintf(stderr, "[Room] Started %d of %d workers\n", i, requested);
+            rooms->workerCount = i;
+            // Rooms are dealt out by worker count, so workers must not be running yet
+            atomic_store_explicit(&rooms->running, false, memory_order_release);
+            for (int j = 0; j < i; j++) pthread_join(rooms->threads[j], NULL);
+            rooms->workerCount = 0;
+            return false;
+        }
+    }
+    return true;
+}
+
+void cleanupRoomManager(RoomManager* rooms) {
+    if (!rooms || !rooms->rooms) return;
+    if (atomic_load_explicit(&rooms->running, memory_order_acquire)) {
+        atomic_store_explicit(&rooms->running, false, memory_order_release);
+        for (int i = 0; i < rooms->workerCount; i++) pthread_join(rooms->threads[i], NULL);
+    }
+    for (int i = 0; i < rooms->roomCount; i++) cleanupGameRoom(&rooms->rooms[i]);
+    free(rooms->rooms);
+    memset(rooms, 0, sizeof(RoomManager));
+}
+
+GameRoom* findRoom(RoomManager* rooms, const char* name) {
+    if (!name || !*name) return &rooms->rooms[0];
+    for (int i = 0; i < rooms->roomCount; i++) {
+        if (strcmp(rooms->rooms[i].name, name) == 0) return &rooms->rooms[i];
+    }
+    return NULL;
+}
+
+bool routeConnection(RoomManager* rooms, WebSocket* ws) {
+    const char* name = ws_get_room(ws);
+    GameRoom* room = findRoom(rooms, name);
+    if (!room) {
+        fprintf(stderr, "[Room] No room named '%s', connection refused\n", name);
+        uint8_t error_msg[] = {
+            GAME_MSG_ERROR,
+            GAME_ERR_ROOM,
+            0x00, 0x00
+        };
+        ws_send_binary(ws, error_msg, sizeof(error_msg));
+        ws_disconnect(ws);
+        free(ws);
+        return false;
+    }
+
+    pthread_mutex_lock(&room->arrivalLock);
+    if (room->arrivalCount == room->arrivalCapacity) {
+        int new_capacity = room->arrivalCapacity ? room->arrivalCapacity * 2 : 16;
+        WebSocket** arrivals = realloc(room->arrivals, new_capacity * sizeof(WebSocket*));
+        if (!arrivals) {
+            pthread_mutex_unlock(&room->arrivalLock);
+            fprintf(stderr, "[Room] %s: failed to queue connection\n", room->name);
+            ws_disconnect(ws);
+            free(ws);
+            return false;
+        }
+        room->arrivals = arrivals;
+        room->arrivalCapacity = new_capacity;
+    }
+    room->arrivals[room->arrivalCount++] = ws;
+    pthread_mutex_unlock(&room->arrivalLock);
+    return true;
+}
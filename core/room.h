@@ -0,0 +1,113 @@
+#ifndef ROOM_H
+#define ROOM_H
+
+#include <box2d/box2d.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "game_state.h"
+#include "state_hash.h"
+#include "input_journal.h"
+#include "../network/player_connection.h"
+#include "../network/snapshot.h"
+#include "../network/websockets/websocket.h"
+#include "../physics/lag_compensation.h"
+#include "../physics/projectile.h"
+#include "../physics/dormancy.h"
+#include "../physics/spatial_query.h"
+#include "../physics/collision_pairs.h"
+#include "../physics/ship/ship_sailing.h"
+#include "../world/world_cells.h"
+#include "../world/wind_field.h"
+
+// A room is one independent match: its own world cells, ships, players and
+// tick clock. Rooms are spread over worker threads pinned to cores, and
+// share the process's listener and DatabaseClient. The listener routes each
+// new socket to a room by the connect URL's room parameter; the room adopts
+// it on its own thread, so room state is only touched under the room lock.
+#define ROOM_NAME_MAX 31
+#define ROOM_MAX 64
+#define ROOM_MAX_WORKERS 32
+#define ROOM_TICK_HZ 60
+#define ROOM_TICK_STEP (1.0f / ROOM_TICK_HZ)
+#define ROOM_MAX_CATCHUP_TICKS 5       // Further behind than this, the backlog is dropped
+#define ROOM_DEFAULT_NAMES "main"
+
+typedef struct {
+    float snapshotRate;
+    float viewRadius;
+    float clientBandwidth;
+    QuantizationConfig quantization;
+    int projectilePool;
+    float dormancyIdle;
+    float cellSize;
+    int cellThreads;                   // Per room
+    int resumeGrace;
+    float windSpeed;                   // Mean wind over the sea, 0 for calm
+    const char* stateHashLog;          // Path prefix, each room logs to <prefix>.<room>; NULL for off
+    const char* inputJournal;          // Same, for the replayable input journal
+} RoomConfig;
+
+typedef struct {
+    char name[ROOM_NAME_MAX + 1];
+    pthread_mutex_t lock;              // Held for each tick, the dashboard and admin tools take it too
+    WorldCells cells;
+    ShipArray ships;
+    PlayerConnectionManager players;
+    EntityStateMirror mirror;
+    SnapshotBroadcaster snapshots;
+    LagHistory lagHistory;
+    ProjectileSystem projectiles;
+    DormancySystem dormancy;
+    SpatialQueryService queries;       // Gameplay proximity queries, reset every tick
+    CollisionPairCounters collisionPairs;
+    WindField wind;
+    SailingBatch sailing;
+    StateHashLog stateHash;
+    InputJournal journal;
+    uint32_t tick;
+    double nextTick;                   // Monotonic seconds the next tick is due
+
+    WebSocket** arrivals;              // Routed here by the listener, adopted on the room's thread
+    int arrivalCount;
+    int arrivalCapacity;
+    pthread_mutex_t arrivalLock;
+    atomic_bool wakeRequested;         // Wake every dormant ship on the next tick, set from the main loop
+} GameRoom;
+
+typedef struct RoomManager RoomManager;
+
+typedef struct {
+    RoomManager* manager;
+    int index;
+} RoomWorker;
+
+struct RoomManager {
+    GameRoom* rooms;                   // Fixed at init, pointers stay valid
+    int roomCount;
+    RoomWorker workers[ROOM_MAX_WORKERS];
+    pthread_t threads[ROOM_MAX_WORKERS];
+    int workerCount;
+    atomic_bool running;               // Flags shared with the main loop, release stores and acquire loads
+    atomic_bool dbReady;               // Set by the main loop, rooms accept players only when true
+};
+
+// From main.c
+void initShipArray(ShipArray* array, int initialCapacity);
+
+// roomNames is a comma-separated list, the first room is the default
+bool initRoomManager(RoomManager* rooms, const char* roomNames, int workerCount, const RoomConfig* config,
+                     DatabaseClient* dbClient);
+bool startRoomWorkers(RoomManager* rooms);
+void cleanupRoomManager(RoomManager* rooms);
+
+// NULL or empty name gives the default room, unknown names give NULL
+GameRoom* findRoom(RoomManager* rooms, const char* name);
+
+// Listener thread: hand an accepted socket to the room its URL names.
+// Takes ownership of ws either way.
+bool routeConnection(RoomManager* rooms, WebSocket* ws);
+
+#endif // ROOM_H
@@ -0,0 +1,103 @@
+#include "state_hash.h"
+#include "game_state.h"
+#include <errno.h>
+#include <string.h>
+
+#define STATE_HASH_PRIME 0x100000001B3ull
+#define STATE_HASH_LANES 4
+
+// Four independent lanes so the multiplies don't chain through one register
+static void hashWords(uint64_t lanes[STATE_HASH_LANES], const void* data, int count) {
+    const uint8_t* bytes = data;
+    int i = 0;
+    for (; i + STATE_HASH_LANES <= count; i += STATE_HASH_LANES) {
+        for (int lane = 0; lane < STATE_HASH_LANES; lane++) {
+            uint32_t word;
+            memcpy(&word, bytes + (size_t)(i + lane) * sizeof(uint32_t), sizeof(word));
+            lanes[lane] = (lanes[lane] ^ word) * STATE_HASH_PRIME;
+        }
+    }
+    for (; i < count; i++) {
+        uint32_t word;
+        memcpy(&word, bytes + (size_t)i * sizeof(uint32_t), sizeof(word));
+        lanes[i % STATE_HASH_LANES] = (lanes[i % STATE_HASH_LANES] ^ word) * STATE_HASH_PRIME;
+    }
+}
+
+static void hashEntityArrays(uint64_t lanes[STATE_HASH_LANES], const EntityStateArrays* arrays) {
+    uint32_t count = (uint32_t)arrays->count;
+    hashWords(lanes, &count, 1);
+    if (arrays->count == 0) return;
+    hashWords(lanes, arrays->ids, arrays->count);
+    hashWords(lanes, arrays->x, arrays->count);
+    hashWords(lanes, arrays->y, arrays->count);
+    hashWords(lanes, arrays->rot, arrays->count);
+    hashWords(lanes, arrays->vx, arrays->count);
+    hashWords(lanes, arrays->vy, arrays->count);
+}
+
+// splitmix64 finalizer, so one flipped bit spreads over the whole hash
+static uint64_t finishHash(uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBull;
+    h ^= h >> 31;
+    return h;
+}
+
+uint64_t hashEntityState(const EntityStateMirror* mirror) {
+    uint64_t lanes[STATE_HASH_LANES];
+    for (int lane = 0; lane < STATE_HASH_LANES; lane++) {
+        lanes[lane] = STATE_HASH_SEED + (uint64_t)lane * STATE_HASH_PRIME;
+    }
+    hashEntityArrays(lanes, &mirror->players);
+    hashEntityArrays(lanes, &mirror->ships);
+
+    uint64_t h = STATE_HASH_SEED;
+    for (int lane = 0; lane < STATE_HASH_LANES; lane++) {
+        h = finishHash(h ^ lanes[lane]);
+    }
+    return h;
+}
+
+bool openStateHashLog(StateHashLog* log, const char* path, const char* room, uint16_t tickRate) {
+    memset(log, 0, sizeof(StateHashLog));
+    log->file = fopen(path, "wb");
+    if (!log->file) {
+        fprintf(stderr, "[StateHash] Failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    StateHashFileHeader header = {0};
+    header.magic = STATE_HASH_MAGIC;
+    header.version = STATE_HASH_VERSION;
+    header.tickRate = tickRate;
+    strncpy(header.room, room, sizeof(header.room) - 1);
+    if (fwrite(&header, sizeof(header), 1, log->file) != 1) {
+        fprintf(stderr, "[StateHash] Failed to write %s: %s\n", path, strerror(errno));
+        fclose(log->file);
+        log->file = NULL;
+        return false;
+    }
+    return true;
+}
+
+void recordStateHash(StateHashLog* log, uint32_t tick, uint64_t hash) {
+    if (!log->file) return;
+    StateHashRecord record = {tick, hash};
+    if (fwrite(&record, sizeof(record), 1, log->file) != 1) {
+        // A truncated log would read as a divergence, stop instead
+        fprintf(stderr, "[StateHash] Write failed at tick %u, hashing stopped: %s\n", tick, strerror(errno));
+        fclose(log->file);
+        log->file = NULL;
+        return;
+    }
+    log->records++;
+}
+
+void closeStateHashLog(StateHashLog* log) {
+    if (!log->file) return;
+    fclose(log->file);
+    log->file = NULL;
+}
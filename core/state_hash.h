@@ -0,0 +1,45 @@
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Per-tick hash of every mirrored body's position, rotation and velocity,
+// taken over the raw float bits of the mirror's arrays. Two runs fed the same
+// inputs must log the same stream, so the first tick where two logs differ is
+// where nondeterminism crept in - threading, float reassociation, ordering.
+//
+// Log layout: one StateHashFileHeader, then one StateHashRecord per tick,
+// little-endian as written on x86/ARM. No raylib or Box2D needed to read it,
+// see tools/state_hash_compare.c.
+#define STATE_HASH_MAGIC 0x48534750u     // "PGSH"
+#define STATE_HASH_VERSION 1
+#define STATE_HASH_SEED 0xCBF29CE484222325ull
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t tickRate;                   // Ticks per second of the room that wrote it
+    char room[32];
+} __attribute__((packed)) StateHashFileHeader;
+
+typedef struct {
+    uint32_t tick;
+    uint64_t hash;
+} __attribute__((packed)) StateHashRecord;
+
+typedef struct {
+    FILE* file;                          // NULL while hashing is off
+    uint32_t records;
+} StateHashLog;
+
+typedef struct EntityStateMirror EntityStateMirror;
+
+uint64_t hashEntityState(const EntityStateMirror* mirror);
+
+bool openStateHashLog(StateHashLog* log, const char* path, const char* room, uint16_t tickRate);
+void recordStateHash(StateHashLog* log, uint32_t tick, uint64_t hash);
+void closeStateHashLog(StateHashLog* log);
+
+#endif // STATE_HASH_H
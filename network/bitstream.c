@@ -0,0 +1,278 @@
+#include "bitstream.h"
+#include "../physics/player/player_physics.h"
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+
+#define QUANT_TWO_PI 6.28318530718f
+#define QUANT_PI 3.14159265359f
+
+void bitWriterInit(BitWriter* writer, uint8_t* data, size_t capacity) {
+    writer->data = data;
+    writer->capacity = capacity;
+    writer->bitPos = 0;
+    writer->overflow = false;
+}
+
+void bitWriteBits(BitWriter* writer, uint32_t value, int bits) {
+    if (bits <= 0) return;
+    if (writer->bitPos + bits > writer->capacity * 8) {
+        writer->overflow = true;
+        return;
+    }
+    if (bits < 32) value &= (1u << bits) - 1;
+
+    // Merge into the partial byte, then store the remaining whole bytes
+    size_t byte = writer->bitPos >> 3;
+    int used = (int)(writer->bitPos & 7);
+    uint64_t merged = ((uint64_t)value << used) |
+                      (used ? (writer->data[byte] & ((1u << used) - 1)) : 0);
+    int bytes = (used + bits + 7) >> 3;
+    for (int i = 0; i < bytes; i++) {
+        writer->data[byte + i] = (uint8_t)(merged >> (8 * i));
+    }
+    writer->bitPos += bits;
+}
+
+void bitWriteBool(BitWriter* writer, bool value) {
+    bitWriteBits(writer, value ? 1 : 0, 1);
+}
+
+size_t bitWriterBytes(const BitWriter* writer) {
+    return (writer->bitPos + 7) >> 3;
+}
+
+void bitReaderInit(BitReader* reader, const uint8_t* data, size_t size) {
+    reader->data = data;
+    reader->size = size;
+    reader->bitPos = 0;
+    reader->overflow = false;
+}
+
+uint32_t bitReadBits(BitReader* reader, int bits) {
+    if (bits <= 0) return 0;
+    if (reader->bitPos + bits > reader->size * 8) {
+        reader->overflow = true;
+        return 0;
+    }
+
+    uint32_t value = 0;
+    int shift = 0;
+    while (bits > 0) {
+        size_t byte = reader->bitPos >> 3;
+        int used = (int)(reader->bitPos & 7);
+        int take = 8 - used;
+        if (take > bits) take = bits;
+
+        uint32_t chunk = (reader->data[byte] >> used) & ((1u << take) - 1);
+        value |= chunk << shift;
+
+        shift += take;
+        bits -= take;
+        reader->bitPos += take;
+    }
+    return value;
+}
+
+bool bitReadBool(BitReader* reader) {
+    return bitReadBits(reader, 1) != 0;
+}
+
+QuantizationConfig defaultQuantizationConfig(void) {
+    return (QuantizationConfig){
+        .cellSize = QUANT_DEFAULT_CELL_SIZE,
+        .positionBits = QUANT_DEFAULT_POSITION_BITS,
+        .maxSpeed = PLAYER_MAX_SPEED,
+        .velocityBits = QUANT_DEFAULT_VELOCITY_BITS,
+        .angleBits = QUANT_DEFAULT_ANGLE_BITS
+    };
+}
+
+// Clamp settings into ranges the encoder supports, returns false if anything changed
+bool validateQuantizationConfig(QuantizationConfig* config) {
+    QuantizationConfig defaults = defaultQuantizationConfig();
+    bool valid = true;
+
+    if (!(config->cellSize > 0.0f)) { config->cellSize = defaults.cellSize; valid = false; }
+    if (config->positionBits < 8 || config->positionBits > 24) { config->positionBits = defaults.positionBits; valid = false; }
+    if (!(config->maxSpeed > 0.0f)) { config->maxSpeed = defaults.maxSpeed; valid = false; }
+    if (config->velocityBits < 4 || config->velocityBits > 24) { config->velocityBits = defaults.velocityBits; valid = false; }
+    if (config->angleBits < QUANT_MIN_ANGLE_BITS || config->angleBits > QUANT_MAX_ANGLE_BITS) {
+        config->angleBits = defaults.angleBits;
+        valid = false;
+    }
+    return valid;
+}
+
+uint32_t quantizeRange(float value, float min, float max, int bits) {
+    uint32_t steps = (bits >= 32) ? 0xFFFFFFFFu : (1u << bits) - 1;
+    if (!(value > min)) return 0;      // Also catches NaN
+    if (value >= max) return steps;
+    return (uint32_t)((value - min) / (max - min) * (float)steps + 0.5f);
+}
+
+float dequantizeRange(uint32_t q, float min, float max, int bits) {
+    uint32_t steps = (bits >= 32) ? 0xFFFFFFFFu : (1u << bits) - 1;
+    return min + (float)q / (float)steps * (max - min);
+}
+
+uint32_t quantizeAngle(float radians, int bits) {
+    if (!isfinite(radians)) return 0;
+    float turns = radians / QUANT_TWO_PI;
+    turns -= floorf(turns);            // [0, 1)
+    uint32_t q = (uint32_t)(turns * (float)(1u << bits) + 0.5f);
+    return q & ((1u << bits) - 1);     // A full turn wraps to zero
+}
+
+// Returns (-pi, pi] to match atan2f
+float dequantizeAngle(uint32_t q, int bits) {
+    float radians = (float)q * (QUANT_TWO_PI / (float)(1u << bits));
+    return radians > QUANT_PI ? radians - QUANT_TWO_PI : radians;
+}
+
+QuantizedCoord quantizePosition(const QuantizationConfig* config, float value) {
+    if (!isfinite(value)) value = 0.0f;
+    uint32_t scale = 1u << config->positionBits;
+
+    float cell = floorf(value / config->cellSize);
+    float offset = (value - cell * config->cellSize) / config->cellSize;   // [0, 1)
+    uint32_t q = (uint32_t)(offset * (float)scale + 0.5f);
+
+    // Rounding up to the next cell boundary
+    if (q >= scale) {
+        q = 0;
+        cell += 1.0f;
+    }
+
+    // Keep the cell index inside its signed field
+    const float cellLimit = (float)(1 << (QUANT_CELL_BITS - 1));
+    if (cell < -cellLimit) { cell = -cellLimit; q = 0; }
+    if (cell > cellLimit - 1.0f) { cell = cellLimit - 1.0f; q = scale - 1; }
+
+    return (QuantizedCoord){(int32_t)cell, q};
+}
+
+float dequantizePosition(const QuantizationConfig* config, QuantizedCoord q) {
+    float step = config->cellSize / (float)(1u << config->positionBits);
+    return (float)q.cell * config->cellSize + (float)q.offset * step;
+}
+
+size_t maxEntityDeltaBits(const QuantizationConfig* config) {
+    return 32 + 8 + 6 +
+           2 * (1 + QUANT_CELL_BITS + config->positionBits) +
+           2 * config->velocityBits +
+           config->angleBits +
+           8;
+}
+
+static void writePositionBits(BitWriter* writer, const QuantizationConfig* config,
+                              QuantizedCoord q, const QuantizedCoord* base) {
+    bool cellChanged = !base || base->cell != q.cell;
+    bitWriteBool(writer, cellChanged);
+    if (cellChanged) bitWriteBits(writer, (uint32_t)q.cell, QUANT_CELL_BITS);
+    bitWriteBits(writer, q.offset, config->positionBits);
+}
+
+void writeEntityDeltaHeaderBits(BitWriter* writer, uint32_t entity_id, uint8_t entity_type, uint8_t fields) {
+    bitWriteBits(writer, entity_id, 32);
+    bitWriteBits(writer, entity_type, 8);
+    bitWriteBits(writer, fields, 6);
+}
+
+size_t writeEntityDeltaBits(BitWriter* writer, const QuantizationConfig* config,
+                            const GameEntityState* baseline, const GameEntityState* state,
+                            GameEntityState* applied) {
+    float speed = config->maxSpeed;
+    QuantizedCoord px = quantizePosition(config, state->pos_x);
+    QuantizedCoord py = quantizePosition(config, state->pos_y);
+    uint32_t vx = quantizeRange(state->velocity_x, -speed, speed, config->velocityBits);
+    uint32_t vy = quantizeRange(state->velocity_y, -speed, speed, config->velocityBits);
+    uint32_t rot = quantizeAngle(state->rotation, config->angleBits);
+
+    uint8_t fields = ENTITY_FIELD_ALL;
+    QuantizedCoord bx = {0}, by = {0};
+    if (baseline) {
+        bx = quantizePosition(config, baseline->pos_x);
+        by = quantizePosition(config, baseline->pos_y);
+
+        fields = 0;
+        if (px.cell != bx.cell || px.offset != bx.offset) fields |= ENTITY_FIELD_POS_X;
+        if (py.cell != by.cell || py.offset != by.offset) fields |= ENTITY_FIELD_POS_Y;
+        if (vx != quantizeRange(baseline->velocity_x, -speed, speed, config->velocityBits)) fields |= ENTITY_FIELD_VELOCITY_X;
+        if (vy != quantizeRange(baseline->velocity_y, -speed, speed, config->velocityBits)) fields |= ENTITY_FIELD_VELOCITY_Y;
+        if (rot != quantizeAngle(baseline->rotation, config->angleBits)) fields |= ENTITY_FIELD_ROTATION;
+        if (state->state_flags != baseline->state_flags) fields |= ENTITY_FIELD_FLAGS;
+
+        *applied = *baseline;
+        if (fields == 0) return 0;
+    }
+
+    size_t start = writer->bitPos;
+    writeEntityDeltaHeaderBits(writer, state->entity_id, state->entity_type, fields);
+
+    if (fields & ENTITY_FIELD_POS_X) {
+        writePositionBits(writer, config, px, baseline ? &bx : NULL);
+        applied->pos_x = dequantizePosition(config, px);
+    }
+    if (fields & ENTITY_FIELD_POS_Y) {
+        writePositionBits(writer, config, py, baseline ? &by : NULL);
+        applied->pos_y = dequantizePosition(config, py);
+    }
+    if (fields & ENTITY_FIELD_VELOCITY_X) {
+        bitWriteBits(writer, vx, config->velocityBits);
+        applied->velocity_x = dequantizeRange(vx, -speed, speed, config->velocityBits);
+    }
+    if (fields & ENTITY_FIELD_VELOCITY_Y) {
+        bitWriteBits(writer, vy, config->velocityBits);
+        applied->velocity_y = dequantizeRange(vy, -speed, speed, config->velocityBits);
+    }
+    if (fields & ENTITY_FIELD_ROTATION) {
+        bitWriteBits(writer, rot, config->angleBits);
+        applied->rotation = dequantizeAngle(rot, config->angleBits);
+    }
+    if (fields & ENTITY_FIELD_FLAGS) {
+        bitWriteBits(writer, state->state_flags, 8);
+        applied->state_flags = state->state_flags;
+    }
+
+    applied->entity_id = state->entity_id;
+    applied->entity_type = state->entity_type;
+    return writer->bitPos - start;
+}
+
+bool readEntityDeltaHeader(BitReader* reader, uint32_t* entity_id, uint8_t* entity_type, uint8_t* fields) {
+    *entity_id = bitReadBits(reader, 32);
+    *entity_type = (uint8_t)bitReadBits(reader, 8);
+    *fields = (uint8_t)bitReadBits(reader, 6);
+    return !reader->overflow;
+}
+
+static float readPositionBits(BitReader* reader, const QuantizationConfig* config, float baseline) {
+    QuantizedCoord q = quantizePosition(config, baseline);
+    if (bitReadBool(reader)) {
+        // Sign-extend the cell index
+        uint32_t raw = bitReadBits(reader, QUANT_CELL_BITS);
+        q.cell = (int32_t)(raw << (32 - QUANT_CELL_BITS)) >> (32 - QUANT_CELL_BITS);
+    }
+    q.offset = bitReadBits(reader, config->positionBits);
+    return dequantizePosition(config, q);
+}
+
+bool readEntityDeltaFields(BitReader* reader, const QuantizationConfig* config,
+                           uint8_t fields, GameEntityState* state) {
+    float speed = config->maxSpeed;
+
+    if (fields & ENTITY_FIELD_POS_X) state->pos_x = readPositionBits(reader, config, state->pos_x);
+    if (fields & ENTITY_FIELD_POS_Y) state->pos_y = readPositionBits(reader, config, state->pos_y);
+    if (fields & ENTITY_FIELD_VELOCITY_X) {
+        state->velocity_x = dequantizeRange(bitReadBits(reader, config->velocityBits), -speed, speed, config->velocityBits);
+    }
+    if (fields & ENTITY_FIELD_VELOCITY_Y) {
+        state->velocity_y = dequantizeRange(bitReadBits(reader, config->velocityBits), -speed, speed, config->velocityBits);
+    }
+    if (fields & ENTITY_FIELD_ROTATION) {
+        state->rotation = dequantizeAngle(bitReadBits(reader, config->angleBits), config->angleBits);
+    }
+    if (fields & ENTITY_FIELD_FLAGS) state->state_flags = (uint8_t)bitReadBits(reader, 8);
+    return !reader->overflow;
+}
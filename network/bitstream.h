@@ -0,0 +1,91 @@
+#ifndef BITSTREAM_H
+#define BITSTREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game_protocol.h"
+
+// Bits are packed LSB first, so a stream is read back in the order written.
+// Writing past the buffer sets overflow instead of corrupting memory.
+typedef struct {
+    uint8_t* data;
+    size_t capacity;     // Bytes
+    size_t bitPos;
+    bool overflow;
+} BitWriter;
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;         // Bytes
+    size_t bitPos;
+    bool overflow;
+} BitReader;
+
+void bitWriterInit(BitWriter* writer, uint8_t* data, size_t capacity);
+void bitWriteBits(BitWriter* writer, uint32_t value, int bits);   // bits: 1-32
+void bitWriteBool(BitWriter* writer, bool value);
+size_t bitWriterBytes(const BitWriter* writer);                   // Rounded up
+
+void bitReaderInit(BitReader* reader, const uint8_t* data, size_t size);
+uint32_t bitReadBits(BitReader* reader, int bits);
+bool bitReadBool(BitReader* reader);
+
+// Quantization settings, shared with clients through GAME_MSG_SNAPSHOT_CONFIG
+#define QUANT_DEFAULT_CELL_SIZE     256.0f  // meters per position cell
+#define QUANT_DEFAULT_POSITION_BITS 16      // offset within cell, ~4mm at 256m
+#define QUANT_DEFAULT_VELOCITY_BITS 12      // ~1cm/s at 20m/s
+#define QUANT_DEFAULT_ANGLE_BITS    14      // ~0.02 degrees
+#define QUANT_MIN_ANGLE_BITS        12
+#define QUANT_MAX_ANGLE_BITS        16
+#define QUANT_CELL_BITS             16      // signed cell index, +-8M meters at 256m
+
+typedef struct {
+    float cellSize;
+    int positionBits;
+    float maxSpeed;      // Velocities are clamped to +-maxSpeed
+    int velocityBits;
+    int angleBits;
+} QuantizationConfig;
+
+QuantizationConfig defaultQuantizationConfig(void);
+bool validateQuantizationConfig(QuantizationConfig* config);
+
+// Scalar quantizers - worst case error is half a step
+uint32_t quantizeRange(float value, float min, float max, int bits);
+float dequantizeRange(uint32_t q, float min, float max, int bits);
+uint32_t quantizeAngle(float radians, int bits);
+float dequantizeAngle(uint32_t q, int bits);
+
+// Position split into a cell index and a fixed-point offset inside the cell
+typedef struct {
+    int32_t cell;
+    uint32_t offset;
+} QuantizedCoord;
+
+QuantizedCoord quantizePosition(const QuantizationConfig* config, float value);
+float dequantizePosition(const QuantizationConfig* config, QuantizedCoord q);
+
+// Entity delta records: [entity_id:32][entity_type:8][changed_fields:6][fields...]
+// Positions are [cell changed:1][cell:16 if changed][offset:positionBits],
+// velocities [velocityBits], rotation [angleBits], flags [8].
+// A field counts as changed when its quantized value differs from the baseline.
+// baseline may be NULL, in which case every field is written.
+// applied receives the dequantized state the client reconstructs.
+// Returns the number of bits written, 0 if nothing changed.
+size_t writeEntityDeltaBits(BitWriter* writer, const QuantizationConfig* config,
+                            const GameEntityState* baseline, const GameEntityState* state,
+                            GameEntityState* applied);
+size_t maxEntityDeltaBits(const QuantizationConfig* config);
+// Just the record header. With no fields set it returns the entity to its
+// baseline state, for clients showing something newer than the baseline.
+void writeEntityDeltaHeaderBits(BitWriter* writer, uint32_t entity_id, uint8_t entity_type, uint8_t fields);
+
+// Reading is split so the caller can look up the baseline by entity id.
+// state must hold the baseline (or zeroes) and is updated in place.
+bool readEntityDeltaHeader(BitReader* reader, uint32_t* entity_id, uint8_t* entity_type, uint8_t* fields);
+bool readEntityDeltaFields(BitReader* reader, const QuantizationConfig* config,
+                           uint8_t fields, GameEntityState* state);
+
+#endif // BITSTREAM_H
@@ -11,6 +11,8 @@
 #define GAME_MSG_AUTH_RESPONSE 0x24
 #define GAME_MSG_ERROR         0x2F
 #define GAME_MSG_INPUT         0x25  // Add missing input message type
+#define GAME_MSG_SNAPSHOT_ACK  0x26  // header.sequence = snapshot sequence received
+#define GAME_MSG_MOUNT_REQUEST 0x27  // Board a ship's deck, or leave it with ship_id 0
 
 // Game state messages (0x30-0x3F)
 #define GAME_MSG_WORLD_STATE   0x30
@@ -18,6 +20,19 @@
 #define GAME_MSG_ENTITY_UPDATE 0x32
 #define GAME_MSG_SPAWN         0x33
 #define GAME_MSG_DESPAWN       0x34
+#define GAME_MSG_SNAPSHOT_CONFIG 0x35
+#define GAME_MSG_PROJECTILE_SPAWN 0x36
+#define GAME_MSG_PROJECTILE_HIT  0x37
+#define GAME_MSG_CREW_STATE    0x38
+#define GAME_MSG_WIND_UPDATE   0x39
+
+// Entity types carried in snapshots
+#define ENTITY_TYPE_NONE    0x00
+#define ENTITY_TYPE_PLAYER  0x01
+#define ENTITY_TYPE_SHIP    0x02
+
+// Projectile types carried in GameProjectileSpawn
+#define PROJECTILE_TYPE_CANNONBALL 0x00
 
 // Game States
 #define GAME_STATE_NONE      0x00
@@ -30,6 +45,7 @@
 #define GAME_ERR_AUTH       0x01
 #define GAME_ERR_DUPLICATE  0x02
 #define GAME_ERR_TIMEOUT    0x03
+#define GAME_ERR_ROOM       0x04    // Connect URL named a room this server doesn't host
 
 // Input Flags - Basic movement (bits 0-7)
 #define INPUT_NONE           0x0000
@@ -62,19 +78,146 @@ typedef struct {
     uint16_t ping;           // Client-measured ping
 } __attribute__((packed)) GamePlayerInputMessage;
 
+// Applied at the next tick. Boarding needs the player within reach of the
+// ship, mount_position is reserved for stations and ignored for now.
+typedef struct {
+    GameMessageHeader header;   // type = GAME_MSG_MOUNT_REQUEST
+    uint32_t ship_id;           // Ship entity id, 0 to leave the deck
+    uint8_t mount_position;
+} __attribute__((packed)) GameMountRequestMessage;
+
+// Prediction ack - sent to each client with every snapshot. The state is the
+// client's own body at the end of tick, unquantized, after every input up to
+// sequence was applied. Held inputs apply once per tick until released, so
+// the client can rewind to this state and replay inputs newer than sequence.
 typedef struct {
-    GameMessageHeader header;   // type = GAME_MSG_PLAYER_STATE
+    GameMessageHeader header;   // type = GAME_MSG_PLAYER_STATE, sequence = snapshot sequence
     uint32_t player_id;    // Player identifier
-    uint32_t sequence;     // Input sequence being acked
-    float pos_x;          // Current position
+    uint32_t sequence;     // Last input sequence applied by tick
+    uint32_t tick;         // Server simulation tick the state belongs to
+    float pos_x;          // Position at tick
     float pos_y;
-    float velocity_x;     // Current velocity
+    float velocity_x;     // Velocity at tick
     float velocity_y;
-    float rotation;       // Current rotation
-    uint32_t timestamp;   // Server timestamp
+    float rotation;       // Rotation at tick
+    float angular_velocity;
     uint8_t state_flags;  // Player state flags
 } __attribute__((packed)) GamePlayerStateMessage;
 
+// Snapshot messages - [GameSnapshotHeader][entity_count x GameEntityState]
+// GAME_MSG_WORLD_STATE carries every entity in view, GAME_MSG_SPAWN entities
+// entering view. GAME_MSG_DESPAWN carries [GameSnapshotHeader][entity_count x
+// GameEntityRef] for entities leaving view. GAME_MSG_ENTITY_UPDATE carries
+// [GameDeltaSnapshotHeader][entity_count x delta record], see below.
+typedef struct {
+    uint32_t tick;          // Server simulation tick
+    uint16_t sequence;      // Snapshot sequence
+    uint16_t entity_count;  // Entity records following
+} __attribute__((packed)) GameSnapshotHeader;
+
+typedef struct {
+    uint32_t entity_id;     // Player or ship identifier
+    uint8_t entity_type;    // ENTITY_TYPE_*
+    float pos_x;           // Current position
+    float pos_y;
+    float velocity_x;      // Current velocity
+    float velocity_y;
+    float rotation;        // Current rotation
+    uint8_t state_flags;   // Entity state flags
+} __attribute__((packed)) GameEntityState;
+
+typedef struct {
+    uint32_t entity_id;     // Player or ship identifier
+    uint8_t entity_type;    // ENTITY_TYPE_*
+} __attribute__((packed)) GameEntityRef;
+
+// Delta snapshots - fields are encoded against the client's copy of the
+// baseline snapshot as a quantized bitstream (see network/bitstream.h),
+// one record per entity with the fields set in changed_fields, in bit
+// order. Fields left out keep their baseline value. A baseline_sequence
+// equal to sequence means the records carry every field and need no baseline.
+// Entities without a record keep the state the client shows now, whether
+// they haven't changed or the server had no bandwidth for them. A record
+// with no fields set returns the entity to its baseline state.
+#define ENTITY_FIELD_POS_X      (1 << 0)
+#define ENTITY_FIELD_POS_Y      (1 << 1)
+#define ENTITY_FIELD_VELOCITY_X (1 << 2)
+#define ENTITY_FIELD_VELOCITY_Y (1 << 3)
+#define ENTITY_FIELD_ROTATION   (1 << 4)
+#define ENTITY_FIELD_FLAGS      (1 << 5)
+#define ENTITY_FIELD_ALL        0x3F
+
+typedef struct {
+    uint32_t tick;              // Server simulation tick
+    uint16_t sequence;          // Snapshot sequence
+    uint16_t baseline_sequence; // Snapshot the deltas apply to
+    uint16_t entity_count;      // Delta records following
+} __attribute__((packed)) GameDeltaSnapshotHeader;
+
+// Projectile events - [GameSnapshotHeader][entity_count x record], sent
+// alongside snapshots for projectiles near the client. Projectiles are not
+// entities and get no further updates: clients integrate the flight from
+// the spawn record, pos(t) = pos + velocity * (1 - e^(-drag * t)) / drag with
+// t in seconds since spawn_tick, and drop it at a hit or after its lifetime
+// (see physics/projectile.h for drag and lifetime).
+typedef struct {
+    uint32_t projectile_id;
+    uint32_t spawn_tick;    // Server tick the flight starts at
+    float pos_x;           // Muzzle position
+    float pos_y;
+    float velocity_x;      // Muzzle velocity
+    float velocity_y;
+    uint8_t projectile_type;  // PROJECTILE_TYPE_*
+} __attribute__((packed)) GameProjectileSpawn;
+
+typedef struct {
+    uint32_t projectile_id;
+    uint32_t target_id;     // Ship entity id
+    float damage;
+} __attribute__((packed)) GameProjectileHit;
+
+// Crew on deck - [GameSnapshotHeader][entity_count x GameCrewState], sent
+// alongside snapshots. Players aboard a ship leave the entity snapshots and
+// are carried in their ship's frame instead: a record goes out when a crew
+// member's quantized deck state changes, and every crew member of a ship
+// goes out when the ship enters the client's view. Clients place crew with
+// the ship's transform. ship_id 0 means the player left the deck, their
+// entity spawns again through the normal snapshots.
+typedef struct {
+    uint32_t player_id;
+    uint32_t ship_id;       // Ship entity id, 0 when leaving the deck
+    int16_t offset_x;       // Ship frame, 1/DECK_OFFSET_SCALE meters
+    int16_t offset_y;
+    uint8_t rotation;       // Relative to the ship's heading, 256 steps per turn
+} __attribute__((packed)) GameCrewState;
+
+// Wind - [cell_count x GameWindCell], no snapshot header. The field is a
+// WIND_GRID_DIM square of WIND_CELL_SIZE cells that repeats over the world,
+// cell = row * WIND_GRID_DIM + column with row 0 at y = 0 (world/wind_field.h).
+// The whole field goes out with a client's first world state, after that a
+// cell is sent when its wind turns or changes speed past the thresholds.
+// Clients interpolate between cell centers.
+typedef struct {
+    uint16_t cell;
+    float direction;        // Radians, where the wind blows toward
+    float speed;            // meters/second
+} __attribute__((packed)) GameWindCell;
+
+// Sent before a client's first world state, describes the delta bitstream
+typedef struct {
+    float cell_size;        // Meters per position cell
+    float max_speed;        // Velocity range is +-max_speed
+    uint8_t position_bits;  // Fixed-point bits of the offset inside a cell
+    uint8_t velocity_bits;
+    uint8_t angle_bits;
+} __attribute__((packed)) GameSnapshotConfigMessage;
+
+// Session resumption - GAME_MSG_AUTH_RESPONSE carries [player_id u32 BE]
+// [connect_time u32 BE][resume token]. A client that loses its socket can
+// reconnect with resume=<token as hex> in the URL instead of a login token
+// and gets its frozen player back within the server's grace window.
+#define GAME_RESUME_TOKEN_SIZE 16
+
 // Authentication messages
 typedef struct {
     GameMessageHeader header;   // type = GAME_MSG_AUTH_REQUEST
@@ -4,40 +4,169 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
 
 // Remove duplicate PlayerConnection struct definition
 
 bool initPlayerConnectionManager(PlayerConnectionManager* manager, 
                               DatabaseClient* db_client,
-                              b2WorldId worldId) {
+                              WorldCells* cells) {
     manager->connections = malloc(sizeof(PlayerConnection) * 100); // Start with 100 slots
     if (!manager->connections) return false;
     
     manager->count = 0;
     manager->capacity = 100;
     manager->db_client = db_client;
-    manager->worldId = worldId;
+    manager->cells = cells;
     manager->db_ready = false;  // Initialize as not ready
+    manager->resume_grace = PLAYER_DEFAULT_RESUME_GRACE;
+    manager->journal = NULL;
     return true;
 }
 
 // Define handler before it's used
 static void onPlayerMessage(void* context, WebSocket* ws, const uint8_t* data, size_t length) {
-    PlayerConnectionManager* manager = (PlayerConnectionManager*)context;
+    (void)context;  // Handlers only queue per-player state, the room applies it
     PlayerConnection* player = (PlayerConnection*)ws->user_data;
     
     if (!player || length < 1) return;
     
     switch (data[0]) {
         case GAME_MSG_INPUT:  // Changed from GAME_MSG_PLAYER_INPUT
-            handlePlayerInput(player, data + 1, length - 1, manager);
+            handlePlayerInput(player, data + 1, length - 1);
             break;
+        case GAME_MSG_SNAPSHOT_ACK:
+            handleSnapshotAck(player, data + 1, length - 1);
+            break;
+        case GAME_MSG_MOUNT_REQUEST:
+            handleMountRequest(player, data + 1, length - 1);
+            break;
+    }
+}
+
+// Auth response carries the token the client needs to resume after a drop
+static void sendAuthResponse(PlayerConnection* conn, WebSocket* ws) {
+    uint8_t response[4 + 8 + GAME_RESUME_TOKEN_SIZE] = {
+        GAME_MSG_AUTH_RESPONSE,
+        GAME_STATE_ACCEPTED,
+        0x00, 8 + GAME_RESUME_TOKEN_SIZE,
+        // Player ID (4 bytes)
+        (conn->player_id >> 24) & 0xFF,
+        (conn->player_id >> 16) & 0xFF,
+        (conn->player_id >> 8) & 0xFF,
+        conn->player_id & 0xFF,
+        // Connection time (4 bytes)
+        (conn->connect_time >> 24) & 0xFF,
+        (conn->connect_time >> 16) & 0xFF,
+        (conn->connect_time >> 8) & 0xFF,
+        conn->connect_time & 0xFF
+    };
+    memcpy(response + 12, conn->resume_token, GAME_RESUME_TOKEN_SIZE);
+    ws_send_binary(ws, response, sizeof(response));
+}
+
+// Without a token the session can't be resumed, a drop is a normal departure
+static bool issueResumeToken(PlayerConnection* conn) {
+    conn->resumable = RAND_bytes(conn->resume_token, GAME_RESUME_TOKEN_SIZE) == 1;
+    if (!conn->resumable) {
+        fprintf(stderr, "[Player] Failed to generate resume token for player %u, session not resumable\n",
+                conn->player_id);
+        memset(conn->resume_token, 0, GAME_RESUME_TOKEN_SIZE);
+    }
+    return conn->resumable;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool parseResumeToken(const char* hex, uint8_t* out) {
+    if (strlen(hex) != GAME_RESUME_TOKEN_SIZE * 2) return false;
+    for (int i = 0; i < GAME_RESUME_TOKEN_SIZE; i++) {
+        int hi = hexValue(hex[i * 2]);
+        int lo = hexValue(hex[i * 2 + 1]);
+        if (hi < 0 || lo < 0) return false;
+        out[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return true;
+}
+
+// Hand a frozen player to a new socket - the body picks up where it stopped
+static void resumePlayerSession(PlayerConnectionManager* manager, PlayerConnection* conn, WebSocket* ws) {
+    conn->ws = *ws;
+    conn->suspended = false;
+    conn->last_activity = time(NULL);
+    conn->needs_full_snapshot = true;
+    // Crew stay disabled, the deck carried them while they were away
+    if (conn->deck.shipId == 0) b2Body_Enable(conn->physics_body);
+    issueResumeToken(conn);
+    recordJournalEvent(manager->journal, JOURNAL_PLAYER_RESUME, conn->player_id, 0, 0.0f, 0.0f);
+
+    ws->user_data = conn;
+    ws_set_message_handler(ws, onPlayerMessage, manager);
+    sendAuthResponse(conn, ws);
+
+    fprintf(stderr, "[Player] Player %u resumed after %lds\n",
+            conn->player_id, (long)(conn->last_activity - conn->suspended_at));
+}
+
+static bool tryResumePlayerSession(PlayerConnectionManager* manager, const char* hex, WebSocket* ws) {
+    uint8_t token[GAME_RESUME_TOKEN_SIZE];
+    if (!parseResumeToken(hex, token)) return false;
+
+    // All zeros is what a failed issue leaves behind, never a real token
+    uint8_t any = 0;
+    for (int i = 0; i < GAME_RESUME_TOKEN_SIZE; i++) any |= token[i];
+    if (any == 0) {
+        fprintf(stderr, "[Player] Rejected an empty resume token\n");
+        return false;
+    }
+
+    for (size_t i = 0; i < manager->count; i++) {
+        PlayerConnection* conn = &manager->connections[i];
+        if (conn->suspended && conn->resumable && CRYPTO_memcmp(conn->resume_token, token, GAME_RESUME_TOKEN_SIZE) == 0) {
+            resumePlayerSession(manager, conn, ws);
+            return true;
+        }
     }
+    fprintf(stderr, "[Player] Resume token did not match a suspended session\n");
+    return false;
+}
+
+// Freeze the player in place instead of removing it, until resumed or expired
+static void suspendPlayerSession(PlayerConnection* conn, time_t now) {
+    b2Body_SetLinearVelocity(conn->physics_body, (b2Vec2){0.0f, 0.0f});
+    b2Body_SetAngularVelocity(conn->physics_body, 0.0f);
+    b2Body_Disable(conn->physics_body);
+
+    // The client gets a full snapshot on resume, so nothing sent so far matters
+    freeClientSnapshotHistory(conn->snapshot_history);
+    conn->snapshot_history = NULL;
+    conn->active_input_flags = 0;
+    conn->journaled_flags = 0;
+    conn->mount_pending = false;
+    memset(&conn->input_queue, 0, sizeof(conn->input_queue));
+
+    ws_disconnect(&conn->ws);
+    conn->suspended = true;
+    conn->suspended_at = now;
+
+    fprintf(stderr, "[Player] Player %u suspended, resumable for a grace window\n", conn->player_id);
 }
 
 bool handleNewPlayerConnection(PlayerConnectionManager* manager, 
                              const char* token,
                              WebSocket* ws) {
+    // A client reattaching to its frozen player skips auth entirely
+    if (manager && ws && ws->handshake_complete) {
+        const char* resume = ws_get_resume_token(ws);
+        if (resume && tryResumePlayerSession(manager, resume, ws)) return true;
+    }
+
     // Add database readiness check
     if (!manager || !manager->db_client || !manager->db_ready) {
         fprintf(stderr, "Cannot accept connections - database not ready\n");
@@ -129,7 +258,11 @@ bool handleNewPlayerConnection(PlayerConnectionManager* manager,
     // Check for existing connection with same player_id
     for (size_t i = 0; i < manager->count; i++) {
         if (manager->connections[i].player_id == result.data.player_id) {
-            if (manager->connections[i].authenticated) {
+            if (manager->connections[i].suspended) {
+                // Logged back in within the grace window, keep the existing body
+                resumePlayerSession(manager, &manager->connections[i], ws);
+                return true;
+            } else if (manager->connections[i].authenticated) {
                 fprintf(stderr, "[Player] Player %u already connected\n", 
                         result.data.player_id);
                 uint8_t error_msg[] = {
@@ -171,36 +304,25 @@ bool handleNewPlayerConnection(PlayerConnectionManager* manager,
     conn->ws = temp_ws;  // Copy our local WebSocket
     conn->connect_time = time(NULL);
     conn->last_activity = time(NULL);
+    conn->needs_full_snapshot = true;
+    issueResumeToken(conn);
     
     // Create physics body for player
-    conn->physics_body = createPlayerBody(manager->worldId, 0.0f, 0.0f);
+    b2Vec2 spawn;
+    b2WorldId spawnWorld = worldCellWorldAt(manager->cells, (b2Vec2){0.0f, 0.0f}, &spawn);
+    conn->physics_body = createPlayerBody(spawnWorld, spawn.x, spawn.y);
     if (!b2Body_IsValid(conn->physics_body)) {
         fprintf(stderr, "[Player] Failed to create physics body\n");
         return false;
     }
+    recordJournalEvent(manager->journal, JOURNAL_PLAYER_JOIN, conn->player_id, 0, 0.0f, 0.0f);
 
     // Update message handler setup
     ws->user_data = conn;  // Store player connection
     ws_set_message_handler(ws, onPlayerMessage, manager);  // Pass manager as context
 
     // Send successful connection message with player data
-    uint8_t connect_success[12] = {
-        GAME_MSG_AUTH_RESPONSE,
-        GAME_STATE_ACCEPTED,
-        0x00, 0x08,             // Payload length (8 bytes)
-        // Player ID (4 bytes)
-        (result.data.player_id >> 24) & 0xFF,
-        (result.data.player_id >> 16) & 0xFF,
-        (result.data.player_id >> 8) & 0xFF,
-        result.data.player_id & 0xFF,
-        // Connection time (4 bytes)
-        (conn->connect_time >> 24) & 0xFF,
-        (conn->connect_time >> 16) & 0xFF,
-        (conn->connect_time >> 8) & 0xFF,
-        conn->connect_time & 0xFF
-    };
-    
-    ws_send_binary(ws, connect_success, sizeof(connect_success));
+    sendAuthResponse(conn, ws);
 
     // Send initial player state
     uint8_t player_init[] = {
@@ -229,130 +351,287 @@ void cleanupPlayerConnectionManager(PlayerConnectionManager* manager) {
             free(conn->username);
             conn->username = NULL;
         }
+        freeClientSnapshotHistory(conn->snapshot_history);
+        conn->snapshot_history = NULL;
     }
     
     if (manager->connections) {  // Add null check
         free(manager->connections);
         manager->connections = NULL;
     }
+    free(manager->departed_bodies);
+    manager->departed_bodies = NULL;
+    manager->departed_count = 0;
+    manager->departed_capacity = 0;
+    freePlayerMovementBatch(&manager->movement);
+    freeDeckCrewBatch(&manager->crew);
     manager->count = 0;
     manager->capacity = 0;
 }
 
+// Suspends brief drops, returns true for players that should leave now
+static bool playerDeparted(PlayerConnectionManager* manager, PlayerConnection* conn, time_t now) {
+    bool dropped = !conn->ws.connected || conn->ws.sock <= 0;
+
+    if (conn->suspended) {
+        if (now - conn->suspended_at < manager->resume_grace) return false;
+        fprintf(stderr, "[Player] Player %u resume window expired\n", conn->player_id);
+    } else if (dropped && conn->authenticated && conn->resumable && manager->resume_grace > 0 &&
+               b2Body_IsValid(conn->physics_body)) {
+        // Brief drops keep the body, so nobody sees a despawn and respawn
+        suspendPlayerSession(conn, now);
+        recordJournalEvent(manager->journal, JOURNAL_PLAYER_SUSPEND, conn->player_id, 0, 0.0f, 0.0f);
+        return false;
+    }
+    return dropped;
+}
+
+static bool queueDeparture(PlayerConnectionManager* manager, const PlayerConnection* conn) {
+    if (manager->departed_count >= manager->departed_capacity) {
+        size_t new_capacity = manager->departed_capacity ? manager->departed_capacity * 2 : 64;
+        b2BodyId* bodies = realloc(manager->departed_bodies, new_capacity * sizeof(b2BodyId));
+        if (!bodies) {
+            fprintf(stderr, "[Player] Failed to grow departure list to %zu\n", new_capacity);
+            return false;
+        }
+        manager->departed_bodies = bodies;
+        manager->departed_capacity = new_capacity;
+    }
+
+    manager->departed_bodies[manager->departed_count++] = conn->physics_body;
+    return true;
+}
+
+// Tear down every body removed this tick together. The players are announced
+// once, as despawn records in each viewer's next snapshot.
+static void flushPlayerDepartures(PlayerConnectionManager* manager) {
+    if (manager->departed_count == 0) return;
+
+    for (size_t i = 0; i < manager->departed_count; i++) {
+        if (b2Body_IsValid(manager->departed_bodies[i])) {
+            b2DestroyBody(manager->departed_bodies[i]);
+        }
+    }
+
+    fprintf(stderr, "[Player] %zu player(s) left this tick\n", manager->departed_count);
+    manager->departed_count = 0;
+}
+
 void removeDisconnectedPlayers(PlayerConnectionManager* manager) {
+    time_t now = time(NULL);
+    size_t kept = 0;
+
     for (size_t i = 0; i < manager->count; i++) {
         PlayerConnection* conn = &manager->connections[i];
-        
-        if (!conn->ws.connected || conn->ws.sock <= 0) {
-            fprintf(stderr, "[Player] Player %u disconnecting, cleaning up...\n", 
-                    conn->player_id);
-
-            // Send graceful disconnect message to other players
-            uint8_t disconnect_msg[] = {
-                GAME_MSG_DISCONNECT,
-                0x00,  // Normal disconnect
-                0x00, 0x04,  // 4 byte payload
-                (conn->player_id >> 24) & 0xFF,
-                (conn->player_id >> 16) & 0xFF,
-                (conn->player_id >> 8) & 0xFF,
-                conn->player_id & 0xFF
-            };
-
-            // Broadcast disconnect to other players
-            for (size_t j = 0; j < manager->count; j++) {
-                if (j != i && manager->connections[j].authenticated) {
-                    ws_send_binary(&manager->connections[j].ws, 
-                                 disconnect_msg, 
-                                 sizeof(disconnect_msg));
-                }
-            }
 
-            // Clean up physics body if it exists
-            if (b2Body_IsValid(conn->physics_body)) {
-                b2DestroyBody(conn->physics_body);
-                conn->physics_body = b2_nullBodyId;
-            }
+        if (!playerDeparted(manager, conn, now) || !queueDeparture(manager, conn)) {
+            // Compact in place rather than shifting the array once per departure
+            if (kept != i) manager->connections[kept] = *conn;
+            kept++;
+            continue;
+        }
 
-            // Clean up allocated resources
-            if (conn->username) {
-                free(conn->username);
-                conn->username = NULL;
-            }
+        fprintf(stderr, "[Player] Player %u disconnecting, cleaning up...\n", 
+                conn->player_id);
+        recordJournalEvent(manager->journal, JOURNAL_PLAYER_LEAVE, conn->player_id, 0, 0.0f, 0.0f);
+        conn->physics_body = b2_nullBodyId;
 
-            // Reset authentication state to allow reconnection
-            conn->authenticated = false;
-            conn->last_activity = 0;
-            conn->last_input_seq = 0;
-            conn->last_input_time = 0;
+        // Clean up allocated resources
+        if (conn->username) {
+            free(conn->username);
+            conn->username = NULL;
+        }
 
-            // Close WebSocket connection
-            ws_disconnect(&conn->ws);
+        freeClientSnapshotHistory(conn->snapshot_history);
+        conn->snapshot_history = NULL;
 
-            // Remove from active connections array
-            if (i < manager->count - 1) {
-                memmove(&manager->connections[i],
-                       &manager->connections[i + 1],
-                       (manager->count - i - 1) * sizeof(PlayerConnection));
-            }
-            manager->count--;
-            i--; // Recheck this index since we shifted elements
-
-            fprintf(stderr, "[Player] Player %u cleanup complete\n", 
-                    conn->player_id);
-        }
+        // Close WebSocket connection
+        ws_disconnect(&conn->ws);
     }
+    manager->count = kept;
+
+    flushPlayerDepartures(manager);
+}
+
+// Wrap-aware comparison for 16-bit sequence numbers
+static inline bool isNewerSequence(uint16_t seq, uint16_t last) {
+    return (int16_t)(seq - last) > 0;
 }
 
-// Update function signature to include manager
-void handlePlayerInput(PlayerConnection* player, const uint8_t* data, size_t length, PlayerConnectionManager* manager) {
+// Queue input for the next tick - nothing is simulated or sent from here
+void handlePlayerInput(PlayerConnection* player, const uint8_t* data, size_t length) {
     if (length < sizeof(GamePlayerInputMessage)) return;
     
     const GamePlayerInputMessage* input = (const GamePlayerInputMessage*)data;
-    float dt = (input->client_time - player->last_input_time) / 1000.0f;
+    PlayerInputQueue* queue = &player->input_queue;
+    
+    // Only queue inputs newer than anything already applied or queued
+    uint16_t newest_seq = (queue->tail != queue->head)
+        ? queue->items[(queue->tail - 1) & PLAYER_INPUT_QUEUE_MASK].sequence
+        : (uint16_t)player->last_input_seq;
+    if (!isNewerSequence(input->header.sequence, newest_seq)) return;
+    
+    QueuedPlayerInput queued = {
+        .sequence = input->header.sequence,
+        .input_flags = input->input_flags,
+        .changed_flags = input->changed_flags,
+        .rotation = input->rotation,
+        .client_time = input->client_time,
+        .ping = input->ping
+    };
     
-    // Only process newer inputs
-    if (input->header.sequence > player->last_input_seq) {  // Fix: access sequence through header
-        // Apply movement
-        applyPlayerMovement(player->physics_body, input->input_flags, dt);
-        limitPlayerVelocity(player->physics_body);
+    // Coalesce with the previous queued input if it holds the same keys
+    if (queue->tail != queue->head) {
+        QueuedPlayerInput* last = &queue->items[(queue->tail - 1) & PLAYER_INPUT_QUEUE_MASK];
+        if (last->input_flags == queued.input_flags) {
+            queued.changed_flags |= last->changed_flags;
+            *last = queued;
+            return;
+        }
+    }
+    
+    // Full queue - drop the oldest input, the newest state wins
+    if (queue->tail - queue->head >= PLAYER_INPUT_QUEUE_SIZE) {
+        queue->head++;
+        queue->dropped++;
+    }
+    queue->items[queue->tail & PLAYER_INPUT_QUEUE_MASK] = queued;
+    queue->tail++;
+}
+
+// Client confirms a snapshot - it becomes the delta baseline for later ones
+void handleSnapshotAck(PlayerConnection* player, const uint8_t* data, size_t length) {
+    if (length < sizeof(GameMessageHeader)) return;
+    
+    const GameMessageHeader* header = (const GameMessageHeader*)data;
+    acknowledgeClientSnapshot(player, header->sequence);
+}
+
+// Board or leave a ship - the newest request wins, applied at the next tick
+void handleMountRequest(PlayerConnection* player, const uint8_t* data, size_t length) {
+    if (length < sizeof(GameMountRequestMessage)) return;
+
+    const GameMountRequestMessage* request = (const GameMountRequestMessage*)data;
+    player->mount_ship_id = request->ship_id;
+    player->mount_pending = true;
+}
+
+// Crew have to leave a deck before boarding another
+static void applyMountRequest(PlayerConnectionManager* manager, PlayerConnection* player, int slot,
+                              const EntityStateMirror* mirror) {
+    player->mount_pending = false;
+    uint32_t ship = player->mount_ship_id;
+
+    if (ship == 0 && player->deck.shipId != 0) {
+        player->physics_body = leaveShip(&player->deck, player->physics_body, manager->cells, &mirror->players,
+                                         slot);
+        recordJournalEvent(manager->journal, JOURNAL_PLAYER_DISEMBARK, player->player_id, 0, 0.0f, 0.0f);
+    } else if (ship != 0 && player->deck.shipId == 0 &&
+               boardShip(&player->deck, player->physics_body, &mirror->players, slot, &mirror->ships, ship)) {
+        recordJournalTargetEvent(manager->journal, JOURNAL_PLAYER_BOARD, player->player_id, ship);
+        fprintf(stderr, "[Player] Player %u boarded ship %u\n", player->player_id, ship);
+    }
+}
+
+// Cannonball along the player's facing, inheriting the player's velocity.
+// Crew fire from their mirrored deck pose and pass through their own ship.
+static void firePlayerProjectile(PlayerConnection* player, int slot, ProjectileSystem* projectiles,
+                                 const EntityStateMirror* mirror, uint32_t tick) {
+    if (tick < player->next_fire_tick) return;
+
+    uint32_t id;
+    if (player->deck.shipId != 0) {
+        const EntityStateArrays* players = &mirror->players;
+        if (!entityStateSlotMatches(players, slot, player->physics_body)) return;
+        id = fireProjectileFrom(projectiles, (b2Vec2){players->x[slot], players->y[slot]}, players->rot[slot],
+                                (b2Vec2){players->vx[slot], players->vy[slot]}, player->deck.shipId, tick);
+    } else {
+        id = fireProjectileFromBody(projectiles, player->physics_body, tick);
+    }
+    if (id) player->next_fire_tick = tick + PROJECTILE_FIRE_COOLDOWN;
+}
+
+// Drain every player's input queue once per physics tick. Forces are held
+// for the whole step, so the step length never enters here.
+void processPlayerInputs(PlayerConnectionManager* manager, ProjectileSystem* projectiles,
+                         const EntityStateMirror* mirror, uint32_t tick) {
+    if (!manager) return;
+
+    PlayerMovementBatch* movement = &manager->movement;
+    movement->count = 0;
+    reservePlayerMovementBatch(movement, (int)manager->count);
+
+    for (size_t i = 0; i < manager->count; i++) {
+        PlayerConnection* player = &manager->connections[i];
+        if (!player->authenticated || player->suspended || !b2Body_IsValid(player->physics_body)) continue;
+        if (player->mount_pending && mirror) applyMountRequest(manager, player, (int)i, mirror);
         
-        // Update tracking
-        player->last_input_seq = input->header.sequence;  // Fix: access sequence through header
-        player->last_input_time = input->client_time;
+        PlayerInputQueue* queue = &player->input_queue;
+        uint16_t edge_flags = 0;
         
-        // Send immediate state update
-        sendPlayerState(player, manager);
+        // Inputs carry held-key state, so the newest one supersedes the rest.
+        // Action presses are kept so a tap between two ticks is not lost.
+        while (queue->tail != queue->head) {
+            const QueuedPlayerInput* input = &queue->items[queue->head & PLAYER_INPUT_QUEUE_MASK];
+            edge_flags |= input->input_flags & PLAYER_INPUT_EDGE_FLAGS;
+            player->active_input_flags = input->input_flags;
+            player->last_input_seq = input->sequence;
+            player->last_input_time = input->client_time;
+            player->last_ping = input->ping;
+            queue->head++;
+        }
+        
+        // Held inputs keep applying force every tick until released
+        uint16_t flags = player->active_input_flags | edge_flags;
+        if (flags != player->journaled_flags) {
+            recordJournalEvent(manager->journal, JOURNAL_PLAYER_INPUT, player->player_id, flags, 0.0f, 0.0f);
+            player->journaled_flags = flags;
+        }
+        // Crew walk in the deck pass after the step, their bodies are disabled
+        if (player->deck.shipId == 0) addPlayerMovement(movement, player->physics_body, flags);
+        if ((flags & INPUT_ACTION1) && projectiles && (player->deck.shipId == 0 || mirror)) {
+            firePlayerProjectile(player, (int)i, projectiles, mirror, tick);
+        }
     }
+
+    computePlayerMovementForces(movement);
+    applyPlayerMovementBatch(movement);
 }
 
-// Update sendPlayerState signature
-void sendPlayerState(PlayerConnection* player, PlayerConnectionManager* manager) {
-    b2Vec2 pos = b2Body_GetPosition(player->physics_body);
-    b2Vec2 vel = b2Body_GetLinearVelocity(player->physics_body);
-    float rot = b2Body_GetAngle(player->physics_body);
-    
-    GamePlayerStateMessage msg = {0};  // Zero initialize
-    msg.header.type = GAME_MSG_PLAYER_STATE;  // Fix: access type through header
-    msg.header.sequence = player->last_input_seq;  // Fix: access sequence through header
-    msg.player_id = player->player_id;
-    msg.pos_x = pos.x;
-    msg.pos_y = pos.y;
-    msg.velocity_x = vel.x;
-    msg.velocity_y = vel.y;
-    msg.rotation = rot;
-    msg.timestamp = (uint32_t)time(NULL);
-    msg.state_flags = GAME_STATE_ACCEPTED;
-    
-    uint8_t packet[sizeof(msg) + 4] = {
-        GAME_MSG_PLAYER_STATE,
-        0x00,
-        (sizeof(msg) >> 8) & 0xFF,
-        sizeof(msg) & 0xFF
-    };
-    memcpy(packet + 4, &msg, sizeof(msg));
-    
-    // Broadcast to all players
+// Crew whose ship is gone step off where the deck last carried them. The
+// slot is re-pointed at once so the rest of the tick sees the new body.
+static void disembarkStrandedCrew(PlayerConnectionManager* manager, PlayerConnection* player, int slot,
+                                  EntityStateMirror* mirror, uint32_t tick) {
+    fprintf(stderr, "[Player] Player %u's ship %u is gone, leaving the deck\n", player->player_id,
+            player->deck.shipId);
+    player->physics_body = leaveShip(&player->deck, player->physics_body, manager->cells, &mirror->players, slot);
+    if (player->suspended && b2Body_IsValid(player->physics_body)) b2Body_Disable(player->physics_body);
+    repointEntityStateSlot(mirror, &mirror->players, ENTITY_TYPE_PLAYER, slot, player->physics_body,
+                           player->player_id, tick);
+}
+
+void stepPlayerCrew(PlayerConnectionManager* manager, EntityStateMirror* mirror, uint32_t tick, float dt) {
+    if (!manager || !mirror) return;
+
+    DeckCrewBatch* crew = &manager->crew;
+    crew->count = 0;
+
     for (size_t i = 0; i < manager->count; i++) {
-        ws_send_binary(&manager->connections[i].ws, packet, sizeof(packet));
+        PlayerConnection* player = &manager->connections[i];
+        if (player->deck.shipId == 0 || !entityStateSlotMatches(&mirror->players, (int)i, player->physics_body)) {
+            continue;
+        }
+
+        int ship = resolveDeckShip(&player->deck, &mirror->ships);
+        if (ship < 0) {
+            disembarkStrandedCrew(manager, player, (int)i, mirror, tick);
+            continue;
+        }
+        // Suspended crew stand still and ride along
+        uint16_t flags = player->suspended ? 0 : player->active_input_flags;
+        addDeckCrew(crew, &player->deck, (int)i, flags, &mirror->ships, mirror->ships.bodies[ship]);
     }
+
+    stepDeckCrewBatch(crew, dt);
+    applyDeckCrewBatch(crew, mirror, tick);
 }
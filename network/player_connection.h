@@ -5,14 +5,45 @@
 #include <stdbool.h>
 #include <time.h>
 
+#include "../core/game_state.h"
+#include "../core/input_journal.h"
 #include "../database/db_client.h"
 #include "../physics/player/player_physics.h"
+#include "../physics/projectile.h"
+#include "../physics/ship/ship_deck.h"
 #include "websockets/websocket.h"
 #include "game_protocol.h"
 
 // Forward declare message handler before structs
 static void onPlayerMessage(void* context, WebSocket* ws, const uint8_t* data, size_t length);
 
+// Input queue - inputs are buffered on receipt and drained once per physics tick
+#define PLAYER_INPUT_QUEUE_SIZE 32    // Must be a power of two (~0.5s of inputs at 60Hz)
+#define PLAYER_INPUT_QUEUE_MASK (PLAYER_INPUT_QUEUE_SIZE - 1)
+#define PLAYER_INPUT_EDGE_FLAGS (INPUT_ACTION1 | INPUT_ACTION2)  // Kept even if released before the tick
+
+typedef struct {
+    uint16_t sequence;        // Input sequence from message header
+    uint16_t input_flags;     // Active inputs
+    uint16_t changed_flags;   // Inputs that changed this frame
+    float rotation;           // Client-reported rotation
+    uint32_t client_time;     // Client timestamp
+    uint16_t ping;            // Client-measured round trip, ms
+} QueuedPlayerInput;
+
+typedef struct {
+    QueuedPlayerInput items[PLAYER_INPUT_QUEUE_SIZE];
+    uint32_t head;            // Next item to drain
+    uint32_t tail;            // Next free slot
+    uint32_t dropped;         // Inputs discarded because the queue was full
+} PlayerInputQueue;
+
+// Session resumption - a dropped player's body stays frozen in the world
+#define PLAYER_DEFAULT_RESUME_GRACE 10   // Seconds, 0 removes players immediately
+
+// Defined in snapshot.h
+struct ClientSnapshotHistory;
+
 // Full structure definitions - remove 'typedef struct' to avoid redefinition
 struct PlayerConnection {
     uint32_t player_id;
@@ -24,6 +55,20 @@ struct PlayerConnection {
     b2BodyId physics_body;
     uint32_t last_input_seq;
     double last_input_time;
+    uint16_t last_ping;             // Round trip reported with the newest input, ms
+    PlayerInputQueue input_queue;   // Inputs received since the last tick
+    uint16_t active_input_flags;    // Inputs held as of the last tick
+    uint16_t journaled_flags;       // Applied flags last written to the input journal
+    uint32_t next_fire_tick;        // Earliest tick ACTION1 can fire again
+    bool needs_full_snapshot;       // Next snapshot must carry the whole world
+    struct ClientSnapshotHistory* snapshot_history;  // Snapshots sent, for delta baselines
+    bool suspended;                 // Socket dropped, body frozen until resumed or expired
+    time_t suspended_at;
+    uint8_t resume_token[GAME_RESUME_TOKEN_SIZE];    // Issued at auth, rotated on every resume
+    bool resumable;                 // resume_token is valid, false if generating it failed
+    DeckPosition deck;              // Ship the player is aboard, shipId 0 on foot
+    bool mount_pending;             // Mount request received, applied at the next tick
+    uint32_t mount_ship_id;         // Requested ship, 0 to leave the deck
 };
 
 struct PlayerConnectionManager {
@@ -31,8 +76,15 @@ struct PlayerConnectionManager {
     size_t count;
     size_t capacity;
     DatabaseClient* db_client;
-    b2WorldId worldId;
+    WorldCells* cells;              // Players spawn in the cell holding their position
     bool db_ready;
+    int resume_grace;               // Seconds a suspended player can be resumed
+    b2BodyId* departed_bodies;      // Bodies of players removed this tick, destroyed after the scan
+    size_t departed_count;
+    size_t departed_capacity;
+    PlayerMovementBatch movement;   // This tick's inputs, applied in one pass
+    DeckCrewBatch crew;             // This tick's crew on deck, stepped in one pass
+    InputJournal* journal;          // Room's input journal, NULL when off
 };
 
 // Type aliases
@@ -40,12 +92,17 @@ typedef struct PlayerConnection PlayerConnection;
 typedef struct PlayerConnectionManager PlayerConnectionManager;
 
 // Function declarations
-bool initPlayerConnectionManager(PlayerConnectionManager* manager, DatabaseClient* db_client, b2WorldId worldId);
+bool initPlayerConnectionManager(PlayerConnectionManager* manager, DatabaseClient* db_client, WorldCells* cells);
 bool handleNewPlayerConnection(PlayerConnectionManager* manager, const char* token, WebSocket* ws);
 void removeDisconnectedPlayers(PlayerConnectionManager* manager);
 void cleanupPlayerConnectionManager(PlayerConnectionManager* manager);
-void handlePlayerInput(PlayerConnection* player, const uint8_t* data, size_t length, PlayerConnectionManager* manager);
-void sendPlayerState(PlayerConnection* player, PlayerConnectionManager* manager);
+void handlePlayerInput(PlayerConnection* player, const uint8_t* data, size_t length);
+void processPlayerInputs(PlayerConnectionManager* manager, ProjectileSystem* projectiles,
+                         const EntityStateMirror* mirror, uint32_t tick);
+void handleMountRequest(PlayerConnection* player, const uint8_t* data, size_t length);
+// After the mirror sync: walk crew on deck and write their global state into the mirror
+void stepPlayerCrew(PlayerConnectionManager* manager, EntityStateMirror* mirror, uint32_t tick, float dt);
+void handleSnapshotAck(PlayerConnection* player, const uint8_t* data, size_t length);
 bool verifyUserToken(DatabaseClient* client, const char* token, TokenVerifyResult* result);
 
 #endif
@@ -0,0 +1,910 @@
+#include "snapshot.h"
+#include "../physics/player/player_physics.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+static bool reserveEntityList(SnapshotEntityList* list, int capacity) {
+    if (list->capacity >= capacity) return true;
+
+    int new_capacity = list->capacity ? list->capacity : 64;
+    while (new_capacity < capacity) new_capacity *= 2;
+
+    SnapshotEntity* entities = realloc(list->entities, new_capacity * sizeof(SnapshotEntity));
+    if (!entities) {
+        fprintf(stderr, "[Snapshot] Failed to grow entity list to %d\n", new_capacity);
+        return false;
+    }
+    list->entities = entities;
+    list->capacity = new_capacity;
+    return true;
+}
+
+static int compareSnapshotEntities(const void* a, const void* b) {
+    EntityKey ka = ((const SnapshotEntity*)a)->key;
+    EntityKey kb = ((const SnapshotEntity*)b)->key;
+    return (ka > kb) - (ka < kb);
+}
+
+static bool reserveChangeTracking(SnapshotBroadcaster* snap, int slots, int entities) {
+    if (snap->indexCapacity < slots) {
+        int new_capacity = snap->indexCapacity ? snap->indexCapacity : 64;
+        while (new_capacity < slots) new_capacity *= 2;
+
+        int* players = realloc(snap->playerIndex, new_capacity * sizeof(int));
+        if (players) snap->playerIndex = players;
+        int* ships = realloc(snap->shipIndex, new_capacity * sizeof(int));
+        if (ships) snap->shipIndex = ships;
+        if (!players || !ships) {
+            fprintf(stderr, "[Snapshot] Failed to grow slot index to %d\n", new_capacity);
+            return false;
+        }
+        snap->indexCapacity = new_capacity;
+    }
+
+    if (snap->pendingCapacity < entities) {
+        int* pending = realloc(snap->pending, entities * sizeof(int));
+        if (!pending) {
+            fprintf(stderr, "[Snapshot] Failed to grow pending list to %d\n", entities);
+            return false;
+        }
+        snap->pending = pending;
+        snap->pendingCapacity = entities;
+    }
+    return true;
+}
+
+static inline void readMirroredState(SnapshotEntity* entity, const EntityStateArrays* arrays, int slot,
+                                     uint8_t flags) {
+    entity->state.state_flags = flags | arrays->stateFlags[slot];
+    entity->state.pos_x = arrays->x[slot];
+    entity->state.pos_y = arrays->y[slot];
+    entity->state.velocity_x = arrays->vx[slot];
+    entity->state.velocity_y = arrays->vy[slot];
+    entity->state.rotation = arrays->rot[slot];
+    entity->changedTick = arrays->changedTick[slot];
+}
+
+static void appendMirroredEntities(SnapshotEntityList* list, const EntityStateArrays* arrays,
+                                   uint8_t type, uint8_t flags) {
+    for (int i = 0; i < arrays->count; i++) {
+        // Crew replicate through their ship, see sendCrewStates
+        if (!(arrays->flags[i] & ENTITY_STATE_ACTIVE) || (arrays->flags[i] & ENTITY_STATE_ON_DECK)) continue;
+
+        SnapshotEntity* entity = &list->entities[list->count++];
+        entity->key = ENTITY_KEY(type, arrays->ids[i]);
+        entity->state = (GameEntityState){
+            .entity_id = arrays->ids[i],
+            .entity_type = type
+        };
+        entity->slot = i;
+        entity->pending = false;
+        readMirroredState(entity, arrays, i, flags);
+    }
+}
+
+// Collect every replicated entity from the state mirror, sorted by key. Only
+// needed when entities come or go, moves are applied by trackSnapshotChanges.
+static void collectEntities(SnapshotBroadcaster* snap, const EntityStateMirror* mirror) {
+    SnapshotEntityList* list = &snap->current;
+    list->count = 0;
+    snap->pendingCount = 0;
+    snap->collected = false;
+
+    int slots = mirror->players.count > mirror->ships.count ? mirror->players.count : mirror->ships.count;
+    if (!reserveEntityList(list, mirror->players.count + mirror->ships.count) ||
+        !reserveChangeTracking(snap, slots, list->capacity)) return;
+    appendMirroredEntities(list, &mirror->players, ENTITY_TYPE_PLAYER, GAME_STATE_ACCEPTED);
+    appendMirroredEntities(list, &mirror->ships, ENTITY_TYPE_SHIP, 0);
+
+    qsort(list->entities, list->count, sizeof(SnapshotEntity), compareSnapshotEntities);
+
+    for (int i = 0; i < mirror->players.count; i++) snap->playerIndex[i] = -1;
+    for (int i = 0; i < mirror->ships.count; i++) snap->shipIndex[i] = -1;
+    for (int i = 0; i < list->count; i++) {
+        const SnapshotEntity* entity = &list->entities[i];
+        int* index = ENTITY_KEY_TYPE(entity->key) == ENTITY_TYPE_PLAYER ? snap->playerIndex : snap->shipIndex;
+        index[entity->slot] = i;
+    }
+    snap->membershipTick = mirror->membershipTick;
+    snap->collected = true;
+}
+
+static void trackMirroredChanges(SnapshotBroadcaster* snap, const EntityStateArrays* arrays, const int* index,
+                                 uint8_t flags) {
+    for (int d = 0; d < arrays->dirtyCount; d++) {
+        int i = index[arrays->dirty[d]];
+        if (i < 0) continue;
+
+        SnapshotEntity* entity = &snap->current.entities[i];
+        readMirroredState(entity, arrays, entity->slot, flags);
+        if (!entity->pending) {
+            entity->pending = true;
+            snap->pending[snap->pendingCount++] = i;
+        }
+    }
+}
+
+void trackSnapshotChanges(SnapshotBroadcaster* snap, const EntityStateMirror* mirror) {
+    if (!snap || !mirror) return;
+    // A membership change means a full collect at the next broadcast anyway
+    if (!snap->collected || mirror->membershipTick != snap->membershipTick) return;
+
+    trackMirroredChanges(snap, &mirror->players, snap->playerIndex, GAME_STATE_ACCEPTED);
+    trackMirroredChanges(snap, &mirror->ships, snap->shipIndex, 0);
+}
+
+static bool reserveScratch(SnapshotBroadcaster* snap, int count) {
+    if (snap->scratchCapacity >= count) return true;
+
+    int new_capacity = snap->scratchCapacity ? snap->scratchCapacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    b2Vec2* positions = realloc(snap->positions, new_capacity * sizeof(b2Vec2));
+    if (positions) snap->positions = positions;
+    int* visible = realloc(snap->visible, new_capacity * sizeof(int));
+    if (visible) snap->visible = visible;
+    GameEntityState* spawned = realloc(snap->spawned, new_capacity * sizeof(GameEntityState));
+    if (spawned) snap->spawned = spawned;
+    GameEntityRef* despawned = realloc(snap->despawned, new_capacity * sizeof(GameEntityRef));
+    if (despawned) snap->despawned = despawned;
+    SnapshotCandidate* candidates = realloc(snap->candidates, new_capacity * sizeof(SnapshotCandidate));
+    if (candidates) snap->candidates = candidates;
+
+    if (!positions || !visible || !spawned || !despawned || !candidates) {
+        fprintf(stderr, "[Snapshot] Failed to grow scratch buffers to %d\n", new_capacity);
+        return false;
+    }
+    snap->scratchCapacity = new_capacity;
+    return true;
+}
+
+static bool reserveProjectileScratch(SnapshotBroadcaster* snap, int count) {
+    if (snap->projectileCapacity >= count) return true;
+
+    int new_capacity = snap->projectileCapacity ? snap->projectileCapacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    GameProjectileSpawn* spawns = realloc(snap->projectileSpawns, new_capacity * sizeof(GameProjectileSpawn));
+    if (spawns) snap->projectileSpawns = spawns;
+    GameProjectileHit* hits = realloc(snap->projectileHits, new_capacity * sizeof(GameProjectileHit));
+    if (hits) snap->projectileHits = hits;
+
+    if (!spawns || !hits) {
+        fprintf(stderr, "[Snapshot] Failed to grow projectile scratch to %d\n", new_capacity);
+        return false;
+    }
+    snap->projectileCapacity = new_capacity;
+    return true;
+}
+
+void writeFramePrefix(uint8_t* out, uint8_t type, size_t payload_len) {
+    out[0] = type;
+    out[1] = 0x00;
+    out[2] = (payload_len >> 8) & 0xFF;
+    out[3] = payload_len & 0xFF;
+}
+
+// Frame and send fixed-size records to one client, splitting at the 16-bit
+// payload limit so a record never straddles two frames. A snapshot header
+// goes ahead of each chunk's records when one is given.
+static void sendRecordFrames(SnapshotBroadcaster* snap, WebSocket* ws, uint8_t type,
+                             const GameSnapshotHeader* header, const void* records,
+                             size_t recordSize, int count) {
+    size_t headerSize = header ? sizeof(GameSnapshotHeader) : 0;
+    int perFrame = (int)((SNAPSHOT_MAX_FRAME_BYTES - headerSize) / recordSize);
+    const uint8_t* data = records;
+    int offset = 0;
+
+    do {
+        int chunk = count - offset;
+        if (chunk > perFrame) chunk = perFrame;
+
+        size_t payload_len = headerSize + (size_t)chunk * recordSize;
+        uint8_t* out = snap->frame;
+        writeFramePrefix(out, type, payload_len);
+
+        if (header) {
+            GameSnapshotHeader chunkHeader = *header;
+            chunkHeader.entity_count = (uint16_t)chunk;
+            memcpy(out + SNAPSHOT_FRAME_PREFIX, &chunkHeader, sizeof(chunkHeader));
+        }
+        memcpy(out + SNAPSHOT_FRAME_PREFIX + headerSize, data + (size_t)offset * recordSize,
+               (size_t)chunk * recordSize);
+
+        ws_send_binary(ws, out, SNAPSHOT_FRAME_PREFIX + payload_len);
+        offset += chunk;
+    } while (offset < count);
+}
+
+static void sendRecords(SnapshotBroadcaster* snap, WebSocket* ws, uint8_t type, uint32_t tick,
+                        const void* records, size_t recordSize, int count) {
+    GameSnapshotHeader header = {
+        .tick = tick,
+        .sequence = snap->sequence
+    };
+    sendRecordFrames(snap, ws, type, &header, records, recordSize, count);
+}
+
+// Messages outside the snapshot proper (wind) share its frame buffer and framing
+void sendFramedRecords(SnapshotBroadcaster* snap, WebSocket* ws, uint8_t type,
+                       const void* records, size_t recordSize, int count) {
+    if (!snap || !snap->frame || count <= 0 || recordSize == 0) return;
+    sendRecordFrames(snap, ws, type, NULL, records, recordSize, count);
+}
+
+void broadcastFramedRecords(SnapshotBroadcaster* snap, PlayerConnectionManager* manager, uint8_t type,
+                            const void* records, size_t recordSize, int count) {
+    for (size_t i = 0; i < manager->count; i++) {
+        PlayerConnection* conn = &manager->connections[i];
+        if (!conn->authenticated || conn->suspended) continue;
+        sendFramedRecords(snap, &conn->ws, type, records, recordSize, count);
+    }
+}
+
+// Delta frames hold bit-packed records and are flushed when the next might not fit
+typedef struct {
+    SnapshotBroadcaster* snap;
+    WebSocket* ws;
+    uint32_t tick;
+    uint16_t baselineSequence;
+    BitWriter bits;     // Records after the GameDeltaSnapshotHeader
+    size_t maxRecordBits;
+    int count;
+} DeltaFrameWriter;
+
+static void beginDeltaFrame(DeltaFrameWriter* writer) {
+    bitWriterInit(&writer->bits,
+                  writer->snap->frame + SNAPSHOT_FRAME_PREFIX + sizeof(GameDeltaSnapshotHeader),
+                  SNAPSHOT_MAX_FRAME_BYTES - sizeof(GameDeltaSnapshotHeader));
+    writer->count = 0;
+}
+
+static void flushDeltaFrame(DeltaFrameWriter* writer) {
+    if (writer->count == 0) return;
+
+    size_t payload_len = sizeof(GameDeltaSnapshotHeader) + bitWriterBytes(&writer->bits);
+    uint8_t* out = writer->snap->frame;
+    writeFramePrefix(out, GAME_MSG_ENTITY_UPDATE, payload_len);
+
+    GameDeltaSnapshotHeader header = {
+        .tick = writer->tick,
+        .sequence = writer->snap->sequence,
+        .baseline_sequence = writer->baselineSequence,
+        .entity_count = (uint16_t)writer->count
+    };
+    memcpy(out + SNAPSHOT_FRAME_PREFIX, &header, sizeof(header));
+
+    ws_send_binary(writer->ws, out, SNAPSHOT_FRAME_PREFIX + payload_len);
+    beginDeltaFrame(writer);
+}
+
+// Returns the bits written. Entities without a record keep what the client
+// shows, so a state back at the baseline still needs a bare header when the
+// client shows something newer; nothing is written when it's already shown.
+static size_t writeEntityDelta(DeltaFrameWriter* writer, const GameEntityState* baseline,
+                               const GameEntityState* shown, const GameEntityState* state,
+                               GameEntityState* applied) {
+    if (writer->bits.bitPos + writer->maxRecordBits > writer->bits.capacity * 8) {
+        flushDeltaFrame(writer);
+    }
+
+    size_t start = writer->bits.bitPos;
+    size_t bits = writeEntityDeltaBits(&writer->bits, &writer->snap->quantization, baseline, state, applied);
+    if (bits == 0 && baseline && memcmp(applied, shown, sizeof(GameEntityState)) != 0) {
+        writeEntityDeltaHeaderBits(&writer->bits, state->entity_id, state->entity_type, 0);
+        bits = writer->bits.bitPos - start;
+    }
+    if (bits > 0) writer->count++;
+    return bits;
+}
+
+// Tell a client how delta records are quantized before it gets any
+static void sendSnapshotConfig(SnapshotBroadcaster* snap, WebSocket* ws) {
+    GameSnapshotConfigMessage config = {
+        .cell_size = snap->quantization.cellSize,
+        .max_speed = snap->quantization.maxSpeed,
+        .position_bits = (uint8_t)snap->quantization.positionBits,
+        .velocity_bits = (uint8_t)snap->quantization.velocityBits,
+        .angle_bits = (uint8_t)snap->quantization.angleBits
+    };
+
+    uint8_t packet[SNAPSHOT_FRAME_PREFIX + sizeof(config)];
+    writeFramePrefix(packet, GAME_MSG_SNAPSHOT_CONFIG, sizeof(config));
+    memcpy(packet + SNAPSHOT_FRAME_PREFIX, &config, sizeof(config));
+    ws_send_binary(ws, packet, sizeof(packet));
+}
+
+// Projectile spawns and hits since the last broadcast that could show up in
+// the client's view. Flights can carry a shot in from outside, so the
+// radius is widened by the farthest a projectile can travel.
+static void sendProjectileEvents(SnapshotBroadcaster* snap, WebSocket* ws, const ProjectileSystem* projectiles,
+                                 b2Vec2 center, uint32_t tick) {
+    float radius = snap->viewRadius * SNAPSHOT_VIEW_HYSTERESIS + PROJECTILE_MAX_RANGE;
+    float radiusSq = radius * radius;
+
+    int spawnCount = 0;
+    for (int i = 0; i < projectiles->spawnCount; i++) {
+        const GameProjectileSpawn* spawn = &projectiles->spawns[i];
+        float dx = spawn->pos_x - center.x;
+        float dy = spawn->pos_y - center.y;
+        if (dx * dx + dy * dy <= radiusSq) snap->projectileSpawns[spawnCount++] = *spawn;
+    }
+
+    int hitCount = 0;
+    for (int i = 0; i < projectiles->hitCount; i++) {
+        float dx = projectiles->hitPositions[i].x - center.x;
+        float dy = projectiles->hitPositions[i].y - center.y;
+        if (dx * dx + dy * dy <= radiusSq) snap->projectileHits[hitCount++] = projectiles->hits[i];
+    }
+
+    if (spawnCount > 0) {
+        sendRecords(snap, ws, GAME_MSG_PROJECTILE_SPAWN, tick, snap->projectileSpawns,
+                    sizeof(GameProjectileSpawn), spawnCount);
+    }
+    if (hitCount > 0) {
+        sendRecords(snap, ws, GAME_MSG_PROJECTILE_HIT, tick, snap->projectileHits,
+                    sizeof(GameProjectileHit), hitCount);
+    }
+}
+
+// Own authoritative state for client-side prediction, full precision.
+// Crew have a disabled body, the deck pass keeps their state in the mirror.
+static void sendPlayerState(SnapshotBroadcaster* snap, PlayerConnection* conn, const EntityStateArrays* players,
+                            int slot, uint32_t tick) {
+    b2Vec2 pos, vel;
+    float rotation, spin;
+    if (conn->deck.shipId != 0 && entityStateSlotMatches(players, slot, conn->physics_body)) {
+        pos = (b2Vec2){players->x[slot], players->y[slot]};
+        vel = (b2Vec2){players->vx[slot], players->vy[slot]};
+        rotation = players->rot[slot];
+        spin = 0.0f;
+    } else {
+        pos = worldCellBodyPosition(conn->physics_body);
+        vel = b2Body_GetLinearVelocity(conn->physics_body);
+        rotation = b2Body_GetAngle(conn->physics_body);
+        spin = b2Body_GetAngularVelocity(conn->physics_body);
+    }
+
+    GamePlayerStateMessage msg = {0};
+    msg.header.type = GAME_MSG_PLAYER_STATE;
+    msg.header.sequence = snap->sequence;
+    msg.header.length = sizeof(msg) - sizeof(GameMessageHeader);
+    msg.player_id = conn->player_id;
+    msg.sequence = conn->last_input_seq;
+    msg.tick = tick;
+    msg.pos_x = pos.x;
+    msg.pos_y = pos.y;
+    msg.velocity_x = vel.x;
+    msg.velocity_y = vel.y;
+    msg.rotation = rotation;
+    msg.angular_velocity = spin;
+    msg.state_flags = GAME_STATE_ACCEPTED;
+
+    uint8_t packet[SNAPSHOT_FRAME_PREFIX + sizeof(msg)];
+    writeFramePrefix(packet, GAME_MSG_PLAYER_STATE, sizeof(msg));
+    memcpy(packet + SNAPSHOT_FRAME_PREFIX, &msg, sizeof(msg));
+    ws_send_binary(&conn->ws, packet, sizeof(packet));
+}
+
+// Crew can't outnumber players, departures can't outnumber last broadcast's crew
+static bool reserveCrewScratch(SnapshotBroadcaster* snap, int count) {
+    if (snap->crewCapacity >= count) return true;
+
+    int new_capacity = snap->crewCapacity ? snap->crewCapacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    GameCrewState* crew = realloc(snap->crew, new_capacity * sizeof(GameCrewState));
+    if (crew) snap->crew = crew;
+    bool* changed = realloc(snap->crewChanged, new_capacity * sizeof(bool));
+    if (changed) snap->crewChanged = changed;
+    GameCrewState* last = realloc(snap->lastCrew, new_capacity * sizeof(GameCrewState));
+    if (last) snap->lastCrew = last;
+    GameCrewState* departures = realloc(snap->crewDepartures, new_capacity * sizeof(GameCrewState));
+    if (departures) snap->crewDepartures = departures;
+    GameCrewState* records = realloc(snap->crewRecords, 2 * new_capacity * sizeof(GameCrewState));
+    if (records) snap->crewRecords = records;
+
+    if (!crew || !changed || !last || !departures || !records) {
+        fprintf(stderr, "[Snapshot] Failed to grow crew scratch to %d\n", new_capacity);
+        return false;
+    }
+    snap->crewCapacity = new_capacity;
+    return true;
+}
+
+static int compareCrew(const void* a, const void* b) {
+    const GameCrewState* ca = a;
+    const GameCrewState* cb = b;
+    if (ca->ship_id != cb->ship_id) return (ca->ship_id > cb->ship_id) - (ca->ship_id < cb->ship_id);
+    return (ca->player_id > cb->player_id) - (ca->player_id < cb->player_id);
+}
+
+static int16_t quantizeDeckOffset(float meters) {
+    long q = lrintf(meters * DECK_OFFSET_SCALE);
+    return (int16_t)(q < INT16_MIN ? INT16_MIN : (q > INT16_MAX ? INT16_MAX : q));
+}
+
+// Quantized deck state of everyone aboard a ship, diffed against the last
+// broadcast so clients only hear about crew that moved on deck
+static void collectCrew(SnapshotBroadcaster* snap, const PlayerConnectionManager* manager,
+                        const EntityStateMirror* mirror) {
+    GameCrewState* last = snap->lastCrew;
+    snap->lastCrew = snap->crew;
+    snap->crew = last;
+    snap->lastCrewCount = snap->crewCount;
+    snap->crewCount = 0;
+    snap->departureCount = 0;
+
+    const EntityStateArrays* players = &mirror->players;
+    for (size_t i = 0; i < manager->count; i++) {
+        const PlayerConnection* conn = &manager->connections[i];
+        if (conn->deck.shipId == 0 || !entityStateSlotMatches(players, (int)i, conn->physics_body) ||
+            !(players->flags[i] & ENTITY_STATE_ON_DECK)) {
+            continue;
+        }
+        snap->crew[snap->crewCount++] = (GameCrewState){
+            .player_id = conn->player_id,
+            .ship_id = conn->deck.shipId,
+            .offset_x = quantizeDeckOffset(conn->deck.x),
+            .offset_y = quantizeDeckOffset(conn->deck.y),
+            .rotation = (uint8_t)quantizeAngle(conn->deck.rotation, DECK_ROTATION_BITS)
+        };
+    }
+    qsort(snap->crew, snap->crewCount, sizeof(GameCrewState), compareCrew);
+
+    for (int i = 0; i < snap->crewCount; i++) {
+        const GameCrewState* before = bsearch(&snap->crew[i], snap->lastCrew, snap->lastCrewCount,
+                                              sizeof(GameCrewState), compareCrew);
+        snap->crewChanged[i] = !before || memcmp(before, &snap->crew[i], sizeof(GameCrewState)) != 0;
+    }
+    for (int i = 0; i < snap->lastCrewCount; i++) {
+        if (!bsearch(&snap->lastCrew[i], snap->crew, snap->crewCount, sizeof(GameCrewState), compareCrew)) {
+            snap->crewDepartures[snap->departureCount++] = snap->lastCrew[i];
+        }
+    }
+}
+
+static int compareEntityKeys(const void* a, const void* b) {
+    EntityKey ka = *(const EntityKey*)a;
+    EntityKey kb = *(const EntityKey*)b;
+    return (ka > kb) - (ka < kb);
+}
+
+static bool frameHoldsShip(const ClientSnapshotFrame* frame, uint32_t shipId) {
+    EntityKey key = ENTITY_KEY(ENTITY_TYPE_SHIP, shipId);
+    return bsearch(&key, frame->keys, frame->count, sizeof(EntityKey), compareEntityKeys) != NULL;
+}
+
+// Crew of the ships a client holds after this snapshot: changed records, or
+// the whole crew of a ship it didn't hold before. Departures go to clients
+// that held the old ship. Outside the budget, a record is 13 bytes.
+static void sendCrewStates(SnapshotBroadcaster* snap, WebSocket* ws, const ClientSnapshotFrame* known,
+                           const ClientSnapshotFrame* next, uint32_t tick) {
+    int count = 0;
+    for (int i = 0; i < snap->departureCount; i++) {
+        if (!frameHoldsShip(known, snap->crewDepartures[i].ship_id)) continue;
+        snap->crewRecords[count] = snap->crewDepartures[i];
+        snap->crewRecords[count++].ship_id = 0;
+    }
+
+    // Crew are sorted by ship, so each ship is looked up once
+    for (int i = 0; i < snap->crewCount;) {
+        uint32_t ship = snap->crew[i].ship_id;
+        int end = i;
+        while (end < snap->crewCount && snap->crew[end].ship_id == ship) end++;
+
+        if (frameHoldsShip(next, ship)) {
+            bool fresh = !frameHoldsShip(known, ship);
+            for (int c = i; c < end; c++) {
+                if (fresh || snap->crewChanged[c]) snap->crewRecords[count++] = snap->crew[c];
+            }
+        }
+        i = end;
+    }
+
+    if (count > 0) sendRecords(snap, ws, GAME_MSG_CREW_STATE, tick, snap->crewRecords, sizeof(GameCrewState), count);
+}
+
+static bool reserveClientFrame(ClientSnapshotFrame* frame, int count) {
+    if (frame->capacity >= count) return true;
+
+    int new_capacity = frame->capacity ? frame->capacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    EntityKey* keys = realloc(frame->keys, new_capacity * sizeof(EntityKey));
+    if (keys) frame->keys = keys;
+    GameEntityState* states = realloc(frame->states, new_capacity * sizeof(GameEntityState));
+    if (states) frame->states = states;
+    float* priorities = realloc(frame->priorities, new_capacity * sizeof(float));
+    if (priorities) frame->priorities = priorities;
+    uint32_t* stateTicks = realloc(frame->stateTicks, new_capacity * sizeof(uint32_t));
+    if (stateTicks) frame->stateTicks = stateTicks;
+
+    if (!keys || !states || !priorities || !stateTicks) {
+        fprintf(stderr, "[Snapshot] Failed to grow client frame to %d\n", new_capacity);
+        return false;
+    }
+    frame->capacity = new_capacity;
+    return true;
+}
+
+// Newest snapshot the client is known to hold, or NULL when it must get full records
+static const ClientSnapshotFrame* selectBaseline(const ClientSnapshotHistory* history, uint16_t nextSequence) {
+    if (!history->hasAck && !history->hasLatest) return NULL;
+    uint16_t sequence = history->hasAck ? history->ackedSequence : history->latestSequence;
+
+    // The slot about to be written can't also be the baseline
+    if ((uint16_t)(nextSequence - sequence) >= SNAPSHOT_HISTORY_SIZE) return NULL;
+
+    const ClientSnapshotFrame* frame = &history->frames[sequence % SNAPSHOT_HISTORY_SIZE];
+    return (frame->valid && frame->sequence == sequence) ? frame : NULL;
+}
+
+static int compareInts(const void* a, const void* b) {
+    int ia = *(const int*)a;
+    int ib = *(const int*)b;
+    return (ia > ib) - (ia < ib);
+}
+
+// Highest priority first
+static int compareCandidates(const void* a, const void* b) {
+    float pa = ((const SnapshotCandidate*)a)->priority;
+    float pb = ((const SnapshotCandidate*)b)->priority;
+    return (pa < pb) - (pa > pb);
+}
+
+// Priority gained per snapshot: near and fast-moving (relative to the viewer)
+// entities climb quickly, and anything left unsent keeps climbing until it wins
+static float entityPriority(const SnapshotBroadcaster* snap, const GameEntityState* state,
+                            b2Vec2 center, b2Vec2 viewerVelocity) {
+    float dx = state->pos_x - center.x;
+    float dy = state->pos_y - center.y;
+    float nearness = 1.0f - sqrtf(dx * dx + dy * dy) / (snap->viewRadius * SNAPSHOT_VIEW_HYSTERESIS);
+    if (nearness < SNAPSHOT_PRIORITY_MIN_DISTANCE) nearness = SNAPSHOT_PRIORITY_MIN_DISTANCE;
+
+    float rvx = state->velocity_x - viewerVelocity.x;
+    float rvy = state->velocity_y - viewerVelocity.y;
+    return nearness * (1.0f + sqrtf(rvx * rvx + rvy * rvy) / snap->quantization.maxSpeed);
+}
+
+// Diff the entities around a client against what it already holds, then
+// spend the client's budget on the highest-priority spawns and updates
+static void replicateToClient(SnapshotBroadcaster* snap, PlayerConnection* conn, int slot,
+                              const EntityStateMirror* mirror, const ProjectileSystem* projectiles,
+                              uint32_t tick) {
+    if (!b2Body_IsValid(conn->physics_body)) return;
+
+    if (!conn->snapshot_history) {
+        conn->snapshot_history = calloc(1, sizeof(ClientSnapshotHistory));
+        if (!conn->snapshot_history) return;
+    }
+    ClientSnapshotHistory* history = conn->snapshot_history;
+
+    // Skipped for a whole history, the client's latest frame shares a slot
+    // with the one about to be written, so it's stale like an old baseline
+    if (history->hasLatest && (uint16_t)(snap->sequence - history->latestSequence) >= SNAPSHOT_HISTORY_SIZE) {
+        conn->needs_full_snapshot = true;
+    }
+
+    // A full snapshot starts the client over with no baseline or known entities
+    if (conn->needs_full_snapshot) {
+        for (int i = 0; i < SNAPSHOT_HISTORY_SIZE; i++) history->frames[i].valid = false;
+        history->hasLatest = false;
+        history->hasAck = false;
+    }
+
+    static const ClientSnapshotFrame emptyFrame = {0};
+    const ClientSnapshotFrame* known = history->hasLatest
+        ? &history->frames[history->latestSequence % SNAPSHOT_HISTORY_SIZE] : &emptyFrame;
+    const ClientSnapshotFrame* baseline = selectBaseline(history, snap->sequence);
+
+    ClientSnapshotFrame* next = &history->frames[snap->sequence % SNAPSHOT_HISTORY_SIZE];
+    const SnapshotEntityList* current = &snap->current;
+    b2Vec2 center, viewerVelocity;
+    if (entityStateSlotMatches(&mirror->players, slot, conn->physics_body)) {
+        center = (b2Vec2){mirror->players.x[slot], mirror->players.y[slot]};
+        viewerVelocity = (b2Vec2){mirror->players.vx[slot], mirror->players.vy[slot]};
+    } else {
+        center = worldCellBodyPosition(conn->physics_body);
+        viewerVelocity = b2Body_GetLinearVelocity(conn->physics_body);
+    }
+    float enterRadiusSq = snap->viewRadius * snap->viewRadius;
+
+    // Indices ascend with keys since current is sorted
+    int visibleCount = querySpatialGrid(&snap->grid, center, snap->viewRadius * SNAPSHOT_VIEW_HYSTERESIS,
+                                        snap->visible, current->count);
+    qsort(snap->visible, visibleCount, sizeof(int), compareInts);
+
+    if (!reserveClientFrame(next, visibleCount)) return;
+    next->valid = false;
+    next->count = 0;
+
+    // Build the next frame as if nothing were sent: known entities hold what
+    // the client shows now, which it keeps without a record, and spawns are
+    // only candidates
+    int candidateCount = 0, updateCount = 0, despawnCount = 0;
+    int k = 0, b = 0;
+    for (int v = 0; v < visibleCount; v++) {
+        const SnapshotEntity* entity = &current->entities[snap->visible[v]];
+
+        while (k < known->count && known->keys[k] < entity->key) {
+            EntityKey gone = known->keys[k++];
+            snap->despawned[despawnCount++] = (GameEntityRef){ENTITY_KEY_ID(gone), ENTITY_KEY_TYPE(gone)};
+        }
+
+        int frameSlot = next->count;
+        float gain = entityPriority(snap, &entity->state, center, viewerVelocity);
+        SnapshotCandidate* candidate = &snap->candidates[candidateCount];
+        candidate->slot = frameSlot;
+        candidate->entity = snap->visible[v];
+        candidate->base = -1;
+        candidate->spawn = false;
+
+        if (k < known->count && known->keys[k] == entity->key) {
+            next->states[frameSlot] = known->states[k];
+            next->stateTicks[frameSlot] = known->stateTicks[k];
+            k++;
+            // Hasn't moved since what the client shows, so there's nothing to send
+            if (entity->changedTick <= next->stateTicks[frameSlot]) {
+                next->priorities[frameSlot] = 0.0f;
+                next->keys[next->count++] = entity->key;
+                continue;
+            }
+            while (baseline && b < baseline->count && baseline->keys[b] < entity->key) b++;
+            if (baseline && b < baseline->count && baseline->keys[b] == entity->key) candidate->base = b;
+            next->priorities[frameSlot] = known->priorities[k - 1] + gain;
+            candidate->priority = next->priorities[frameSlot];
+            updateCount++;
+        } else {
+            // Only spawn inside the view radius, the hysteresis band is for leaving
+            b2Vec2 p = snap->positions[snap->visible[v]];
+            float dx = p.x - center.x;
+            float dy = p.y - center.y;
+            if (dx * dx + dy * dy > enterRadiusSq) continue;
+            next->states[frameSlot] = entity->state;
+            next->stateTicks[frameSlot] = entity->changedTick;
+            next->priorities[frameSlot] = 0.0f;
+            candidate->priority = SNAPSHOT_SPAWN_PRIORITY + gain;
+            candidate->spawn = true;
+        }
+        candidateCount++;
+        next->keys[next->count++] = entity->key;
+    }
+    while (k < known->count) {
+        EntityKey gone = known->keys[k++];
+        snap->despawned[despawnCount++] = (GameEntityRef){ENTITY_KEY_ID(gone), ENTITY_KEY_TYPE(gone)};
+    }
+
+    DeltaFrameWriter writer = {
+        .snap = snap,
+        .ws = &conn->ws,
+        .tick = tick,
+        .baselineSequence = baseline ? baseline->sequence : snap->sequence,
+        .maxRecordBits = maxEntityDeltaBits(&snap->quantization)
+    };
+    beginDeltaFrame(&writer);
+
+    // Despawns are tiny and always go out, the rest is spent by priority.
+    // Frame headers aren't counted, only records.
+    long budgetBits = ((long)snap->clientBudget - (long)despawnCount * (long)sizeof(GameEntityRef)) * 8;
+    const long spawnBits = (long)sizeof(GameEntityState) * 8;
+    int spawnCount = 0, deferredSpawns = 0;
+
+    // Spawns outrank updates, but while updates are waiting they only get a
+    // share of the budget, so a crowd coming into view can't starve what the
+    // client already shows
+    long spawnLimitBits = budgetBits - (long)updateCount * (long)writer.maxRecordBits;
+    long spawnShareBits = (long)(budgetBits * SNAPSHOT_SPAWN_BUDGET_SHARE);
+    if (spawnLimitBits < spawnShareBits) spawnLimitBits = spawnShareBits;
+
+    qsort(snap->candidates, candidateCount, sizeof(SnapshotCandidate), compareCandidates);
+    for (int c = 0; c < candidateCount; c++) {
+        const SnapshotCandidate* candidate = &snap->candidates[c];
+        const SnapshotEntity* entity = &current->entities[candidate->entity];
+        const GameEntityState* state = &entity->state;
+
+        if (candidate->spawn) {
+            if (spawnBits > budgetBits || spawnBits > spawnLimitBits) {
+                // Type NONE never replicates, so key 0 marks a spawn left for later
+                next->keys[candidate->slot] = 0;
+                deferredSpawns++;
+                continue;
+            }
+            snap->spawned[spawnCount++] = *state;
+            budgetBits -= spawnBits;
+            spawnLimitBits -= spawnBits;
+        } else {
+            // Left out, the entity keeps the state already in next
+            if ((long)writer.maxRecordBits > budgetBits) continue;
+            const GameEntityState* base = candidate->base >= 0 ? &baseline->states[candidate->base] : NULL;
+            GameEntityState shown = next->states[candidate->slot];
+            budgetBits -= (long)writeEntityDelta(&writer, base, &shown, state, &next->states[candidate->slot]);
+            next->stateTicks[candidate->slot] = entity->changedTick;
+            next->priorities[candidate->slot] = 0.0f;
+        }
+    }
+
+    if (deferredSpawns > 0) {
+        int kept = 0;
+        for (int i = 0; i < next->count; i++) {
+            if (next->keys[i] == 0) continue;
+            next->keys[kept] = next->keys[i];
+            next->states[kept] = next->states[i];
+            next->priorities[kept] = next->priorities[i];
+            next->stateTicks[kept] = next->stateTicks[i];
+            kept++;
+        }
+        next->count = kept;
+    }
+
+    // Deltas are encoded straight into the frame buffer, so flush them first
+    flushDeltaFrame(&writer);
+    if (despawnCount > 0) {
+        sendRecords(snap, &conn->ws, GAME_MSG_DESPAWN, tick, snap->despawned, sizeof(GameEntityRef), despawnCount);
+    }
+    if (conn->needs_full_snapshot) {
+        sendSnapshotConfig(snap, &conn->ws);
+        // Nothing was known before, so every entity sent is in the spawn list
+        sendRecords(snap, &conn->ws, GAME_MSG_WORLD_STATE, tick, snap->spawned, sizeof(GameEntityState), spawnCount);
+        conn->needs_full_snapshot = false;
+    } else if (spawnCount > 0) {
+        sendRecords(snap, &conn->ws, GAME_MSG_SPAWN, tick, snap->spawned, sizeof(GameEntityState), spawnCount);
+    }
+
+    // Outside the budget - events are small and can't be deferred
+    if (projectiles) sendProjectileEvents(snap, &conn->ws, projectiles, center, tick);
+
+    if (snap->crewCapacity > 0) sendCrewStates(snap, &conn->ws, known, next, tick);
+
+    // Outside the budget - tiny, and reconciliation stalls without it
+    sendPlayerState(snap, conn, &mirror->players, slot, tick);
+
+    next->sequence = snap->sequence;
+    next->tick = tick;
+    next->valid = true;
+    history->latestSequence = snap->sequence;
+    history->hasLatest = true;
+}
+
+void acknowledgeClientSnapshot(PlayerConnection* conn, uint16_t sequence) {
+    ClientSnapshotHistory* history = conn ? conn->snapshot_history : NULL;
+    if (!history || !history->hasLatest) return;
+
+    // Ignore acks for snapshots never sent or older than the current baseline
+    if ((int16_t)(sequence - history->latestSequence) > 0) return;
+    if (history->hasAck && (int16_t)(sequence - history->ackedSequence) <= 0) return;
+
+    history->ackedSequence = sequence;
+    history->hasAck = true;
+}
+
+void freeClientSnapshotHistory(ClientSnapshotHistory* history) {
+    if (!history) return;
+    for (int i = 0; i < SNAPSHOT_HISTORY_SIZE; i++) {
+        free(history->frames[i].keys);
+        free(history->frames[i].states);
+        free(history->frames[i].priorities);
+        free(history->frames[i].stateTicks);
+    }
+    free(history);
+}
+
+bool initSnapshotBroadcaster(SnapshotBroadcaster* snap, float rateHz, float viewRadius,
+                             float clientBandwidth, const QuantizationConfig* quantization) {
+    memset(snap, 0, sizeof(SnapshotBroadcaster));
+    if (!(rateHz > 0.0f)) {
+        fprintf(stderr, "[Snapshot] Invalid rate %.2f Hz, using %.2f Hz\n", rateHz, SNAPSHOT_DEFAULT_RATE_HZ);
+        rateHz = SNAPSHOT_DEFAULT_RATE_HZ;
+    }
+    if (!(viewRadius > 0.0f)) {
+        fprintf(stderr, "[Snapshot] Invalid view radius %.2f, using %.2f\n", viewRadius, SNAPSHOT_DEFAULT_VIEW_RADIUS);
+        viewRadius = SNAPSHOT_DEFAULT_VIEW_RADIUS;
+    }
+    if (!(clientBandwidth > 0.0f)) {
+        fprintf(stderr, "[Snapshot] Invalid client bandwidth %.0f B/s, using %.0f B/s\n",
+                clientBandwidth, SNAPSHOT_DEFAULT_CLIENT_BANDWIDTH);
+        clientBandwidth = SNAPSHOT_DEFAULT_CLIENT_BANDWIDTH;
+    }
+    snap->rateHz = rateHz;
+    snap->interval = 1.0 / rateHz;
+    snap->viewRadius = viewRadius;
+
+    // The budget never drops below one full record, so something always moves
+    snap->clientBudget = (int)(clientBandwidth / rateHz);
+    if (snap->clientBudget < SNAPSHOT_MIN_CLIENT_BUDGET) snap->clientBudget = SNAPSHOT_MIN_CLIENT_BUDGET;
+
+    snap->quantization = quantization ? *quantization : defaultQuantizationConfig();
+    if (!validateQuantizationConfig(&snap->quantization)) {
+        fprintf(stderr, "[Snapshot] Invalid quantization settings replaced with defaults\n");
+    }
+
+    snap->frame = malloc(SNAPSHOT_FRAME_PREFIX + SNAPSHOT_MAX_FRAME_BYTES);
+    if (!snap->frame) return false;
+
+    // Cells as wide as the despawn radius keep each view query to a 3x3 block
+    return initSpatialGrid(&snap->grid, viewRadius * SNAPSHOT_VIEW_HYSTERESIS, SPATIAL_GRID_DEFAULT_BUCKETS) &&
+           reserveEntityList(&snap->current, 64) &&
+           reserveScratch(snap, 64);
+}
+
+void cleanupSnapshotBroadcaster(SnapshotBroadcaster* snap) {
+    if (!snap) return;
+    cleanupSpatialGrid(&snap->grid);
+    free(snap->current.entities);
+    free(snap->playerIndex);
+    free(snap->shipIndex);
+    free(snap->pending);
+    free(snap->positions);
+    free(snap->visible);
+    free(snap->spawned);
+    free(snap->despawned);
+    free(snap->candidates);
+    free(snap->projectileSpawns);
+    free(snap->projectileHits);
+    free(snap->crew);
+    free(snap->crewChanged);
+    free(snap->lastCrew);
+    free(snap->crewDepartures);
+    free(snap->crewRecords);
+    free(snap->frame);
+    memset(snap, 0, sizeof(SnapshotBroadcaster));
+}
+
+bool snapshotBroadcastDue(const SnapshotBroadcaster* snap, double now) {
+    return now - snap->lastBroadcast >= snap->interval;
+}
+
+// Runs once per broadcast tick: one set of frames per client instead of one per input
+void broadcastWorldSnapshot(SnapshotBroadcaster* snap, PlayerConnectionManager* manager,
+                            const EntityStateMirror* mirror, const ProjectileSystem* projectiles,
+                            uint32_t tick, double now) {
+    if (!snap || !manager || !mirror) return;
+    snap->lastBroadcast = now;
+
+    bool membershipChanged = !snap->collected || mirror->membershipTick != snap->membershipTick;
+    if (membershipChanged) collectEntities(snap, mirror);
+    snap->sequence++;
+
+    // Despawn lists can hold everything a client knew
+    int maxKnown = 0;
+    for (size_t i = 0; i < manager->count; i++) {
+        const ClientSnapshotHistory* history = manager->connections[i].snapshot_history;
+        if (!history || !history->hasLatest) continue;
+        int known = history->frames[history->latestSequence % SNAPSHOT_HISTORY_SIZE].count;
+        if (known > maxKnown) maxKnown = known;
+    }
+    int scratch = snap->current.count > maxKnown ? snap->current.count : maxKnown;
+    if (!reserveScratch(snap, scratch)) return;
+    if (projectiles) {
+        int events = projectiles->spawnCount > projectiles->hitCount ? projectiles->spawnCount : projectiles->hitCount;
+        if (!reserveProjectileScratch(snap, events)) projectiles = NULL;
+    }
+    int crewSlots = (int)manager->count > snap->crewCount ? (int)manager->count : snap->crewCount;
+    if (reserveCrewScratch(snap, crewSlots)) collectCrew(snap, manager, mirror);
+
+    // Positions persist between broadcasts, only entities that moved are touched
+    bool rebuild = membershipChanged;
+    for (int p = 0; p < snap->pendingCount; p++) {
+        SnapshotEntity* entity = &snap->current.entities[snap->pending[p]];
+        entity->pending = false;
+        b2Vec2 pos = {entity->state.pos_x, entity->state.pos_y};
+        snap->positions[snap->pending[p]] = pos;
+        if (!rebuild && !moveSpatialGridItem(&snap->grid, snap->pending[p], pos)) rebuild = true;
+    }
+    snap->pendingCount = 0;
+    if (membershipChanged) {
+        for (int i = 0; i < snap->current.count; i++) {
+            snap->positions[i] = (b2Vec2){snap->current.entities[i].state.pos_x, snap->current.entities[i].state.pos_y};
+        }
+    }
+    if (rebuild) rebuildSpatialGrid(&snap->grid, snap->positions, snap->current.count);
+
+    for (size_t i = 0; i < manager->count; i++) {
+        PlayerConnection* conn = &manager->connections[i];
+        // Suspended players stay in the world but have no socket to send to
+        if (!conn->authenticated || conn->suspended) continue;
+        replicateToClient(snap, conn, (int)i, mirror, projectiles, tick);
+    }
+}
@@ -0,0 +1,142 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../core/game_state.h"
+#include "../world/spatial_grid.h"
+#include "../physics/projectile.h"
+#include "bitstream.h"
+#include "game_protocol.h"
+#include "player_connection.h"
+
+// Snapshot timing - broadcast rate is independent of the physics rate
+#define SNAPSHOT_DEFAULT_RATE_HZ 20.0f
+#define SNAPSHOT_MAX_FRAME_BYTES 0xFFFF    // 16-bit payload length in the frame prefix
+#define SNAPSHOT_FRAME_PREFIX 4            // [type][flags][length hi][length lo]
+
+// Area of interest - entities spawn inside the view radius and despawn
+// once past it by the hysteresis factor, so border entities don't flicker
+#define SNAPSHOT_DEFAULT_VIEW_RADIUS 150.0f  // meters
+#define SNAPSHOT_VIEW_HYSTERESIS 1.1f
+
+// Snapshots remembered per client - an ack older than this forces full records
+#define SNAPSHOT_HISTORY_SIZE 32             // 1.6s at 20Hz
+
+// Per-client bandwidth - entities that don't fit a client's budget keep
+// accumulating priority and go out in a later snapshot
+#define SNAPSHOT_DEFAULT_CLIENT_BANDWIDTH 65536.0f  // bytes per second
+#define SNAPSHOT_MIN_CLIENT_BUDGET 512            // bytes per snapshot
+#define SNAPSHOT_PRIORITY_MIN_DISTANCE 0.1f       // Far edge of the view still gains priority
+#define SNAPSHOT_SPAWN_PRIORITY 1.0e6f            // Entities entering view go before updates
+#define SNAPSHOT_SPAWN_BUDGET_SHARE 0.5f          // Most of the budget spawns take while updates wait
+
+typedef struct {
+    EntityKey key;
+    GameEntityState state;
+    int slot;                      // Index into the mirror arrays of its kind
+    uint32_t changedTick;          // Last tick the state changed
+    bool pending;                  // Changed since the last broadcast
+} SnapshotEntity;
+
+typedef struct {
+    SnapshotEntity* entities;
+    int count;
+    int capacity;
+} SnapshotEntityList;
+
+// What a client holds after applying one snapshot, sorted by key.
+// The newest frame is also the client's set of spawned entities.
+typedef struct {
+    uint16_t sequence;
+    uint32_t tick;
+    bool valid;
+    EntityKey* keys;
+    GameEntityState* states;
+    float* priorities;             // Accumulated send priority, carried from the newest frame
+    uint32_t* stateTicks;          // Server tick each held state was current at
+    int count;
+    int capacity;
+} ClientSnapshotFrame;
+
+struct ClientSnapshotHistory {
+    ClientSnapshotFrame frames[SNAPSHOT_HISTORY_SIZE];  // Indexed by sequence
+    uint16_t latestSequence;
+    bool hasLatest;
+    uint16_t ackedSequence;
+    bool hasAck;                   // Clients that never ack are treated as acking everything
+};
+typedef struct ClientSnapshotHistory ClientSnapshotHistory;
+
+// An entity competing for a client's budget this snapshot
+typedef struct {
+    float priority;
+    int slot;                      // Index into the client's next frame
+    int entity;                    // Index into current
+    int base;                      // Index into the baseline frame, -1 for none
+    bool spawn;                    // Entering view, sent as a full record
+} SnapshotCandidate;
+
+typedef struct {
+    float rateHz;
+    double interval;
+    double lastBroadcast;
+    uint16_t sequence;
+    float viewRadius;
+    int clientBudget;              // Bytes per client per snapshot
+    QuantizationConfig quantization;  // Delta record encoding
+    SnapshotEntityList current;    // Entities collected this broadcast, sorted by key
+    uint32_t membershipTick;       // Mirror membership current was collected at
+    bool collected;
+    int* playerIndex;              // Mirror slot -> index into current, -1 when inactive
+    int* shipIndex;
+    int indexCapacity;
+    int* pending;                  // Indices into current that moved since the last broadcast
+    int pendingCount;
+    int pendingCapacity;
+    SpatialGrid grid;              // Positions of current entities
+    b2Vec2* positions;             // Grid input, parallel to current
+    int* visible;                  // Per-client scratch: indices into current
+    GameEntityState* spawned;      // Per-client scratch: entities entering view
+    GameEntityRef* despawned;      // Per-client scratch: entities leaving view
+    SnapshotCandidate* candidates; // Per-client scratch: entities competing for the budget
+    int scratchCapacity;
+    GameProjectileSpawn* projectileSpawns;  // Per-client scratch: projectile events near the client
+    GameProjectileHit* projectileHits;
+    int projectileCapacity;
+    GameCrewState* crew;           // Crew on deck this broadcast, sorted by ship then player
+    bool* crewChanged;             // Parallel to crew: quantized state differs from the last broadcast
+    int crewCount;
+    GameCrewState* lastCrew;       // The previous broadcast's crew, swapped with crew each broadcast
+    int lastCrewCount;
+    GameCrewState* crewDepartures; // Left their deck since the last broadcast, ship_id is the old ship
+    int departureCount;
+    GameCrewState* crewRecords;    // Per-client scratch: crew records for ships the client holds
+    int crewCapacity;
+    uint8_t* frame;                // Reusable frame buffer, SNAPSHOT_MAX_FRAME_BYTES payload
+} SnapshotBroadcaster;
+
+bool initSnapshotBroadcaster(SnapshotBroadcaster* snap, float rateHz, float viewRadius,
+                             float clientBandwidth, const QuantizationConfig* quantization);
+void cleanupSnapshotBroadcaster(SnapshotBroadcaster* snap);
+bool snapshotBroadcastDue(const SnapshotBroadcaster* snap, double now);
+// Called after every mirror sync so moves between broadcasts aren't lost.
+// Only the mirror's dirty lists are walked.
+void trackSnapshotChanges(SnapshotBroadcaster* snap, const EntityStateMirror* mirror);
+void broadcastWorldSnapshot(SnapshotBroadcaster* snap, PlayerConnectionManager* manager,
+                            const EntityStateMirror* mirror, const ProjectileSystem* projectiles,
+                            uint32_t tick, double now);
+
+// Every game frame goes out through these, in the broadcaster's frame buffer
+void writeFramePrefix(uint8_t* out, uint8_t type, size_t payload_len);
+void sendFramedRecords(SnapshotBroadcaster* snap, WebSocket* ws, uint8_t type,
+                       const void* records, size_t recordSize, int count);
+void broadcastFramedRecords(SnapshotBroadcaster* snap, PlayerConnectionManager* manager, uint8_t type,
+                            const void* records, size_t recordSize, int count);
+
+// Per-client baseline tracking
+void acknowledgeClientSnapshot(PlayerConnection* conn, uint16_t sequence);
+void freeClientSnapshotHistory(ClientSnapshotHistory* history);
+
+#endif // SNAPSHOT_H
@@ -177,6 +177,30 @@ WebSocket* ws_accept_connection(void) {
         ws->token_received = false;
     }
 
+    // A reconnecting client may also offer a session resume token
+    char* resume_start = strstr(request_buffer, WS_RESUME_PARAM);
+    if (resume_start) {
+        resume_start += strlen(WS_RESUME_PARAM);
+        char* resume_end = strpbrk(resume_start, " \r\n&");
+        if (resume_end && (size_t)(resume_end - resume_start) <= WS_RESUME_TOKEN_MAX) {
+            size_t resume_len = resume_end - resume_start;
+            memcpy(ws->resume_token, resume_start, resume_len);
+            ws->resume_token[resume_len] = '\0';
+            ws->resume_received = true;
+        }
+    }
+
+    // Servers hosting several rooms route by name, none means the default
+    char* room_start = strstr(request_buffer, WS_ROOM_PARAM);
+    if (room_start) {
+        room_start += strlen(WS_ROOM_PARAM);
+        char* room_end = strpbrk(room_start, " \r\n&");
+        if (room_end && (size_t)(room_end - room_start) <= WS_ROOM_NAME_MAX) {
+            memcpy(ws->room, room_start, room_end - room_start);
+            ws->room[room_end - room_start] = '\0';
+        }
+    }
+
     // Now handle WebSocket handshake
     char* key_start = strstr(request_buffer, "Sec-WebSocket-Key: ");
     if (!key_start) {
@@ -225,6 +249,17 @@ const char* ws_get_token(const WebSocket* ws) {
     return ws->token;
 }
 
+const char* ws_get_resume_token(const WebSocket* ws) {
+    if (!ws || !ws->resume_received) {
+        return NULL;
+    }
+    return ws->resume_token;
+}
+
+const char* ws_get_room(const WebSocket* ws) {
+    return ws ? ws->room : NULL;
+}
+
 void ws_stop_server(void) {
     if (ws_server.running) {
         close(ws_server.listen_fd);
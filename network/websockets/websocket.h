@@ -16,6 +16,10 @@
 // Add URL constants
 #define WS_CONNECT_PATH "/game/connect"
 #define WS_TOKEN_PARAM "token="
+#define WS_RESUME_PARAM "resume="
+#define WS_RESUME_TOKEN_MAX 64
+#define WS_ROOM_PARAM "room="
+#define WS_ROOM_NAME_MAX 31
 #define WS_URL_MAX_LEN 512
 
 #define WS_KEY_LENGTH 24
@@ -54,6 +58,9 @@ struct WebSocket {
     bool valid;          // Add validity check
     char token[1024];        // Add token storage to WebSocket struct
     bool token_received;     // Flag to indicate if token was received
+    char resume_token[WS_RESUME_TOKEN_MAX + 1];  // Session resume token (hex) from the URL
+    bool resume_received;
+    char room[WS_ROOM_NAME_MAX + 1];  // Room named in the URL, empty for the default room
     WebSocketMessageHandler handler;  // Add handler field
     void* handler_context;           // Add context field
 };
@@ -63,6 +70,8 @@ bool ws_connect(WebSocket* ws);
 void ws_disconnect(WebSocket* ws);
 bool ws_send_binary(WebSocket* ws, const uint8_t* data, size_t len);
 const char* ws_get_token(const WebSocket* ws);  // Add this function declaration
+const char* ws_get_resume_token(const WebSocket* ws);
+const char* ws_get_room(const WebSocket* ws);
 bool ws_send_ping(WebSocket* ws);
 bool ws_send_pong(WebSocket* ws);
 void ws_handle_ping(WebSocket* ws);
@@ -0,0 +1,90 @@
+#include "collision_layers.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char* collisionLayerNames[COLLISION_LAYER_COUNT] = {"player", "ship", "projectile", "sensor"};
+
+// Set at startup, read-only once rooms run
+static uint32_t collisionMatrix;
+static bool collisionMatrixReady;
+
+static uint32_t pairBit(CollisionLayer a, CollisionLayer b) {
+    if (a > b) {
+        CollisionLayer swap = a;
+        a = b;
+        b = swap;
+    }
+    return 1u << (a * COLLISION_LAYER_COUNT + b);
+}
+
+static int findLayer(const char* name, size_t length) {
+    for (int i = 0; i < COLLISION_LAYER_COUNT; i++) {
+        if (strlen(collisionLayerNames[i]) == length && strncmp(collisionLayerNames[i], name, length) == 0) return i;
+    }
+    return -1;
+}
+
+bool configureCollisionLayers(const char* pairs) {
+    if (!pairs) pairs = COLLISION_DEFAULT_PAIRS;
+    uint32_t matrix = 0;
+
+    if (strcmp(pairs, "all") == 0) {
+        for (int a = 0; a < COLLISION_LAYER_COUNT; a++) {
+            for (int b = a; b < COLLISION_LAYER_COUNT; b++) matrix |= pairBit(a, b);
+        }
+    } else {
+        const char* cursor = pairs;
+        while (*cursor) {
+            size_t length = strcspn(cursor, ",");
+            const char* dash = memchr(cursor, '-', length);
+            int a = dash ? findLayer(cursor, (size_t)(dash - cursor)) : -1;
+            int b = dash ? findLayer(dash + 1, length - (size_t)(dash - cursor) - 1) : -1;
+            if (a < 0 || b < 0) {
+                fprintf(stderr, "[Collision] Bad layer pair '%.*s' in '%s'\n", (int)length, cursor, pairs);
+                return false;
+            }
+            matrix |= pairBit(a, b);
+            cursor += length;
+            if (*cursor == ',') cursor++;
+        }
+    }
+
+    setCollisionMatrix(matrix);
+    return true;
+}
+
+uint32_t getCollisionMatrix(void) {
+    if (!collisionMatrixReady) configureCollisionLayers(COLLISION_DEFAULT_PAIRS);
+    return collisionMatrix;
+}
+
+void setCollisionMatrix(uint32_t matrix) {
+    collisionMatrix = matrix;
+    collisionMatrixReady = true;
+}
+
+bool collisionLayersCollide(CollisionLayer a, CollisionLayer b) {
+    return (getCollisionMatrix() & pairBit(a, b)) != 0;
+}
+
+const char* collisionLayerName(CollisionLayer layer) {
+    return layer >= 0 && layer < COLLISION_LAYER_COUNT ? collisionLayerNames[layer] : "unknown";
+}
+
+b2Filter collisionFilterFor(CollisionLayer layer) {
+    b2Filter filter = b2DefaultShapeDef().filter;
+    filter.categoryBits = COLLISION_LAYER_BIT(layer);
+    filter.maskBits = 0;
+    for (int other = 0; other < COLLISION_LAYER_COUNT; other++) {
+        if (collisionLayersCollide(layer, other)) filter.maskBits |= COLLISION_LAYER_BIT(other);
+    }
+    return filter;
+}
+
+b2QueryFilter collisionQueryFilterFor(CollisionLayer layer) {
+    b2Filter filter = collisionFilterFor(layer);
+    b2QueryFilter query = b2DefaultQueryFilter();
+    query.categoryBits = filter.categoryBits;
+    query.maskBits = filter.maskBits;
+    return query;
+}
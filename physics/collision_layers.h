@@ -0,0 +1,42 @@
+#ifndef COLLISION_LAYERS_H
+#define COLLISION_LAYERS_H
+
+#include <box2d/box2d.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Which kinds of entity collide with which, as Box2D category and mask bits.
+// Every shape gets its layer's filter when it is created, so pairs the
+// matrix rules out are dropped by the broadphase before a contact exists.
+// The matrix is process-wide: set it once at startup, before any room
+// creates bodies. Journals record it so replays build the same filters.
+typedef enum {
+    COLLISION_LAYER_PLAYER = 0,
+    COLLISION_LAYER_SHIP,
+    COLLISION_LAYER_PROJECTILE,
+    COLLISION_LAYER_SENSOR,
+    COLLISION_LAYER_COUNT
+} CollisionLayer;
+
+#define COLLISION_LAYER_BIT(layer) (1u << (layer))
+
+// Pairs that collide, symmetric. Players pass through each other; crowds
+// otherwise dominate the pair count.
+#define COLLISION_DEFAULT_PAIRS "player-ship,ship-ship,projectile-ship,sensor-player,sensor-ship"
+
+// Comma-separated a-b pairs, or "all". False on a malformed list, which
+// leaves the matrix unchanged.
+bool configureCollisionLayers(const char* pairs);
+
+// Pair (a, b) with a <= b is bit a * COLLISION_LAYER_COUNT + b
+uint32_t getCollisionMatrix(void);
+void setCollisionMatrix(uint32_t matrix);
+
+bool collisionLayersCollide(CollisionLayer a, CollisionLayer b);
+const char* collisionLayerName(CollisionLayer layer);
+
+// For shape defs, and for queries that should see what the layer hits
+b2Filter collisionFilterFor(CollisionLayer layer);
+b2QueryFilter collisionQueryFilterFor(CollisionLayer layer);
+
+#endif // COLLISION_LAYERS_H
@@ -0,0 +1,91 @@
+#include "collision_pairs.h"
+#include "../core/game_state.h"
+#include <string.h>
+
+typedef struct {
+    CollisionPairCounters* counters;
+    b2BodyId body;
+    uint64_t key;                        // b2StoreBodyId of body
+    b2Filter filter;                     // Of the shape being walked
+    int layer;
+} CollisionPairSample;
+
+static int layerOfFilter(b2Filter filter) {
+    for (int i = 0; i < COLLISION_LAYER_COUNT; i++) {
+        if (filter.categoryBits & COLLISION_LAYER_BIT(i)) return i;
+    }
+    return -1;
+}
+
+// Box2D's own pair test - group index first, then both masks
+static bool filtersCollide(b2Filter a, b2Filter b) {
+    if (a.groupIndex == b.groupIndex && a.groupIndex != 0) return a.groupIndex > 0;
+    return (a.maskBits & b.categoryBits) != 0 && (a.categoryBits & b.maskBits) != 0;
+}
+
+static bool countOverlappingShape(b2ShapeId shapeId, void* context) {
+    CollisionPairSample* sample = context;
+    b2BodyId other = b2Shape_GetBody(shapeId);
+
+    // Only bodies in the same cell share a broadphase
+    if (other.world0 != sample->body.world0 || B2_ID_EQUALS(other, sample->body)) return true;
+    // Tagged bodies are walked too, so count their pairs from the lower id.
+    // Ghost proxies are untagged and only ever the other side.
+    if (b2Body_GetUserData(other) && b2StoreBodyId(other) < sample->key) return true;
+
+    b2Filter filter = b2Shape_GetFilter(shapeId);
+    int layer = layerOfFilter(filter);
+    if (layer < 0) return true;
+
+    int a = sample->layer < layer ? sample->layer : layer;
+    int b = sample->layer < layer ? layer : sample->layer;
+    if (filtersCollide(sample->filter, filter)) {
+        sample->counters->kept[a][b]++;
+    } else {
+        sample->counters->pruned[a][b]++;
+    }
+    return true;
+}
+
+static void sampleArrays(CollisionPairCounters* counters, const WorldCells* cells, const EntityStateArrays* arrays) {
+    b2QueryFilter everything = b2DefaultQueryFilter();
+    everything.categoryBits = everything.maskBits;
+
+    for (int slot = 0; slot < arrays->count; slot++) {
+        if (!(arrays->flags[slot] & ENTITY_STATE_ACTIVE)) continue;
+        b2BodyId body = arrays->bodies[slot];
+        if (!b2Body_IsValid(body) || !b2Body_IsEnabled(body)) continue;
+
+        CollisionPairSample sample = {.counters = counters, .body = body, .key = b2StoreBodyId(body)};
+        b2Vec2 origin = worldCellOrigin(body);
+        b2ShapeId shapes[WORLD_CELL_MAX_SHAPES];
+        int shapeCount = b2Body_GetShapes(body, shapes, WORLD_CELL_MAX_SHAPES);
+        for (int i = 0; i < shapeCount; i++) {
+            sample.filter = b2Shape_GetFilter(shapes[i]);
+            sample.layer = layerOfFilter(sample.filter);
+            if (sample.layer < 0) continue;
+
+            b2AABB local = b2Shape_GetAABB(shapes[i]);
+            b2AABB box = {
+                {local.lowerBound.x + origin.x, local.lowerBound.y + origin.y},
+                {local.upperBound.x + origin.x, local.upperBound.y + origin.y}
+            };
+            overlapWorldCellsAABB(cells, box, everything, countOverlappingShape, &sample);
+        }
+    }
+}
+
+void sampleCollisionPairs(CollisionPairCounters* counters, const WorldCells* cells,
+                          const EntityStateMirror* mirror, uint32_t tick) {
+    counters->tick = tick;
+    counters->pairs = 0;
+    for (int i = 0; i < cells->cellCount; i++) {
+        counters->pairs += b2World_GetCounters(cells->worldIds[i]).contactCount;
+    }
+    if (counters->pairs > counters->peakPairs) counters->peakPairs = counters->pairs;
+
+    memset(counters->kept, 0, sizeof(counters->kept));
+    memset(counters->pruned, 0, sizeof(counters->pruned));
+    sampleArrays(counters, cells, &mirror->players);
+    sampleArrays(counters, cells, &mirror->ships);
+}
@@ -0,0 +1,29 @@
+#ifndef COLLISION_PAIRS_H
+#define COLLISION_PAIRS_H
+
+#include <stdint.h>
+
+#include "collision_layers.h"
+#include "../world/world_cells.h"
+
+struct EntityStateMirror;
+
+// How many pairs the broadphase holds, and what the layer matrix saves.
+// Sampling walks every mirrored body's shapes against its own cell, so it
+// runs once a second rather than every tick.
+#define COLLISION_PAIR_SAMPLE_TICKS 60
+
+typedef struct {
+    uint32_t tick;                        // Step of the last sample
+    int pairs;                            // Broadphase pairs Box2D holds, summed over cells
+    int peakPairs;
+    int kept[COLLISION_LAYER_COUNT][COLLISION_LAYER_COUNT];    // Overlapping shape pairs by layer, a <= b
+    int pruned[COLLISION_LAYER_COUNT][COLLISION_LAYER_COUNT];  // Of those, the ones the matrix filters out
+} CollisionPairCounters;
+
+// Every COLLISION_PAIR_SAMPLE_TICKS, after the step: reads Box2D's pair
+// count and walks the mirror's bodies to break overlaps down by layer
+void sampleCollisionPairs(CollisionPairCounters* counters, const WorldCells* cells,
+                          const struct EntityStateMirror* mirror, uint32_t tick);
+
+#endif // COLLISION_PAIRS_H
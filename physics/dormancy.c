@@ -0,0 +1,221 @@
+#include "dormancy.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+bool initDormancySystem(DormancySystem* dormancy, float idleSeconds, float tickSeconds) {
+    memset(dormancy, 0, sizeof(DormancySystem));
+    if (!(idleSeconds > 0.0f)) {
+        fprintf(stderr, "[Dormancy] Invalid idle threshold %.1fs, using %.1fs\n",
+                idleSeconds, DORMANCY_DEFAULT_IDLE_SECONDS);
+        idleSeconds = DORMANCY_DEFAULT_IDLE_SECONDS;
+    }
+    dormancy->idleTicks = (uint32_t)(idleSeconds / tickSeconds + 0.5f);
+    if (dormancy->idleTicks == 0) dormancy->idleTicks = 1;
+
+    return initSpatialGrid(&dormancy->grid, DORMANCY_CELL_SIZE, DORMANCY_BUCKETS);
+}
+
+void cleanupDormancySystem(DormancySystem* dormancy) {
+    if (!dormancy) return;
+    free(dormancy->idleSince);
+    free(dormancy->dormant);
+    free(dormancy->queue);
+    free(dormancy->dormantSlots);
+    free(dormancy->dormantPositions);
+    free(dormancy->nearby);
+    cleanupSpatialGrid(&dormancy->grid);
+    memset(dormancy, 0, sizeof(DormancySystem));
+}
+
+static bool reserveDormancySlots(DormancySystem* dormancy, int count) {
+    if (dormancy->slotCapacity >= count) return true;
+
+    int new_capacity = dormancy->slotCapacity ? dormancy->slotCapacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    uint32_t* idleSince = realloc(dormancy->idleSince, new_capacity * sizeof(uint32_t));
+    if (idleSince) dormancy->idleSince = idleSince;
+    uint8_t* dormant = realloc(dormancy->dormant, new_capacity * sizeof(uint8_t));
+    if (dormant) dormancy->dormant = dormant;
+    int* slots = realloc(dormancy->dormantSlots, new_capacity * sizeof(int));
+    if (slots) dormancy->dormantSlots = slots;
+    b2Vec2* positions = realloc(dormancy->dormantPositions, new_capacity * sizeof(b2Vec2));
+    if (positions) dormancy->dormantPositions = positions;
+    int* nearby = realloc(dormancy->nearby, new_capacity * sizeof(int));
+    if (nearby) dormancy->nearby = nearby;
+
+    if (!idleSince || !dormant || !slots || !positions || !nearby) {
+        fprintf(stderr, "[Dormancy] Failed to grow slot state to %d\n", new_capacity);
+        return false;
+    }
+    dormancy->slotCapacity = new_capacity;
+    dormancy->dormantCapacity = new_capacity;
+    return true;
+}
+
+// Candidates are pushed with the current tick, so the ring stays sorted
+static void pushCandidate(DormancySystem* dormancy, int slot, uint32_t tick) {
+    if (dormancy->queueCount == dormancy->queueCapacity) {
+        int new_capacity = dormancy->queueCapacity ? dormancy->queueCapacity * 2 : 64;
+        DormancyCandidate* queue = malloc(new_capacity * sizeof(DormancyCandidate));
+        if (!queue) {
+            fprintf(stderr, "[Dormancy] Failed to grow idle queue to %d\n", new_capacity);
+            return;
+        }
+        for (int i = 0; i < dormancy->queueCount; i++) {
+            queue[i] = dormancy->queue[(dormancy->queueHead + i) % dormancy->queueCapacity];
+        }
+        free(dormancy->queue);
+        dormancy->queue = queue;
+        dormancy->queueHead = 0;
+        dormancy->queueCapacity = new_capacity;
+    }
+
+    int tail = (dormancy->queueHead + dormancy->queueCount) % dormancy->queueCapacity;
+    dormancy->queue[tail] = (DormancyCandidate){slot, tick};
+    dormancy->queueCount++;
+}
+
+static void markIdle(DormancySystem* dormancy, int slot, uint32_t tick) {
+    dormancy->idleSince[slot] = tick;
+    pushCandidate(dormancy, slot, tick);
+}
+
+// Slots shifted or changed bodies - rebuild everything from the bodies themselves
+static void resyncDormancy(DormancySystem* dormancy, const EntityStateMirror* mirror, uint32_t tick) {
+    const EntityStateArrays* ships = &mirror->ships;
+    dormancy->membershipTick = mirror->membershipTick;
+    dormancy->queueHead = 0;
+    dormancy->queueCount = 0;
+    dormancy->dormantCount = 0;
+    dormancy->gridDirty = true;
+    if (!reserveDormancySlots(dormancy, ships->count)) return;
+
+    for (int slot = 0; slot < ships->count; slot++) {
+        dormancy->idleSince[slot] = 0;
+        dormancy->dormant[slot] = 0;
+        if (!(ships->flags[slot] & ENTITY_STATE_ACTIVE)) continue;
+
+        if (!b2Body_IsEnabled(ships->bodies[slot])) {
+            dormancy->dormant[slot] = 1;
+            dormancy->dormantSlots[dormancy->dormantCount] = slot;
+            dormancy->dormantPositions[dormancy->dormantCount] = (b2Vec2){ships->x[slot], ships->y[slot]};
+            dormancy->dormantCount++;
+        } else if (ships->flags[slot] & ENTITY_STATE_ASLEEP) {
+            markIdle(dormancy, slot, tick);
+        }
+    }
+}
+
+static void wakeShip(DormancySystem* dormancy, const EntityStateArrays* ships, int slot, uint32_t tick) {
+    if (!dormancy->dormant[slot]) return;
+    dormancy->dormant[slot] = 0;
+    dormancy->gridDirty = true;
+    b2Body_Enable(ships->bodies[slot]);
+
+    // Counts as idle from now - any movement resets it
+    markIdle(dormancy, slot, tick);
+}
+
+// Drop woken ships from the dormant list
+static void compactDormant(DormancySystem* dormancy) {
+    int kept = 0;
+    for (int i = 0; i < dormancy->dormantCount; i++) {
+        int slot = dormancy->dormantSlots[i];
+        if (!dormancy->dormant[slot]) continue;
+        dormancy->dormantSlots[kept] = slot;
+        dormancy->dormantPositions[kept] = dormancy->dormantPositions[i];
+        kept++;
+    }
+    dormancy->dormantCount = kept;
+}
+
+static void wakeNear(DormancySystem* dormancy, const EntityStateArrays* ships, b2Vec2 point, uint32_t tick) {
+    int found = querySpatialGrid(&dormancy->grid, point, DORMANCY_WAKE_RADIUS, dormancy->nearby,
+                                 dormancy->dormantCount);
+    for (int i = 0; i < found; i++) {
+        wakeShip(dormancy, ships, dormancy->dormantSlots[dormancy->nearby[i]], tick);
+    }
+}
+
+void updateDormancy(DormancySystem* dormancy, const EntityStateMirror* mirror, const float* pointsX,
+                    const float* pointsY, int pointCount, uint32_t tick) {
+    const EntityStateArrays* ships = &mirror->ships;
+    const EntityStateArrays* players = &mirror->players;
+    if (mirror->membershipTick != dormancy->membershipTick || dormancy->slotCapacity < ships->count) {
+        resyncDormancy(dormancy, mirror, tick);
+        if (dormancy->slotCapacity < ships->count) return;
+    }
+
+    // Ships that moved or fell asleep this step
+    for (int d = 0; d < ships->dirtyCount; d++) {
+        int slot = ships->dirty[d];
+        if (dormancy->dormant[slot]) continue;
+        if (ships->flags[slot] & ENTITY_STATE_ASLEEP) {
+            if (dormancy->idleSince[slot] == 0) markIdle(dormancy, slot, tick);
+        } else {
+            dormancy->idleSince[slot] = 0;
+        }
+    }
+
+    // Wake dormant ships near anything in motion
+    if (dormancy->dormantCount > 0) {
+        if (dormancy->gridDirty) {
+            rebuildSpatialGrid(&dormancy->grid, dormancy->dormantPositions, dormancy->dormantCount);
+            dormancy->gridDirty = false;
+        }
+
+        for (int d = 0; d < players->dirtyCount; d++) {
+            int slot = players->dirty[d];
+            if (!(players->flags[slot] & ENTITY_STATE_ACTIVE)) continue;
+            wakeNear(dormancy, ships, (b2Vec2){players->x[slot], players->y[slot]}, tick);
+        }
+        for (int d = 0; d < ships->dirtyCount; d++) {
+            int slot = ships->dirty[d];
+            if (dormancy->idleSince[slot] != 0 || !(ships->flags[slot] & ENTITY_STATE_ACTIVE)) continue;
+            wakeNear(dormancy, ships, (b2Vec2){ships->x[slot], ships->y[slot]}, tick);
+        }
+        for (int i = 0; i < pointCount; i++) {
+            wakeNear(dormancy, ships, (b2Vec2){pointsX[i], pointsY[i]}, tick);
+        }
+
+        if (dormancy->gridDirty) compactDormant(dormancy);
+    }
+
+    // Ships idle past the threshold leave the solver
+    while (dormancy->queueCount > 0) {
+        DormancyCandidate candidate = dormancy->queue[dormancy->queueHead];
+        if (tick - candidate.tick < dormancy->idleTicks) break;
+        dormancy->queueHead = (dormancy->queueHead + 1) % dormancy->queueCapacity;
+        dormancy->queueCount--;
+
+        int slot = candidate.slot;
+        // Stale once the ship moved again after being queued
+        if (slot >= ships->count || dormancy->dormant[slot] || dormancy->idleSince[slot] != candidate.tick) continue;
+        if (!(ships->flags[slot] & ENTITY_STATE_ACTIVE)) continue;
+
+        b2Body_Disable(ships->bodies[slot]);
+        dormancy->dormant[slot] = 1;
+        dormancy->idleSince[slot] = 0;
+        dormancy->dormantSlots[dormancy->dormantCount] = slot;
+        dormancy->dormantPositions[dormancy->dormantCount] = (b2Vec2){ships->x[slot], ships->y[slot]};
+        dormancy->dormantCount++;
+        dormancy->gridDirty = true;
+    }
+}
+
+void wakeAllDormant(DormancySystem* dormancy, const EntityStateMirror* mirror, uint32_t tick) {
+    if (mirror->membershipTick != dormancy->membershipTick || dormancy->slotCapacity < mirror->ships.count) {
+        resyncDormancy(dormancy, mirror, tick);
+    }
+    for (int i = 0; i < dormancy->dormantCount; i++) {
+        int slot = dormancy->dormantSlots[i];
+        if (slot < mirror->ships.count) wakeShip(dormancy, &mirror->ships, slot, tick);
+    }
+    if (dormancy->dormantCount > 0) {
+        fprintf(stderr, "[Dormancy] Woke %d dormant ships\n", dormancy->dormantCount);
+    }
+    dormancy->dormantCount = 0;
+}
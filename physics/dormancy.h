@@ -0,0 +1,58 @@
+#ifndef DORMANCY_H
+#define DORMANCY_H
+
+#include <box2d/box2d.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../core/game_state.h"
+#include "../world/spatial_grid.h"
+
+// Ships asleep for longer than the idle threshold are disabled, which takes
+// them out of the broadphase and solver entirely. Their last state stays in
+// the entity mirror, so replication and drawing carry on unchanged. Anything
+// moving within the wake radius, a projectile included, brings them back.
+// Work per tick follows the bodies that moved, not the ships in the world.
+#define DORMANCY_DEFAULT_IDLE_SECONDS 30.0f
+#define DORMANCY_WAKE_RADIUS 12.0f           // meters from a mover to a dormant ship's center
+#define DORMANCY_CELL_SIZE 16.0f
+#define DORMANCY_BUCKETS 1024
+
+typedef struct {
+    int slot;                                // Ship slot in the mirror
+    uint32_t tick;                           // Step the ship was last seen idle from
+} DormancyCandidate;
+
+typedef struct {
+    uint32_t idleTicks;                      // Asleep this long before going dormant
+    uint32_t* idleSince;                     // Per ship slot, 0 while moving
+    uint8_t* dormant;                        // Per ship slot
+    int slotCapacity;
+    uint32_t membershipTick;                 // Mirror membership the slots match
+
+    DormancyCandidate* queue;                // Ring ordered by tick, oldest first
+    int queueHead;
+    int queueCount;
+    int queueCapacity;
+
+    int* dormantSlots;                       // Compact list of dormant ships
+    b2Vec2* dormantPositions;                // Parallel to dormantSlots
+    int dormantCount;
+    int dormantCapacity;
+    SpatialGrid grid;                        // Over dormantPositions
+    bool gridDirty;
+    int* nearby;                             // Query scratch
+} DormancySystem;
+
+bool initDormancySystem(DormancySystem* dormancy, float idleSeconds, float tickSeconds);
+void cleanupDormancySystem(DormancySystem* dormancy);
+
+// After the mirror sync: wake ships near anything that moved or the given
+// points (projectiles), then make ships idle past the threshold dormant
+void updateDormancy(DormancySystem* dormancy, const EntityStateMirror* mirror, const float* pointsX,
+                    const float* pointsY, int pointCount, uint32_t tick);
+
+// Admin action
+void wakeAllDormant(DormancySystem* dormancy, const EntityStateMirror* mirror, uint32_t tick);
+
+#endif // DORMANCY_H
@@ -0,0 +1,259 @@
+#include "lag_compensation.h"
+#include "player/player_physics.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+bool initLagHistory(LagHistory* history) {
+    memset(history, 0, sizeof(LagHistory));
+    for (int i = 0; i < LAG_HISTORY_SIZE; i++) {
+        if (!initSpatialGrid(&history->frames[i].grid, LAG_HISTORY_CELL_SIZE, LAG_HISTORY_BUCKETS)) {
+            cleanupLagHistory(history);
+            return false;
+        }
+    }
+    return true;
+}
+
+void cleanupLagHistory(LagHistory* history) {
+    if (!history) return;
+    for (int i = 0; i < LAG_HISTORY_SIZE; i++) {
+        LagHistoryFrame* frame = &history->frames[i];
+        free(frame->keys);
+        free(frame->positions);
+        free(frame->rotations);
+        cleanupSpatialGrid(&frame->grid);
+    }
+    free(history->candidates);
+    memset(history, 0, sizeof(LagHistory));
+}
+
+static bool reserveLagFrame(LagHistoryFrame* frame, int count) {
+    if (frame->capacity >= count) return true;
+
+    int new_capacity = frame->capacity ? frame->capacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    EntityKey* keys = realloc(frame->keys, new_capacity * sizeof(EntityKey));
+    if (keys) frame->keys = keys;
+    b2Vec2* positions = realloc(frame->positions, new_capacity * sizeof(b2Vec2));
+    if (positions) frame->positions = positions;
+    b2Rot* rotations = realloc(frame->rotations, new_capacity * sizeof(b2Rot));
+    if (rotations) frame->rotations = rotations;
+
+    if (!keys || !positions || !rotations) {
+        fprintf(stderr, "[LagComp] Failed to grow history frame to %d\n", new_capacity);
+        return false;
+    }
+    frame->capacity = new_capacity;
+    return true;
+}
+
+LagHistoryFrame* beginLagHistoryFrame(LagHistory* history, uint32_t tick, int entityCount) {
+    LagHistoryFrame* frame = &history->frames[tick & LAG_HISTORY_MASK];
+    frame->valid = false;
+    frame->count = 0;
+    frame->tick = tick;
+    return reserveLagFrame(frame, entityCount) ? frame : NULL;
+}
+
+void recordLagHistoryBody(LagHistoryFrame* frame, EntityKey key, b2BodyId body) {
+    if (!frame || frame->count >= frame->capacity) return;
+
+    b2Transform xf = worldCellBodyTransform(body);
+    frame->keys[frame->count] = key;
+    frame->positions[frame->count] = xf.p;
+    frame->rotations[frame->count] = xf.q;
+    frame->count++;
+}
+
+void finishLagHistoryFrame(LagHistory* history, LagHistoryFrame* frame) {
+    if (!frame) return;
+
+    if (history->candidateCapacity < frame->count) {
+        int* candidates = realloc(history->candidates, frame->capacity * sizeof(int));
+        if (!candidates) {
+            fprintf(stderr, "[LagComp] Failed to grow query scratch to %d\n", frame->capacity);
+            return;
+        }
+        history->candidates = candidates;
+        history->candidateCapacity = frame->capacity;
+    }
+
+    rebuildSpatialGrid(&frame->grid, frame->positions, frame->count);
+    frame->valid = true;
+    history->latestTick = frame->tick;
+    history->hasLatest = true;
+}
+
+static const LagHistoryFrame* frameAtTick(const LagHistory* history, uint32_t tick) {
+    const LagHistoryFrame* frame = &history->frames[tick & LAG_HISTORY_MASK];
+    return (frame->valid && frame->tick == tick) ? frame : NULL;
+}
+
+uint32_t lagHistoryRewindTick(const LagHistory* history, float latencySeconds, float tickSeconds) {
+    if (!history->hasLatest) return 0;
+
+    uint32_t ticks = 0;
+    if (latencySeconds > 0.0f && tickSeconds > 0.0f) {
+        float rewind = latencySeconds / tickSeconds + 0.5f;
+        ticks = rewind < (float)(LAG_HISTORY_SIZE - 1) ? (uint32_t)rewind : LAG_HISTORY_SIZE - 1;
+    }
+
+    // Right after startup the ring isn't full yet
+    while (ticks > 0 && !frameAtTick(history, history->latestTick - ticks)) ticks--;
+    return history->latestTick - ticks;
+}
+
+// Points and directions into the entity's local frame and back
+static inline b2Vec2 toLocal(b2Rot q, b2Vec2 v) {
+    return (b2Vec2){q.c * v.x + q.s * v.y, -q.s * v.x + q.c * v.y};
+}
+
+static inline b2Vec2 toWorld(b2Rot q, b2Vec2 v) {
+    return (b2Vec2){q.c * v.x - q.s * v.y, q.s * v.x + q.c * v.y};
+}
+
+// Ray against a circle at the origin. Rays starting inside don't hit, as in Box2D.
+static bool rayCastCircle(b2Vec2 o, b2Vec2 d, float radius, float maxFraction,
+                          float* fraction, b2Vec2* normal) {
+    float a = d.x * d.x + d.y * d.y;
+    float b = o.x * d.x + o.y * d.y;
+    float c = o.x * o.x + o.y * o.y - radius * radius;
+    if (c < 0.0f || a <= 0.0f) return false;
+
+    float disc = b * b - a * c;
+    if (disc < 0.0f) return false;
+
+    float t = (-b - sqrtf(disc)) / a;
+    if (t < 0.0f || t > maxFraction) return false;
+
+    b2Vec2 p = {o.x + t * d.x, o.y + t * d.y};
+    float len = sqrtf(p.x * p.x + p.y * p.y);
+    *fraction = t;
+    *normal = len > 0.0f ? (b2Vec2){p.x / len, p.y / len} : (b2Vec2){0.0f, 0.0f};
+    return true;
+}
+
+// Ray against a box centered on the origin, slab method
+static bool rayCastBox(b2Vec2 o, b2Vec2 d, b2Vec2 half, float maxFraction,
+                       float* fraction, b2Vec2* normal) {
+    float origin[2] = {o.x, o.y};
+    float dir[2] = {d.x, d.y};
+    float extent[2] = {half.x, half.y};
+    float enter = -INFINITY, leave = INFINITY;
+    int enterAxis = -1;
+    float enterSign = 0.0f;
+
+    for (int axis = 0; axis < 2; axis++) {
+        if (fabsf(dir[axis]) < 1e-9f) {
+            if (fabsf(origin[axis]) > extent[axis]) return false;
+            continue;
+        }
+        float inv = 1.0f / dir[axis];
+        float t1 = (-extent[axis] - origin[axis]) * inv;
+        float t2 = (extent[axis] - origin[axis]) * inv;
+        float sign = -1.0f;
+        if (t1 > t2) {
+            float tmp = t1; t1 = t2; t2 = tmp;
+            sign = 1.0f;
+        }
+        if (t1 > enter) {
+            enter = t1;
+            enterAxis = axis;
+            enterSign = sign;
+        }
+        if (t2 < leave) leave = t2;
+        if (enter > leave) return false;
+    }
+
+    if (enterAxis < 0 || enter < 0.0f || enter > maxFraction) return false;
+    *fraction = enter;
+    *normal = enterAxis == 0 ? (b2Vec2){enterSign, 0.0f} : (b2Vec2){0.0f, enterSign};
+    return true;
+}
+
+// Box half extents match the hull created by createShipHull
+static inline b2Vec2 shipHalfExtents(void) {
+    return (b2Vec2){PHYSICS_SHIP_LENGTH * 0.5f, PHYSICS_SHIP_WIDTH * 0.5f};
+}
+
+bool lagHistoryRayCast(LagHistory* history, uint32_t tick, b2Vec2 origin, b2Vec2 translation,
+                       EntityKey ignore, LagHistoryHit* hit) {
+    const LagHistoryFrame* frame = frameAtTick(history, tick);
+    if (!frame || !hit) return false;
+
+    // The circle around the segment bounds every entity it could touch
+    float length = sqrtf(translation.x * translation.x + translation.y * translation.y);
+    b2Vec2 mid = {origin.x + translation.x * 0.5f, origin.y + translation.y * 0.5f};
+    int count = querySpatialGrid(&frame->grid, mid, length * 0.5f + LAG_ENTITY_MAX_EXTENT,
+                                 history->candidates, history->candidateCapacity);
+
+    float best = 1.0f;
+    bool found = false;
+    for (int i = 0; i < count; i++) {
+        int item = history->candidates[i];
+        EntityKey key = frame->keys[item];
+        if (key == ignore) continue;
+
+        b2Rot q = frame->rotations[item];
+        b2Vec2 p = frame->positions[item];
+        b2Vec2 o = toLocal(q, (b2Vec2){origin.x - p.x, origin.y - p.y});
+        b2Vec2 d = toLocal(q, translation);
+
+        float fraction;
+        b2Vec2 normal;
+        bool hitShape = ENTITY_KEY_TYPE(key) == ENTITY_TYPE_SHIP
+            ? rayCastBox(o, d, shipHalfExtents(), best, &fraction, &normal)
+            : rayCastCircle(o, d, PLAYER_RADIUS, best, &fraction, &normal);
+        if (!hitShape) continue;
+
+        best = fraction;
+        found = true;
+        hit->key = key;
+        hit->fraction = fraction;
+        hit->normal = toWorld(q, normal);
+    }
+
+    if (found) {
+        hit->point = (b2Vec2){origin.x + translation.x * best, origin.y + translation.y * best};
+    }
+    return found;
+}
+
+int lagHistoryOverlapCircle(LagHistory* history, uint32_t tick, b2Vec2 center, float radius,
+                            EntityKey ignore, EntityKey* out, int maxOut) {
+    const LagHistoryFrame* frame = frameAtTick(history, tick);
+    if (!frame || !out) return 0;
+
+    int count = querySpatialGrid(&frame->grid, center, radius + LAG_ENTITY_MAX_EXTENT,
+                                 history->candidates, history->candidateCapacity);
+
+    int found = 0;
+    for (int i = 0; i < count && found < maxOut; i++) {
+        int item = history->candidates[i];
+        EntityKey key = frame->keys[item];
+        if (key == ignore) continue;
+
+        b2Vec2 p = frame->positions[item];
+        b2Vec2 local = toLocal(frame->rotations[item], (b2Vec2){center.x - p.x, center.y - p.y});
+
+        bool overlaps;
+        if (ENTITY_KEY_TYPE(key) == ENTITY_TYPE_SHIP) {
+            // Distance from the circle center to the closest point of the box
+            b2Vec2 half = shipHalfExtents();
+            float dx = fabsf(local.x) - half.x;
+            float dy = fabsf(local.y) - half.y;
+            dx = dx > 0.0f ? dx : 0.0f;
+            dy = dy > 0.0f ? dy : 0.0f;
+            overlaps = dx * dx + dy * dy <= radius * radius;
+        } else {
+            float reach = radius + PLAYER_RADIUS;
+            overlaps = local.x * local.x + local.y * local.y <= reach * reach;
+        }
+
+        if (overlaps) out[found++] = key;
+    }
+    return found;
+}
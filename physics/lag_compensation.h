@@ -0,0 +1,65 @@
+#ifndef LAG_COMPENSATION_H
+#define LAG_COMPENSATION_H
+
+#include <box2d/box2d.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../core/game_state.h"
+#include "../world/spatial_grid.h"
+
+// Transform history for server-side rewind. Each physics tick records
+// every replicated body into one frame of a ring, so hit checks can be
+// judged against where entities were when the shooter saw them.
+#define LAG_HISTORY_SIZE 64              // Power of two, ~1s at 60Hz
+#define LAG_HISTORY_MASK (LAG_HISTORY_SIZE - 1)
+#define LAG_HISTORY_CELL_SIZE 16.0f      // meters
+#define LAG_HISTORY_BUCKETS 1024
+#define LAG_ENTITY_MAX_EXTENT 2.5f       // Farthest point of any shape from its body origin
+
+// One tick, struct-of-arrays so a query touches only the fields it reads
+typedef struct {
+    uint32_t tick;
+    bool valid;
+    EntityKey* keys;
+    b2Vec2* positions;
+    b2Rot* rotations;
+    int count;
+    int capacity;
+    SpatialGrid grid;                    // Over positions, for O(candidates) queries
+} LagHistoryFrame;
+
+typedef struct {
+    LagHistoryFrame frames[LAG_HISTORY_SIZE];  // Indexed by tick
+    uint32_t latestTick;
+    bool hasLatest;
+    int* candidates;                     // Query scratch
+    int candidateCapacity;
+} LagHistory;
+
+typedef struct {
+    EntityKey key;
+    b2Vec2 point;
+    b2Vec2 normal;
+    float fraction;                      // Along the ray translation
+} LagHistoryHit;
+
+bool initLagHistory(LagHistory* history);
+void cleanupLagHistory(LagHistory* history);
+
+// Recording - begin a frame, add every body, then finish it
+LagHistoryFrame* beginLagHistoryFrame(LagHistory* history, uint32_t tick, int entityCount);
+void recordLagHistoryBody(LagHistoryFrame* frame, EntityKey key, b2BodyId body);
+void finishLagHistoryFrame(LagHistory* history, LagHistoryFrame* frame);
+
+// Tick the shooter was looking at, clamped to the oldest tick still held
+uint32_t lagHistoryRewindTick(const LagHistory* history, float latencySeconds, float tickSeconds);
+
+// Queries against a recorded tick, skipping the entity doing the query.
+// Both return nothing when the tick has fallen out of the history.
+bool lagHistoryRayCast(LagHistory* history, uint32_t tick, b2Vec2 origin, b2Vec2 translation,
+                       EntityKey ignore, LagHistoryHit* hit);
+int lagHistoryOverlapCircle(LagHistory* history, uint32_t tick, b2Vec2 center, float radius,
+                            EntityKey ignore, EntityKey* out, int maxOut);
+
+#endif // LAG_COMPENSATION_H
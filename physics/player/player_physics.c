@@ -1,8 +1,10 @@
 #include "player_physics.h"
 #include "game_protocol.h"
+#include "../collision_layers.h"
 #include <math.h>
 #include <box2d/box2d.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>     // Add for memcpy
 #include <stdint.h>     // Add for uint64_t
 #include <inttypes.h>   // Add for PRIu64
@@ -29,6 +31,7 @@ b2BodyId createPlayerBody(b2WorldId worldId, float x, float y) {
     shapeDef.density = PLAYER_DENSITY;
     shapeDef.friction = PLAYER_FRICTION;
     shapeDef.restitution = PLAYER_RESTITUTION;
+    shapeDef.filter = collisionFilterFor(COLLISION_LAYER_PLAYER);
     
     b2ShapeId shapeId = b2CreateCircleShape(bodyId, &shapeDef, &circle);
     
@@ -41,41 +44,42 @@ b2BodyId createPlayerBody(b2WorldId worldId, float x, float y) {
     return bodyId;
 }
 
-void applyPlayerMovement(b2BodyId bodyId, uint16_t inputFlags, float dt) {
-    float angle = b2Body_GetAngle(bodyId);
-    b2Vec2 facing = {cosf(angle), sinf(angle)};
-    b2Vec2 right = {-facing.y, facing.x};  // Right vector for strafing
-    b2Vec2 force = {0, 0};
-    float torque = 0;
-    
+// Input flags as force along facing, force along the right vector and torque.
+// Forward with a turn key strafes instead of turning.
+static void playerInputCoefficients(uint16_t inputFlags, float* along, float* lateral, float* torque) {
+    *along = 0.0f;
+    *lateral = 0.0f;
+    *torque = 0.0f;
+
     // Handle strafe combinations
     if ((inputFlags & INPUT_STRAFE_LEFT) == INPUT_STRAFE_LEFT) {
-        // Strafe left (forward + left)
-        force.x += (facing.x * PLAYER_STRAFE_FACTOR + right.x * -PLAYER_STRAFE_FACTOR) * PLAYER_MOVE_FORCE;
-        force.y += (facing.y * PLAYER_STRAFE_FACTOR + right.y * -PLAYER_STRAFE_FACTOR) * PLAYER_MOVE_FORCE;
+        *along = PLAYER_STRAFE_FACTOR * PLAYER_MOVE_FORCE;
+        *lateral = -PLAYER_STRAFE_FACTOR * PLAYER_MOVE_FORCE;
     }
     else if ((inputFlags & INPUT_STRAFE_RIGHT) == INPUT_STRAFE_RIGHT) {
-        // Strafe right (forward + right)
-        force.x += (facing.x * PLAYER_STRAFE_FACTOR + right.x * PLAYER_STRAFE_FACTOR) * PLAYER_MOVE_FORCE;
-        force.y += (facing.y * PLAYER_STRAFE_FACTOR + right.y * PLAYER_STRAFE_FACTOR) * PLAYER_MOVE_FORCE;
+        *along = PLAYER_STRAFE_FACTOR * PLAYER_MOVE_FORCE;
+        *lateral = PLAYER_STRAFE_FACTOR * PLAYER_MOVE_FORCE;
     }
     else {
         // Handle individual directional inputs
-        if (inputFlags & INPUT_FORWARD) {
-            force.x += facing.x * PLAYER_MOVE_FORCE;
-            force.y += facing.y * PLAYER_MOVE_FORCE;
-        }
-        if (inputFlags & INPUT_BACKWARD) {
-            force.x -= facing.x * PLAYER_MOVE_FORCE * 0.5f;
-            force.y -= facing.y * PLAYER_MOVE_FORCE * 0.5f;
-        }
-        if (inputFlags & INPUT_LEFT) torque -= PLAYER_TURN_TORQUE;
-        if (inputFlags & INPUT_RIGHT) torque += PLAYER_TURN_TORQUE;
+        if (inputFlags & INPUT_FORWARD) *along += PLAYER_MOVE_FORCE;
+        if (inputFlags & INPUT_BACKWARD) *along -= PLAYER_MOVE_FORCE * 0.5f;
+        if (inputFlags & INPUT_LEFT) *torque -= PLAYER_TURN_TORQUE;
+        if (inputFlags & INPUT_RIGHT) *torque += PLAYER_TURN_TORQUE;
     }
-    
-    // Apply forces with wake parameter
-    b2Body_ApplyForceToCenter(bodyId, force, true);
-    b2Body_ApplyTorque(bodyId, torque, true);
+}
+
+void applyPlayerMovement(b2BodyId bodyId, uint16_t inputFlags) {
+    float along, lateral, torque;
+    playerInputCoefficients(inputFlags, &along, &lateral, &torque);
+
+    // Facing is (c, s) and right is (-s, c), no need to go through the angle
+    b2Rot rot = b2Body_GetRotation(bodyId);
+    b2Vec2 force = {rot.c * along - rot.s * lateral, rot.s * along + rot.c * lateral};
+
+    // Only wake the body when there is input, so idle players can sleep
+    if (force.x != 0.0f || force.y != 0.0f) b2Body_ApplyForceToCenter(bodyId, force, true);
+    if (torque != 0.0f) b2Body_ApplyTorque(bodyId, torque, true);
 }
 
 void limitPlayerVelocity(b2BodyId bodyId) {
@@ -89,3 +93,101 @@ void limitPlayerVelocity(b2BodyId bodyId) {
         b2Body_SetLinearVelocity(bodyId, vel);
     }
 }
+
+bool reservePlayerMovementBatch(PlayerMovementBatch* batch, int count) {
+    if (batch->capacity >= count) return true;
+
+    int new_capacity = batch->capacity ? batch->capacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    b2BodyId* bodies = realloc(batch->bodies, new_capacity * sizeof(b2BodyId));
+    if (bodies) batch->bodies = bodies;
+    float** columns[] = {
+        &batch->cos, &batch->sin, &batch->along, &batch->lateral, &batch->torque,
+        &batch->vx, &batch->vy, &batch->forceX, &batch->forceY, &batch->speedSq
+    };
+    bool ok = bodies != NULL;
+    for (size_t i = 0; i < sizeof(columns) / sizeof(columns[0]); i++) {
+        float* column = realloc(*columns[i], new_capacity * sizeof(float));
+        if (column) *columns[i] = column;
+        else ok = false;
+    }
+
+    if (!ok) {
+        logDebug("Failed to grow movement batch to %d", new_capacity);
+        return false;
+    }
+    batch->capacity = new_capacity;
+    return true;
+}
+
+void freePlayerMovementBatch(PlayerMovementBatch* batch) {
+    if (!batch) return;
+    free(batch->bodies);
+    free(batch->cos);
+    free(batch->sin);
+    free(batch->along);
+    free(batch->lateral);
+    free(batch->torque);
+    free(batch->vx);
+    free(batch->vy);
+    free(batch->forceX);
+    free(batch->forceY);
+    free(batch->speedSq);
+    memset(batch, 0, sizeof(PlayerMovementBatch));
+}
+
+// Gather - the only per-player Box2D reads are rotation and velocity
+void addPlayerMovement(PlayerMovementBatch* batch, b2BodyId bodyId, uint16_t inputFlags) {
+    if (batch->count >= batch->capacity && !reservePlayerMovementBatch(batch, batch->count + 1)) return;
+
+    int i = batch->count++;
+    b2Rot rot = b2Body_GetRotation(bodyId);
+    b2Vec2 vel = b2Body_GetLinearVelocity(bodyId);
+    batch->bodies[i] = bodyId;
+    batch->cos[i] = rot.c;
+    batch->sin[i] = rot.s;
+    batch->vx[i] = vel.x;
+    batch->vy[i] = vel.y;
+    playerInputCoefficients(inputFlags, &batch->along[i], &batch->lateral[i], &batch->torque[i]);
+}
+
+// Branch-free over plain arrays so the compiler can vectorize it
+void computePlayerMovementForces(PlayerMovementBatch* batch) {
+    const int count = batch->count;
+    const float* restrict c = batch->cos;
+    const float* restrict s = batch->sin;
+    const float* restrict along = batch->along;
+    const float* restrict lateral = batch->lateral;
+    const float* restrict vx = batch->vx;
+    const float* restrict vy = batch->vy;
+    float* restrict fx = batch->forceX;
+    float* restrict fy = batch->forceY;
+    float* restrict speedSq = batch->speedSq;
+
+    for (int i = 0; i < count; i++) {
+        fx[i] = c[i] * along[i] - s[i] * lateral[i];
+        fy[i] = s[i] * along[i] + c[i] * lateral[i];
+    }
+    // Separate loop - gcc gives up on vectorizing with all nine streams in one
+    for (int i = 0; i < count; i++) {
+        speedSq[i] = vx[i] * vx[i] + vy[i] * vy[i];
+    }
+}
+
+// Scatter - Box2D calls only where there is something to apply
+void applyPlayerMovementBatch(PlayerMovementBatch* batch) {
+    for (int i = 0; i < batch->count; i++) {
+        b2BodyId body = batch->bodies[i];
+        if (batch->forceX[i] != 0.0f || batch->forceY[i] != 0.0f) {
+            b2Body_ApplyForceToCenter(body, (b2Vec2){batch->forceX[i], batch->forceY[i]}, true);
+        }
+        if (batch->torque[i] != 0.0f) b2Body_ApplyTorque(body, batch->torque[i], true);
+        // Rare, so the square root stays out of the kernel
+        if (batch->speedSq[i] > PLAYER_MAX_SPEED * PLAYER_MAX_SPEED) {
+            float k = PLAYER_MAX_SPEED / sqrtf(batch->speedSq[i]);
+            b2Body_SetLinearVelocity(body, (b2Vec2){batch->vx[i] * k, batch->vy[i] * k});
+        }
+    }
+    batch->count = 0;
+}
@@ -3,6 +3,7 @@
 
 #include <box2d/box2d.h>
 #include <math.h>
+#include <stdbool.h>
 #include "../network/game_protocol.h"  // Add this to get input flags
 
 // Add Box2D angle calculation helpers for Box2D 3.0
@@ -31,9 +32,35 @@ static inline void b2Body_SetAngle(b2BodyId bodyId, float angle) {
 #define PLAYER_BOOST_MULTIPLIER 2.0f
 #define PLAYER_BRAKE_FORCE 250.0f  // Add brake force constant
 
+// One tick of movement for every player, struct-of-arrays so the force
+// kernel runs over plain float arrays. Fill with addPlayerMovement, then
+// compute and apply once.
+typedef struct {
+    b2BodyId* bodies;
+    float* cos;            // Body rotation, straight from b2Rot
+    float* sin;
+    float* along;          // Force along facing, from the input flags
+    float* lateral;        // Force along the right vector
+    float* torque;
+    float* vx;             // Velocity before the step, for the speed limit
+    float* vy;
+    float* forceX;         // Kernel output
+    float* forceY;
+    float* speedSq;        // Checked against PLAYER_MAX_SPEED when applying
+    int count;
+    int capacity;
+} PlayerMovementBatch;
+
 // Function declarations
 b2BodyId createPlayerBody(b2WorldId worldId, float x, float y);
-void applyPlayerMovement(b2BodyId bodyId, uint16_t inputFlags, float dt);  // Change to uint16_t
+void applyPlayerMovement(b2BodyId bodyId, uint16_t inputFlags);  // Change to uint16_t
 void limitPlayerVelocity(b2BodyId bodyId);
 
+// Batched movement
+bool reservePlayerMovementBatch(PlayerMovementBatch* batch, int count);
+void freePlayerMovementBatch(PlayerMovementBatch* batch);
+void addPlayerMovement(PlayerMovementBatch* batch, b2BodyId bodyId, uint16_t inputFlags);
+void computePlayerMovementForces(PlayerMovementBatch* batch);
+void applyPlayerMovementBatch(PlayerMovementBatch* batch);
+
 #endif
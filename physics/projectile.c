@@ -0,0 +1,232 @@
+#include "projectile.h"
+#include "collision_layers.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+bool initProjectileSystem(ProjectileSystem* projectiles, int poolSize) {
+    memset(projectiles, 0, sizeof(ProjectileSystem));
+    if (poolSize <= 0) {
+        fprintf(stderr, "[Projectile] Invalid pool size %d, using %d\n", poolSize, PROJECTILE_DEFAULT_POOL);
+        poolSize = PROJECTILE_DEFAULT_POOL;
+    }
+
+    projectiles->ids = malloc(poolSize * sizeof(uint32_t));
+    projectiles->spawnTicks = malloc(poolSize * sizeof(uint32_t));
+    projectiles->originX = malloc(poolSize * sizeof(float));
+    projectiles->originY = malloc(poolSize * sizeof(float));
+    projectiles->velocityX = malloc(poolSize * sizeof(float));
+    projectiles->velocityY = malloc(poolSize * sizeof(float));
+    projectiles->lastX = malloc(poolSize * sizeof(float));
+    projectiles->lastY = malloc(poolSize * sizeof(float));
+    projectiles->ownerIds = malloc(poolSize * sizeof(uint32_t));
+    projectiles->types = malloc(poolSize * sizeof(uint8_t));
+    projectiles->nextId = 1;
+
+    if (!projectiles->ids || !projectiles->spawnTicks || !projectiles->originX || !projectiles->originY ||
+        !projectiles->velocityX || !projectiles->velocityY || !projectiles->lastX || !projectiles->lastY ||
+        !projectiles->ownerIds || !projectiles->types) {
+        fprintf(stderr, "[Projectile] Failed to allocate pool of %d\n", poolSize);
+        cleanupProjectileSystem(projectiles);
+        return false;
+    }
+    projectiles->capacity = poolSize;
+    return true;
+}
+
+void cleanupProjectileSystem(ProjectileSystem* projectiles) {
+    if (!projectiles) return;
+    free(projectiles->ids);
+    free(projectiles->spawnTicks);
+    free(projectiles->originX);
+    free(projectiles->originY);
+    free(projectiles->velocityX);
+    free(projectiles->velocityY);
+    free(projectiles->lastX);
+    free(projectiles->lastY);
+    free(projectiles->ownerIds);
+    free(projectiles->types);
+    free(projectiles->spawns);
+    free(projectiles->hits);
+    free(projectiles->hitPositions);
+    memset(projectiles, 0, sizeof(ProjectileSystem));
+}
+
+static bool reserveSpawnEvents(ProjectileSystem* projectiles, int count) {
+    if (projectiles->spawnCapacity >= count) return true;
+
+    int new_capacity = projectiles->spawnCapacity ? projectiles->spawnCapacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    GameProjectileSpawn* spawns = realloc(projectiles->spawns, new_capacity * sizeof(GameProjectileSpawn));
+    if (!spawns) {
+        fprintf(stderr, "[Projectile] Failed to grow spawn events to %d\n", new_capacity);
+        return false;
+    }
+    projectiles->spawns = spawns;
+    projectiles->spawnCapacity = new_capacity;
+    return true;
+}
+
+static bool reserveHitEvents(ProjectileSystem* projectiles, int count) {
+    if (projectiles->hitCapacity >= count) return true;
+
+    int new_capacity = projectiles->hitCapacity ? projectiles->hitCapacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    GameProjectileHit* hits = realloc(projectiles->hits, new_capacity * sizeof(GameProjectileHit));
+    if (hits) projectiles->hits = hits;
+    b2Vec2* positions = realloc(projectiles->hitPositions, new_capacity * sizeof(b2Vec2));
+    if (positions) projectiles->hitPositions = positions;
+
+    if (!hits || !positions) {
+        fprintf(stderr, "[Projectile] Failed to grow hit events to %d\n", new_capacity);
+        return false;
+    }
+    projectiles->hitCapacity = new_capacity;
+    return true;
+}
+
+uint32_t spawnProjectile(ProjectileSystem* projectiles, uint8_t type, b2Vec2 position, b2Vec2 velocity,
+                         uint32_t ownerId, uint32_t tick) {
+    if (projectiles->count >= projectiles->capacity) return 0;
+    if (!reserveSpawnEvents(projectiles, projectiles->spawnCount + 1)) return 0;
+
+    int i = projectiles->count++;
+    uint32_t id = projectiles->nextId++;
+    if (projectiles->nextId == 0) projectiles->nextId = 1;
+
+    projectiles->ids[i] = id;
+    projectiles->spawnTicks[i] = tick;
+    projectiles->originX[i] = projectiles->lastX[i] = position.x;
+    projectiles->originY[i] = projectiles->lastY[i] = position.y;
+    projectiles->velocityX[i] = velocity.x;
+    projectiles->velocityY[i] = velocity.y;
+    projectiles->ownerIds[i] = ownerId;
+    projectiles->types[i] = type;
+
+    projectiles->spawns[projectiles->spawnCount++] = (GameProjectileSpawn){
+        .projectile_id = id,
+        .spawn_tick = tick,
+        .pos_x = position.x,
+        .pos_y = position.y,
+        .velocity_x = velocity.x,
+        .velocity_y = velocity.y,
+        .projectile_type = type
+    };
+    return id;
+}
+
+uint32_t fireProjectileFrom(ProjectileSystem* projectiles, b2Vec2 position, float rotation, b2Vec2 velocity,
+                            uint32_t ownerId, uint32_t tick) {
+    float c = cosf(rotation);
+    float s = sinf(rotation);
+    b2Vec2 muzzle = {position.x + c * PROJECTILE_MUZZLE_OFFSET, position.y + s * PROJECTILE_MUZZLE_OFFSET};
+    b2Vec2 launch = {velocity.x + c * PROJECTILE_SPEED, velocity.y + s * PROJECTILE_SPEED};
+    return spawnProjectile(projectiles, PROJECTILE_TYPE_CANNONBALL, muzzle, launch, ownerId, tick);
+}
+
+uint32_t fireProjectileFromBody(ProjectileSystem* projectiles, b2BodyId body, uint32_t tick) {
+    b2Rot rot = b2Body_GetRotation(body);
+    return fireProjectileFrom(projectiles, worldCellBodyPosition(body), atan2f(rot.s, rot.c),
+                              b2Body_GetLinearVelocity(body), 0, tick);
+}
+
+// Swap the last projectile into slot i
+static void removeProjectile(ProjectileSystem* projectiles, int i) {
+    int last = --projectiles->count;
+    if (i == last) return;
+    projectiles->ids[i] = projectiles->ids[last];
+    projectiles->spawnTicks[i] = projectiles->spawnTicks[last];
+    projectiles->originX[i] = projectiles->originX[last];
+    projectiles->originY[i] = projectiles->originY[last];
+    projectiles->velocityX[i] = projectiles->velocityX[last];
+    projectiles->velocityY[i] = projectiles->velocityY[last];
+    projectiles->lastX[i] = projectiles->lastX[last];
+    projectiles->lastY[i] = projectiles->lastY[last];
+    projectiles->ownerIds[i] = projectiles->ownerIds[last];
+    projectiles->types[i] = projectiles->types[last];
+}
+
+typedef struct {
+    const EntityStateArrays* ships;
+    uint32_t ownerId;
+    uint32_t targetId;
+    b2Vec2 point;
+    float fraction;                      // Of the closest hit so far, cells are cast one by one
+} ProjectileRayContext;
+
+// Keeps the closest ship along the ray, anything else is passed through
+static float projectileRayCallback(b2ShapeId shapeId, b2Vec2 point, b2Vec2 normal, float fraction, void* context) {
+    (void)normal;
+    ProjectileRayContext* ray = context;
+    b2BodyId body = b2Shape_GetBody(shapeId);
+    void* tag = b2Body_GetUserData(body);
+    if (!tag || ENTITY_MIRROR_TAG_KIND(tag) != ENTITY_TYPE_SHIP) return -1.0f;
+
+    int slot = ENTITY_MIRROR_TAG_SLOT(tag);
+    if (!entityStateSlotMatches(ray->ships, slot, body)) return -1.0f;
+    if (ray->ships->ids[slot] == ray->ownerId) return -1.0f;
+    if (fraction >= ray->fraction) return -1.0f;
+
+    ray->fraction = fraction;
+    ray->targetId = ray->ships->ids[slot];
+    ray->point = point;
+    return fraction;
+}
+
+void stepProjectiles(ProjectileSystem* projectiles, const WorldCells* cells, const EntityStateMirror* mirror,
+                     uint32_t tick, float dt) {
+    // Shapes on layers projectiles don't collide with are skipped by the broadphase
+    b2QueryFilter filter = collisionQueryFilterFor(COLLISION_LAYER_PROJECTILE);
+
+    for (int i = 0; i < projectiles->count;) {
+        float t = (float)(tick - projectiles->spawnTicks[i]) * dt;
+        bool expired = t >= PROJECTILE_LIFETIME;
+        if (expired) t = PROJECTILE_LIFETIME;
+
+        // Closed form of dv/dt = -drag * v, so no error builds up over the flight
+        float travel = (1.0f - expf(-PROJECTILE_DRAG * t)) / PROJECTILE_DRAG;
+        b2Vec2 from = {projectiles->lastX[i], projectiles->lastY[i]};
+        b2Vec2 to = {
+            projectiles->originX[i] + projectiles->velocityX[i] * travel,
+            projectiles->originY[i] + projectiles->velocityY[i] * travel
+        };
+
+        ProjectileRayContext ray = {
+            .ships = &mirror->ships,
+            .ownerId = projectiles->ownerIds[i],
+            .fraction = 1.0f
+        };
+        b2Vec2 translation = {to.x - from.x, to.y - from.y};
+        if (translation.x != 0.0f || translation.y != 0.0f) {
+            castWorldCellsRay(cells, from, translation, filter, projectileRayCallback, &ray);
+        }
+
+        if (ray.targetId != 0 && reserveHitEvents(projectiles, projectiles->hitCount + 1)) {
+            projectiles->hits[projectiles->hitCount] = (GameProjectileHit){
+                .projectile_id = projectiles->ids[i],
+                .target_id = ray.targetId,
+                .damage = PROJECTILE_DAMAGE
+            };
+            projectiles->hitPositions[projectiles->hitCount] = ray.point;
+            projectiles->hitCount++;
+            removeProjectile(projectiles, i);
+            continue;
+        }
+        if (expired) {
+            removeProjectile(projectiles, i);
+            continue;
+        }
+
+        projectiles->lastX[i] = to.x;
+        projectiles->lastY[i] = to.y;
+        i++;
+    }
+}
+
+void clearProjectileEvents(ProjectileSystem* projectiles) {
+    projectiles->spawnCount = 0;
+    projectiles->hitCount = 0;
+}
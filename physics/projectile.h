@@ -0,0 +1,69 @@
+#ifndef PROJECTILE_H
+#define PROJECTILE_H
+
+#include <box2d/box2d.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../core/game_state.h"
+#include "../network/game_protocol.h"
+
+// Projectiles are not Box2D bodies. Flight is integrated analytically from
+// the spawn state and each tick's path is checked with one ray cast against
+// ship shapes, so thousands of cannonballs cost no solver time.
+#define PROJECTILE_DEFAULT_POOL 4096
+#define PROJECTILE_SPEED 40.0f           // meters/second, added to the shooter's velocity
+#define PROJECTILE_DRAG 0.5f             // Linear drag, 1/s
+#define PROJECTILE_LIFETIME 3.0f         // seconds
+#define PROJECTILE_DAMAGE 10.0f
+#define PROJECTILE_FIRE_COOLDOWN 30      // ticks, 0.5s at 60Hz
+#define PROJECTILE_MUZZLE_OFFSET 1.5f    // Spawn ahead of the shooter's center
+#define PROJECTILE_MAX_RANGE (PROJECTILE_SPEED / PROJECTILE_DRAG)  // Upper bound on flight distance
+
+// Live projectiles, struct-of-arrays and packed in [0, count). Events are
+// collected between snapshot broadcasts and cleared once sent.
+typedef struct {
+    uint32_t* ids;
+    uint32_t* spawnTicks;
+    float* originX;                      // Spawn state, the whole flight derives from it
+    float* originY;
+    float* velocityX;
+    float* velocityY;
+    float* lastX;                        // Position at the end of the previous tick
+    float* lastY;
+    uint32_t* ownerIds;                  // Ship entity id the shot can't hit, 0 for none
+    uint8_t* types;
+    int count;
+    int capacity;                        // Pool size, fixed at init
+    uint32_t nextId;
+
+    GameProjectileSpawn* spawns;         // Since the last broadcast
+    int spawnCount;
+    int spawnCapacity;
+    GameProjectileHit* hits;
+    b2Vec2* hitPositions;                // For area of interest, parallel to hits
+    int hitCount;
+    int hitCapacity;
+} ProjectileSystem;
+
+bool initProjectileSystem(ProjectileSystem* projectiles, int poolSize);
+void cleanupProjectileSystem(ProjectileSystem* projectiles);
+
+// Returns the projectile id, 0 when the pool is full
+uint32_t spawnProjectile(ProjectileSystem* projectiles, uint8_t type, b2Vec2 position, b2Vec2 velocity,
+                         uint32_t ownerId, uint32_t tick);
+
+// Cannonball from a body's muzzle along its facing, inheriting its velocity
+uint32_t fireProjectileFromBody(ProjectileSystem* projectiles, b2BodyId body, uint32_t tick);
+// Same from a pose, for shooters without an enabled body. Shots pass
+// through the owner ship, crew fire over their own rail.
+uint32_t fireProjectileFrom(ProjectileSystem* projectiles, b2Vec2 position, float rotation, b2Vec2 velocity,
+                            uint32_t ownerId, uint32_t tick);
+
+// Advance every projectile to tick and resolve hits, after the physics step
+void stepProjectiles(ProjectileSystem* projectiles, const WorldCells* cells, const EntityStateMirror* mirror,
+                     uint32_t tick, float dt);
+
+void clearProjectileEvents(ProjectileSystem* projectiles);
+
+#endif // PROJECTILE_H
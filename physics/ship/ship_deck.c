@@ -0,0 +1,244 @@
+#include "ship_deck.h"
+#include "ship_shapes.h"
+#include "../player/player_physics.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Walkable half extents in the ship frame - every ship is a sloop for now
+static b2Vec2 deckHalfExtents(void) {
+    b2Vec2 half = getShipPrototype(SHIP_CLASS_SLOOP)->halfExtents;
+    half.x = fmaxf(half.x - DECK_EDGE_MARGIN, 0.0f);
+    half.y = fmaxf(half.y - DECK_EDGE_MARGIN, 0.0f);
+    return half;
+}
+
+static float clampf(float value, float limit) {
+    return value < -limit ? -limit : (value > limit ? limit : value);
+}
+
+static float wrapAngle(float radians) {
+    if (radians > B2_PI) radians -= 2.0f * B2_PI;
+    else if (radians < -B2_PI) radians += 2.0f * B2_PI;
+    return radians;
+}
+
+int resolveDeckShip(DeckPosition* deck, const EntityStateArrays* ships) {
+    if (deck->shipId == 0) return -1;
+
+    int slot = deck->shipSlot;
+    if (slot >= 0 && slot < ships->count && (ships->flags[slot] & ENTITY_STATE_ACTIVE) &&
+        ships->ids[slot] == deck->shipId) {
+        return slot;
+    }
+    // Ships shift down when one is deleted, so the slot is looked up again
+    for (int i = 0; i < ships->count; i++) {
+        if ((ships->flags[i] & ENTITY_STATE_ACTIVE) && ships->ids[i] == deck->shipId) {
+            deck->shipSlot = i;
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool boardShip(DeckPosition* deck, b2BodyId playerBody, const EntityStateArrays* players, int playerSlot,
+               const EntityStateArrays* ships, uint32_t shipId) {
+    if (deck->shipId != 0 || shipId == 0 || !entityStateSlotMatches(players, playerSlot, playerBody)) return false;
+
+    DeckPosition next = {.shipId = shipId, .shipSlot = -1};
+    int ship = resolveDeckShip(&next, ships);
+    if (ship < 0) return false;
+
+    float dx = players->x[playerSlot] - ships->x[ship];
+    float dy = players->y[playerSlot] - ships->y[ship];
+    if (dx * dx + dy * dy > DECK_BOARD_RANGE * DECK_BOARD_RANGE) return false;
+
+    // Into the ship frame, then onto the deck
+    float c = cosf(ships->rot[ship]);
+    float s = sinf(ships->rot[ship]);
+    b2Vec2 half = deckHalfExtents();
+    next.x = clampf(c * dx + s * dy, half.x);
+    next.y = clampf(-s * dx + c * dy, half.y);
+    next.rotation = wrapAngle(players->rot[playerSlot] - ships->rot[ship]);
+    *deck = next;
+
+    b2Body_SetLinearVelocity(playerBody, (b2Vec2){0.0f, 0.0f});
+    b2Body_SetAngularVelocity(playerBody, 0.0f);
+    b2Body_Disable(playerBody);
+    return true;
+}
+
+b2BodyId leaveShip(DeckPosition* deck, b2BodyId playerBody, WorldCells* cells, const EntityStateArrays* players,
+                   int playerSlot) {
+    if (deck->shipId == 0) return playerBody;
+    *deck = (DeckPosition){.shipSlot = -1};
+
+    // The disabled body is still in the cell it boarded in, which the ship
+    // may have left long ago - a fresh body lands in the right cell
+    void* tag = b2Body_IsValid(playerBody) ? b2Body_GetUserData(playerBody) : NULL;
+    if (!entityStateSlotMatches(players, playerSlot, playerBody)) {
+        if (b2Body_IsValid(playerBody)) b2Body_Enable(playerBody);
+        return playerBody;
+    }
+    b2Vec2 position = {players->x[playerSlot], players->y[playerSlot]};
+    b2Vec2 local;
+    b2WorldId world = worldCellWorldAt(cells, position, &local);
+    b2BodyId body = b2_nullBodyId;
+    if (b2World_IsValid(world)) body = createPlayerBody(world, local.x, local.y);
+    if (!b2Body_IsValid(body)) {
+        fprintf(stderr, "[Deck] No body for a player leaving a ship, staying where it boarded\n");
+        b2Body_Enable(playerBody);
+        return playerBody;
+    }
+
+    float rotation = players->rot[playerSlot];
+    b2Body_SetTransform(body, local, (b2Rot){cosf(rotation), sinf(rotation)});
+    b2Body_SetLinearVelocity(body, (b2Vec2){players->vx[playerSlot], players->vy[playerSlot]});
+    b2Body_SetUserData(body, tag);
+    b2DestroyBody(playerBody);
+    return body;
+}
+
+bool reserveDeckCrewBatch(DeckCrewBatch* batch, int count) {
+    if (batch->capacity >= count) return true;
+
+    int new_capacity = batch->capacity ? batch->capacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    DeckPosition** decks = realloc(batch->decks, new_capacity * sizeof(DeckPosition*));
+    if (decks) batch->decks = decks;
+    int* playerSlots = realloc(batch->playerSlots, new_capacity * sizeof(int));
+    if (playerSlots) batch->playerSlots = playerSlots;
+    float** columns[] = {
+        &batch->x, &batch->y, &batch->rotation, &batch->along, &batch->lateral, &batch->turn,
+        &batch->shipX, &batch->shipY, &batch->shipRotation, &batch->shipVx, &batch->shipVy, &batch->shipSpin,
+        &batch->globalX, &batch->globalY, &batch->globalRotation, &batch->globalVx, &batch->globalVy
+    };
+    bool ok = decks && playerSlots;
+    for (size_t i = 0; i < sizeof(columns) / sizeof(columns[0]); i++) {
+        float* column = realloc(*columns[i], new_capacity * sizeof(float));
+        if (column) *columns[i] = column;
+        else ok = false;
+    }
+
+    if (!ok) {
+        fprintf(stderr, "[Deck] Failed to grow crew batch to %d\n", new_capacity);
+        return false;
+    }
+    batch->capacity = new_capacity;
+    return true;
+}
+
+void freeDeckCrewBatch(DeckCrewBatch* batch) {
+    if (!batch) return;
+    free(batch->decks);
+    free(batch->playerSlots);
+    float* columns[] = {
+        batch->x, batch->y, batch->rotation, batch->along, batch->lateral, batch->turn,
+        batch->shipX, batch->shipY, batch->shipRotation, batch->shipVx, batch->shipVy, batch->shipSpin,
+        batch->globalX, batch->globalY, batch->globalRotation, batch->globalVx, batch->globalVy
+    };
+    for (size_t i = 0; i < sizeof(columns) / sizeof(columns[0]); i++) free(columns[i]);
+    memset(batch, 0, sizeof(DeckCrewBatch));
+}
+
+// Same key meanings as on foot: forward with a turn key strafes
+static void deckInputSpeeds(uint16_t inputFlags, float* along, float* lateral, float* turn) {
+    *along = 0.0f;
+    *lateral = 0.0f;
+    *turn = 0.0f;
+
+    if ((inputFlags & INPUT_STRAFE_LEFT) == INPUT_STRAFE_LEFT) {
+        *along = PLAYER_STRAFE_FACTOR * DECK_WALK_SPEED;
+        *lateral = -PLAYER_STRAFE_FACTOR * DECK_WALK_SPEED;
+    } else if ((inputFlags & INPUT_STRAFE_RIGHT) == INPUT_STRAFE_RIGHT) {
+        *along = PLAYER_STRAFE_FACTOR * DECK_WALK_SPEED;
+        *lateral = PLAYER_STRAFE_FACTOR * DECK_WALK_SPEED;
+    } else {
+        if (inputFlags & INPUT_FORWARD) *along += DECK_WALK_SPEED;
+        if (inputFlags & INPUT_BACKWARD) *along -= DECK_WALK_SPEED * DECK_BACKWARD_FACTOR;
+        if (inputFlags & INPUT_LEFT) *turn -= DECK_TURN_RATE;
+        if (inputFlags & INPUT_RIGHT) *turn += DECK_TURN_RATE;
+    }
+}
+
+// The caller resolves the ship first, the batch only reads its mirror slot
+void addDeckCrew(DeckCrewBatch* batch, DeckPosition* deck, int playerSlot, uint16_t inputFlags,
+                 const EntityStateArrays* ships, b2BodyId shipBody) {
+    if (batch->count >= batch->capacity && !reserveDeckCrewBatch(batch, batch->count + 1)) return;
+
+    int i = batch->count++;
+    int ship = deck->shipSlot;
+    batch->decks[i] = deck;
+    batch->playerSlots[i] = playerSlot;
+    batch->x[i] = deck->x;
+    batch->y[i] = deck->y;
+    batch->rotation[i] = deck->rotation;
+    deckInputSpeeds(inputFlags, &batch->along[i], &batch->lateral[i], &batch->turn[i]);
+    batch->shipX[i] = ships->x[ship];
+    batch->shipY[i] = ships->y[ship];
+    batch->shipRotation[i] = ships->rot[ship];
+    batch->shipVx[i] = ships->vx[ship];
+    batch->shipVy[i] = ships->vy[ship];
+    batch->shipSpin[i] = b2Body_IsEnabled(shipBody) ? b2Body_GetAngularVelocity(shipBody) : 0.0f;
+}
+
+// Plain float loops, no Box2D calls
+void stepDeckCrewBatch(DeckCrewBatch* batch, float dt) {
+    b2Vec2 half = deckHalfExtents();
+
+    for (int i = 0; i < batch->count; i++) {
+        float rotation = wrapAngle(batch->rotation[i] + batch->turn[i] * dt);
+        float c = cosf(rotation);
+        float s = sinf(rotation);
+        float vx = c * batch->along[i] - s * batch->lateral[i];
+        float vy = s * batch->along[i] + c * batch->lateral[i];
+        float x = clampf(batch->x[i] + vx * dt, half.x);
+        float y = clampf(batch->y[i] + vy * dt, half.y);
+        batch->rotation[i] = rotation;
+
+        // Walking into the rail stops that component of the walk
+        vx = (x - batch->x[i]) / dt;
+        vy = (y - batch->y[i]) / dt;
+        batch->x[i] = x;
+        batch->y[i] = y;
+
+        float sc = cosf(batch->shipRotation[i]);
+        float ss = sinf(batch->shipRotation[i]);
+        float rx = sc * x - ss * y;
+        float ry = ss * x + sc * y;
+        batch->globalX[i] = batch->shipX[i] + rx;
+        batch->globalY[i] = batch->shipY[i] + ry;
+        batch->globalRotation[i] = wrapAngle(batch->shipRotation[i] + rotation);
+        // Ship velocity at the crew's point, plus the walk turned into the world frame
+        batch->globalVx[i] = batch->shipVx[i] - batch->shipSpin[i] * ry + sc * vx - ss * vy;
+        batch->globalVy[i] = batch->shipVy[i] + batch->shipSpin[i] * rx + ss * vx + sc * vy;
+    }
+}
+
+void applyDeckCrewBatch(DeckCrewBatch* batch, EntityStateMirror* mirror, uint32_t tick) {
+    EntityStateArrays* players = &mirror->players;
+
+    for (int i = 0; i < batch->count; i++) {
+        DeckPosition* deck = batch->decks[i];
+        deck->x = batch->x[i];
+        deck->y = batch->y[i];
+        deck->rotation = batch->rotation[i];
+
+        int slot = batch->playerSlots[i];
+        if (!(players->flags[slot] & ENTITY_STATE_ON_DECK)) mirror->membershipTick = tick;
+        if (players->x[slot] == batch->globalX[i] && players->y[slot] == batch->globalY[i] &&
+            players->rot[slot] == batch->globalRotation[i] && players->vx[slot] == batch->globalVx[i] &&
+            players->vy[slot] == batch->globalVy[i] && (players->flags[slot] & ENTITY_STATE_ON_DECK)) {
+            continue;
+        }
+        players->x[slot] = batch->globalX[i];
+        players->y[slot] = batch->globalY[i];
+        players->rot[slot] = batch->globalRotation[i];
+        players->vx[slot] = batch->globalVx[i];
+        players->vy[slot] = batch->globalVy[i];
+        players->flags[slot] = ENTITY_STATE_ACTIVE | ENTITY_STATE_ON_DECK;
+        markEntityStateDirty(players, slot, tick);
+    }
+}
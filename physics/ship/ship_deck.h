@@ -0,0 +1,85 @@
+#ifndef SHIP_DECK_H
+#define SHIP_DECK_H
+
+#include <box2d/box2d.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../../core/game_state.h"
+#include "../../world/world_cells.h"
+
+// Crew aboard a ship leave the Box2D world: their body is disabled and they
+// walk in the ship's frame under a kinematic deck model - inputs move them
+// at a fixed speed, the deck outline clamps them, and the ship's transform
+// carries them. No joints, no contacts, no correction against a moving hull.
+// The global state each tick is derived from the ship's mirrored state and
+// written into the player's mirror slot, so AOI, dormancy and state hashes
+// see crew where they are. Leaving the deck recreates the body at the
+// player's global position, in whichever cell the ship has reached.
+#define DECK_WALK_SPEED 4.0f              // meters/second along facing
+#define DECK_BACKWARD_FACTOR 0.5f
+#define DECK_TURN_RATE 3.0f               // radians/second
+#define DECK_BOARD_RANGE 6.0f             // From the ship's center, to board
+#define DECK_EDGE_MARGIN 0.2f             // Crew stay this far inside the hull outline
+
+// Crew replication - offsets from the ship's center in its frame
+#define DECK_OFFSET_SCALE 256.0f          // Wire units per meter, int16 covers +-128m
+#define DECK_ROTATION_BITS 8
+
+typedef struct {
+    uint32_t shipId;                      // Ship entity id, 0 on foot
+    int shipSlot;                         // Cached mirror slot, checked against shipId before use
+    float x;                              // Ship frame
+    float y;
+    float rotation;                       // Relative to the ship's heading
+} DeckPosition;
+
+// One tick of deck movement for every crew member, struct-of-arrays like
+// PlayerMovementBatch. Fill with addDeckCrew, then step and apply once.
+typedef struct {
+    DeckPosition** decks;                 // Written back by applyDeckCrewBatch
+    int* playerSlots;                     // Mirror slot of each crew member
+    float* x;                             // Ship frame, stepped in place
+    float* y;
+    float* rotation;
+    float* along;                         // Speed along facing, from the input flags
+    float* lateral;                       // Speed along the right vector
+    float* turn;                          // radians/second
+    float* shipX;                         // Ship's mirrored state
+    float* shipY;
+    float* shipRotation;
+    float* shipVx;
+    float* shipVy;
+    float* shipSpin;                      // Angular velocity, for the crew's carried velocity
+    float* globalX;                       // Kernel output
+    float* globalY;
+    float* globalRotation;
+    float* globalVx;
+    float* globalVy;
+    int count;
+    int capacity;
+} DeckCrewBatch;
+
+// Mirror slot of the deck's ship, -1 once the ship is gone
+int resolveDeckShip(DeckPosition* deck, const EntityStateArrays* ships);
+
+// Board the ship with entity id shipId from the player's mirrored pose.
+// Disables the body on success; false when out of range or unknown.
+bool boardShip(DeckPosition* deck, b2BodyId playerBody, const EntityStateArrays* players, int playerSlot,
+               const EntityStateArrays* ships, uint32_t shipId);
+
+// Back into the world at the player's mirrored global pose, which the deck
+// pass keeps current. Returns the new body, the old one is destroyed.
+b2BodyId leaveShip(DeckPosition* deck, b2BodyId playerBody, WorldCells* cells, const EntityStateArrays* players,
+                   int playerSlot);
+
+bool reserveDeckCrewBatch(DeckCrewBatch* batch, int count);
+void freeDeckCrewBatch(DeckCrewBatch* batch);
+void addDeckCrew(DeckCrewBatch* batch, DeckPosition* deck, int playerSlot, uint16_t inputFlags,
+                 const EntityStateArrays* ships, b2BodyId shipBody);
+void stepDeckCrewBatch(DeckCrewBatch* batch, float dt);
+// Deck positions back to their owners and global state into the mirror.
+// Crew that just boarded change the mirror's membership.
+void applyDeckCrewBatch(DeckCrewBatch* batch, EntityStateMirror* mirror, uint32_t tick);
+
+#endif // SHIP_DECK_H
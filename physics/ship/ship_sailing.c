@@ -0,0 +1,122 @@
+#include "ship_sailing.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool reserveSailingBatch(SailingBatch* batch, int count) {
+    if (batch->capacity >= count) return true;
+
+    int new_capacity = batch->capacity ? batch->capacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    b2BodyId* bodies = realloc(batch->bodies, new_capacity * sizeof(b2BodyId));
+    if (bodies) batch->bodies = bodies;
+    float** columns[] = {
+        &batch->mass, &batch->x, &batch->y, &batch->cos, &batch->sin, &batch->vx, &batch->vy,
+        &batch->windX, &batch->windY, &batch->currentX, &batch->currentY, &batch->forceX, &batch->forceY
+    };
+    bool ok = bodies != NULL;
+    for (size_t i = 0; i < sizeof(columns) / sizeof(columns[0]); i++) {
+        float* column = realloc(*columns[i], new_capacity * sizeof(float));
+        if (column) *columns[i] = column;
+        else ok = false;
+    }
+
+    if (!ok) {
+        fprintf(stderr, "[Sailing] Failed to grow sailing batch to %d\n", new_capacity);
+        return false;
+    }
+    batch->capacity = new_capacity;
+    return true;
+}
+
+void freeSailingBatch(SailingBatch* batch) {
+    if (!batch) return;
+    free(batch->bodies);
+    float* columns[] = {
+        batch->mass, batch->x, batch->y, batch->cos, batch->sin, batch->vx, batch->vy,
+        batch->windX, batch->windY, batch->currentX, batch->currentY, batch->forceX, batch->forceY
+    };
+    for (size_t i = 0; i < sizeof(columns) / sizeof(columns[0]); i++) free(columns[i]);
+    memset(batch, 0, sizeof(SailingBatch));
+}
+
+void collectSailingShips(SailingBatch* batch, const ShipArray* ships, const EntityStateArrays* mirrored,
+                         const WindField* field) {
+    batch->count = 0;
+    int count = ships->count < mirrored->count ? ships->count : mirrored->count;
+    if (!reserveSailingBatch(batch, count)) return;
+
+    for (int i = 0; i < count; i++) {
+        if (!(ships->ships[i].flags & SHIP_FLAG_SAILING) || !(mirrored->flags[i] & ENTITY_STATE_ACTIVE)) continue;
+        // Dormant ships wake from their flag change first, see syncEntityMirror
+        if (!b2Body_IsEnabled(mirrored->bodies[i])) continue;
+
+        // The mirror keeps radians, the body has the cos/sin pair the kernel wants
+        int n = batch->count++;
+        b2Rot rot = b2Body_GetRotation(mirrored->bodies[i]);
+        batch->bodies[n] = mirrored->bodies[i];
+        batch->mass[n] = b2Body_GetMass(mirrored->bodies[i]);
+        batch->x[n] = mirrored->x[i];
+        batch->y[n] = mirrored->y[i];
+        batch->cos[n] = rot.c;
+        batch->sin[n] = rot.s;
+        batch->vx[n] = mirrored->vx[i];
+        batch->vy[n] = mirrored->vy[i];
+
+        b2Vec2 wind, current;
+        sampleWindField(field, mirrored->x[i], mirrored->y[i], &wind, &current);
+        batch->windX[n] = wind.x;
+        batch->windY[n] = wind.y;
+        batch->currentX[n] = current.x;
+        batch->currentY[n] = current.y;
+    }
+}
+
+// Branch-free over plain arrays so the compiler can vectorize it. The
+// builtin square root stays inline with -fno-math-errno, set on this file.
+// restrict on parameters rather than locals - gcc only trusts it there, and
+// eleven streams is too many to check for overlap at run time.
+static void sailingKernel(int count, const float* restrict c, const float* restrict s,
+                          const float* restrict mass, const float* restrict vx, const float* restrict vy,
+                          const float* restrict windX, const float* restrict windY,
+                          const float* restrict currentX, const float* restrict currentY,
+                          float* restrict fx, float* restrict fy) {
+    for (int i = 0; i < count; i++) {
+        // Apparent wind in the hull frame
+        float awx = windX[i] - vx[i];
+        float awy = windY[i] - vy[i];
+        float aw = __builtin_sqrtf(awx * awx + awy * awy);
+        float awAlong = awx * c[i] + awy * s[i];
+        float awAcross = -awx * s[i] + awy * c[i];
+        float efficiency = (awAlong / (aw + 1e-6f) + SAIL_NO_GO) / (1.0f + SAIL_NO_GO);
+        // Selects, not fminf/fmaxf - their NaN rules keep gcc from vectorizing
+        efficiency = efficiency < 0.0f ? 0.0f : efficiency;
+        efficiency = efficiency > 1.0f ? 1.0f : efficiency;
+        float drive = SAIL_DRIVE * aw * aw * efficiency;
+        float leeway = SAIL_LEEWAY * SAIL_DRIVE * aw * awAcross;
+
+        // Velocity through the water
+        float wx = vx[i] - currentX[i];
+        float wy = vy[i] - currentY[i];
+        float along = wx * c[i] + wy * s[i];
+        float across = -wx * s[i] + wy * c[i];
+
+        float accelAlong = drive - KEEL_DRAG_ALONG * fabsf(along) * along;
+        float accelAcross = leeway - KEEL_DRAG_ACROSS * fabsf(across) * across;
+        fx[i] = mass[i] * (c[i] * accelAlong - s[i] * accelAcross);
+        fy[i] = mass[i] * (s[i] * accelAlong + c[i] * accelAcross);
+    }
+}
+
+void computeSailingForces(SailingBatch* batch) {
+    sailingKernel(batch->count, batch->cos, batch->sin, batch->mass, batch->vx, batch->vy, batch->windX,
+                  batch->windY, batch->currentX, batch->currentY, batch->forceX, batch->forceY);
+}
+
+void applySailingForces(const SailingBatch* batch) {
+    for (int i = 0; i < batch->count; i++) {
+        b2Body_ApplyForceToCenter(batch->bodies[i], (b2Vec2){batch->forceX[i], batch->forceY[i]}, true);
+    }
+}
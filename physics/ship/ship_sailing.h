@@ -0,0 +1,57 @@
+#ifndef SHIP_SAILING_H
+#define SHIP_SAILING_H
+
+#include <box2d/box2d.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../../core/game_state.h"
+#include "../../world/wind_field.h"
+
+// Sail and keel forces for every ship under sail, struct-of-arrays like
+// DeckCrewBatch. Ships read their state from the entity mirror, so the
+// only Box2D calls are a mass and rotation lookup and one force per
+// sailing ship.
+// Anchored ships are left alone and can sleep and go dormant as before;
+// ships under sail keep themselves awake.
+//
+// Accelerations are per unit mass, so every hull handles the same:
+// the sail drives along the heading with the square of the apparent wind
+// when it comes from far enough aft, the keel resists motion through the
+// water, hard sideways and lightly along the hull. Body damping still applies.
+#define SAIL_DRIVE 0.08f                  // 1/meter, times apparent wind squared
+#define SAIL_NO_GO 0.5f                   // Cosine offset, no drive within 60 degrees of the wind
+#define SAIL_LEEWAY 0.15f                 // Sideways push, fraction of the drive coefficient
+#define KEEL_DRAG_ALONG 0.02f             // 1/meter, times speed through the water squared
+#define KEEL_DRAG_ACROSS 1.5f
+
+typedef struct {
+    b2BodyId* bodies;
+    float* mass;
+    float* x;                             // Mirrored state
+    float* y;
+    float* cos;                           // Body rotation, straight from b2Rot
+    float* sin;
+    float* vx;
+    float* vy;
+    float* windX;                         // Sampled at the ship
+    float* windY;
+    float* currentX;
+    float* currentY;
+    float* forceX;                        // Kernel output, Newtons
+    float* forceY;
+    int count;
+    int capacity;
+} SailingBatch;
+
+bool reserveSailingBatch(SailingBatch* batch, int count);
+void freeSailingBatch(SailingBatch* batch);
+
+// Gather every enabled ship with SHIP_FLAG_SAILING and sample the field
+void collectSailingShips(SailingBatch* batch, const ShipArray* ships, const EntityStateArrays* mirrored,
+                         const WindField* field);
+// Branch-free float loop, no Box2D calls
+void computeSailingForces(SailingBatch* batch);
+void applySailingForces(const SailingBatch* batch);
+
+#endif // SHIP_SAILING_H
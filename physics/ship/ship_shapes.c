@@ -3,6 +3,7 @@
 #include <raylib.h>
 #include "game_state.h"
 #include "coord_utils.h"
+#include "../collision_layers.h"
 #include <stdlib.h>
 
 #define CURVE_SEGMENTS 20
@@ -227,7 +228,37 @@ bool validateHull(const b2Hull* hull) {
     return true;
 }
 
-b2Hull createShipHullShape(void) {
+// Per-class parameters. Geometry derived from these is built once by
+// initShipPrototypes, so spawning does no shape work.
+typedef struct {
+    const char* name;
+    float length;           // meters
+    float width;
+    float density;
+    float friction;
+    float restitution;
+    float linearDamping;
+    float angularDamping;
+} ShipClassDef;
+
+static const ShipClassDef shipClassDefs[SHIP_CLASS_COUNT] = {
+    [SHIP_CLASS_SLOOP] = {
+        .name = "sloop",
+        .length = PHYSICS_SHIP_LENGTH,
+        .width = PHYSICS_SHIP_WIDTH,
+        .density = 1.0f,
+        .friction = 0.3f,
+        .restitution = 0.2f,
+        .linearDamping = 0.5f,     // Increased damping for more stable movement
+        .angularDamping = 0.7f     // Increased angular damping
+    },
+};
+
+static ShipPrototype shipPrototypes[SHIP_CLASS_COUNT];
+static bool shipPrototypesReady = false;
+
+// Outline hull - the validation logging runs once here instead of per call
+static b2Hull buildShipHull(void) {
     // Use PHYSICS_SCALE_FACTOR instead of SHIP_SCALE
     const float BOW_LENGTH = 4.0f;   // Base length
     const float BEAM_WIDTH = 2.0f;   // Base width
@@ -249,19 +280,12 @@ b2Hull createShipHullShape(void) {
     hull.points[6] = (b2Vec2){ BOW_LENGTH * 0.5f * PHYSICS_SCALE_FACTOR, -BEAM_WIDTH * 0.5f * PHYSICS_SCALE_FACTOR};
     hull.points[7] = (b2Vec2){ BOW_LENGTH * PHYSICS_SCALE_FACTOR,  0.0f};             // Back to bow
 
-    // Log hull points
-    for (int i = 0; i < hull.count; i++) {
-        logDebug("Hull point %d: (%.2f, %.2f)", i, hull.points[i].x, hull.points[i].y);
-        
-        // Verify distance between consecutive points
-        if (i > 0) {
-            float dx = hull.points[i].x - hull.points[i-1].x;
-            float dy = hull.points[i].y - hull.points[i-1].y;
-            float dist = sqrtf(dx*dx + dy*dy);
-            logDebug("Distance to previous point: %.3f meters", dist);
-            if (dist < MIN_VERTEX_DISTANCE) {
-                logDebug("WARNING: Vertices too close together at point %d", i);
-            }
+    // Warn about degenerate edges
+    for (int i = 1; i < hull.count; i++) {
+        float dx = hull.points[i].x - hull.points[i-1].x;
+        float dy = hull.points[i].y - hull.points[i-1].y;
+        if (sqrtf(dx*dx + dy*dy) < MIN_VERTEX_DISTANCE) {
+            logDebug("WARNING: Vertices too close together at point %d", i);
         }
     }
 
@@ -278,21 +302,64 @@ b2Hull createShipHullShape(void) {
     return hull;
 }
 
-b2BodyId createShipHull(b2WorldId worldId, float x, float y, b2Rot rotation) {
-    logDebug("Creating ship at position (%.2f, %.2f)", x, y);
+bool initShipPrototypes(void) {
+    if (shipPrototypesReady) return true;
+
+    b2Hull hull = buildShipHull();
+    for (int i = 0; i < SHIP_CLASS_COUNT; i++) {
+        const ShipClassDef* def = &shipClassDefs[i];
+        ShipPrototype* proto = &shipPrototypes[i];
+
+        proto->name = def->name;
+        proto->hull = hull;
+        proto->halfExtents = (b2Vec2){def->length * 0.5f, def->width * 0.5f};
+        proto->polygon = b2MakeBox(proto->halfExtents.x, proto->halfExtents.y);
+
+        proto->bodyDef = b2DefaultBodyDef();
+        proto->bodyDef.type = b2_dynamicBody;
+        proto->bodyDef.linearDamping = def->linearDamping;
+        proto->bodyDef.angularDamping = def->angularDamping;
+        proto->bodyDef.gravityScale = 0.0f;      // No gravity effect
+
+        proto->shapeDef = b2DefaultShapeDef();
+        proto->shapeDef.density = def->density;
+        proto->shapeDef.friction = def->friction;
+        proto->shapeDef.restitution = def->restitution;
+
+        logDebug("Ship class %s: %.2f x %.2f m", def->name, def->length, def->width);
+    }
+
+    shipPrototypesReady = true;
+    return true;
+}
+
+const ShipPrototype* getShipPrototype(ShipClass shipClass) {
+    if (shipClass < 0 || shipClass >= SHIP_CLASS_COUNT) return NULL;
+    if (!shipPrototypesReady) initShipPrototypes();
+    return &shipPrototypes[shipClass];
+}
+
+b2Hull createShipHullShape(void) {
+    return getShipPrototype(SHIP_CLASS_SLOOP)->hull;
+}
+
+// Spawning only copies the prototype's defs - no geometry work or logging
+// on success, so mass spawns stay cheap
+b2BodyId createShipOfClass(b2WorldId worldId, ShipClass shipClass, float x, float y, b2Rot rotation) {
+    const ShipPrototype* proto = getShipPrototype(shipClass);
+    if (!proto) {
+        logDebug("Unknown ship class %d", (int)shipClass);
+        return b2_nullBodyId;
+    }
     
     if (!b2World_IsValid(worldId)) {
         logDebug("Invalid world ID");
         return b2_nullBodyId;
     }
     
-    b2BodyDef bodyDef = b2DefaultBodyDef();
-    bodyDef.type = b2_dynamicBody;
+    b2BodyDef bodyDef = proto->bodyDef;
     bodyDef.position = (b2Vec2){x, y};
-    bodyDef.rotation = (b2Rot){1.0f, 0.0f};  // cos(0)=1, sin(0)=0
-    bodyDef.linearDamping = 0.5f;     // Increased damping for more stable movement
-    bodyDef.angularDamping = 0.7f;    // Increased angular damping
-    bodyDef.gravityScale = 0.0f;      // No gravity effect
+    bodyDef.rotation = rotation;
     
     b2BodyId bodyId = b2CreateBody(worldId, &bodyDef);
     if (!b2Body_IsValid(bodyId)) {
@@ -300,21 +367,19 @@ b2BodyId createShipHull(b2WorldId worldId, float x, float y, b2Rot rotation) {
         return b2_nullBodyId;
     }
     
-    // Create a simple rectangular box for physics using b2MakeBox
-    b2Polygon box = b2MakeBox(PHYSICS_SHIP_LENGTH * 0.5f, PHYSICS_SHIP_WIDTH * 0.5f);
-    
-    b2ShapeDef shapeDef = b2DefaultShapeDef();
-    shapeDef.density = 1.0f;
-    shapeDef.friction = 0.3f;
-    shapeDef.restitution = 0.2f;
-    
-    b2ShapeId shapeId = b2CreatePolygonShape(bodyId, &shapeDef, &box);
+    // The layer matrix can be configured after the prototypes are built
+    b2ShapeDef shapeDef = proto->shapeDef;
+    shapeDef.filter = collisionFilterFor(COLLISION_LAYER_SHIP);
+    b2ShapeId shapeId = b2CreatePolygonShape(bodyId, &shapeDef, &proto->polygon);
     if (!b2Shape_IsValid(shapeId)) {
         logDebug("Failed to create polygon shape");
         b2DestroyBody(bodyId);
         return b2_nullBodyId;
     }
     
-    logDebug("Successfully created ship body: %d", bodyId);
     return bodyId;
 }
+
+b2BodyId createShipHull(b2WorldId worldId, float x, float y, b2Rot rotation) {
+    return createShipOfClass(worldId, SHIP_CLASS_SLOOP, x, y, rotation);
+}
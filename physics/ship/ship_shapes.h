@@ -12,8 +12,28 @@ struct GameServer;
 Vector2 TransformPoint(Vector2 p, float angle, float zoom, Vector2 center);
 Vector2 QuadraticBezier(Vector2 p0, Vector2 p1, Vector2 p2, float t);
 
+// Ship classes - each has a prototype built once at startup
+typedef enum {
+    SHIP_CLASS_SLOOP = 0,
+    SHIP_CLASS_COUNT
+} ShipClass;
+
+// Precomputed, validated geometry and defs for one ship class
+typedef struct {
+    const char* name;
+    b2Hull hull;            // Outline, validated once
+    b2Polygon polygon;      // Collision box
+    b2Vec2 halfExtents;
+    b2BodyDef bodyDef;      // Position and rotation filled per spawn
+    b2ShapeDef shapeDef;
+} ShipPrototype;
+
+bool initShipPrototypes(void);
+const ShipPrototype* getShipPrototype(ShipClass shipClass);
+
 // Box2D shape creation functions
 b2Hull createShipHullShape(void);
+b2BodyId createShipOfClass(b2WorldId worldId, ShipClass shipClass, float x, float y, b2Rot rotation);
 b2BodyId createShipHull(b2WorldId worldId, float x, float y, b2Rot rotation);
 
 // Visual rendering functions
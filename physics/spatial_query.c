@@ -0,0 +1,404 @@
+#include "spatial_query.h"
+#include "../core/game_state.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#define SPATIAL_QUERY_PENDING -1          // Memo/result first while a batch run is resolving it
+
+typedef struct {
+    SpatialQueryService* service;
+    const SpatialQuery* query;
+    int first;
+} SpatialQueryCollector;
+
+bool initSpatialQueryService(SpatialQueryService* service, const WorldCells* cells) {
+    memset(service, 0, sizeof(SpatialQueryService));
+    service->cells = cells;
+    service->generation = 1;
+    service->memo = calloc(SPATIAL_QUERY_MEMO_SLOTS, sizeof(SpatialQueryMemo));
+    if (!service->memo) {
+        fprintf(stderr, "[SpatialQuery] Failed to allocate the query memo\n");
+        return false;
+    }
+    return true;
+}
+
+void cleanupSpatialQueryService(SpatialQueryService* service) {
+    free(service->hits);
+    free(service->memo);
+    free(service->batch);
+    free(service->batchResults);
+    free(service->batchKeys);
+    free(service->candidates);
+    free(service->candidateBounds);
+    memset(service, 0, sizeof(SpatialQueryService));
+}
+
+void beginSpatialQueryTick(SpatialQueryService* service, uint32_t tick) {
+    service->tick = tick;
+    service->generation++;
+    if (service->generation == 0) {
+        // Wrapped - stale entries could match again, clear them for real
+        memset(service->memo, 0, SPATIAL_QUERY_MEMO_SLOTS * sizeof(SpatialQueryMemo));
+        service->generation = 1;
+    }
+    service->hitCount = 0;
+    service->batchCount = 0;
+    service->batchResolved = 0;
+    service->queryCount = 0;
+    service->memoHits = 0;
+    service->overlapCalls = 0;
+}
+
+static bool reserveHits(SpatialQueryService* service, int count) {
+    if (service->hitCapacity >= count) return true;
+
+    int new_capacity = service->hitCapacity ? service->hitCapacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    SpatialQueryHit* hits = realloc(service->hits, new_capacity * sizeof(SpatialQueryHit));
+    if (!hits) {
+        fprintf(stderr, "[SpatialQuery] Failed to grow the hit arena to %d\n", new_capacity);
+        return false;
+    }
+    service->hits = hits;
+    service->hitCapacity = new_capacity;
+    return true;
+}
+
+static bool reserveBatch(SpatialQueryService* service, int count) {
+    if (service->batchCapacity >= count) return true;
+
+    int new_capacity = service->batchCapacity ? service->batchCapacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    SpatialQuery* batch = realloc(service->batch, new_capacity * sizeof(SpatialQuery));
+    if (batch) service->batch = batch;
+    SpatialQueryResult* results = realloc(service->batchResults, new_capacity * sizeof(SpatialQueryResult));
+    if (results) service->batchResults = results;
+    SpatialQueryBatchKey* keys = realloc(service->batchKeys, new_capacity * sizeof(SpatialQueryBatchKey));
+    if (keys) service->batchKeys = keys;
+
+    if (!batch || !results || !keys) {
+        fprintf(stderr, "[SpatialQuery] Failed to grow the query batch to %d\n", new_capacity);
+        return false;
+    }
+    service->batchCapacity = new_capacity;
+    return true;
+}
+
+static bool reserveCandidates(SpatialQueryService* service, int count) {
+    if (service->candidateCapacity >= count) return true;
+
+    int new_capacity = service->candidateCapacity ? service->candidateCapacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    SpatialQueryHit* candidates = realloc(service->candidates, new_capacity * sizeof(SpatialQueryHit));
+    if (candidates) service->candidates = candidates;
+    b2AABB* bounds = realloc(service->candidateBounds, new_capacity * sizeof(b2AABB));
+    if (bounds) service->candidateBounds = bounds;
+
+    if (!candidates || !bounds) {
+        fprintf(stderr, "[SpatialQuery] Failed to grow merged candidates to %d\n", new_capacity);
+        return false;
+    }
+    service->candidateCapacity = new_capacity;
+    return true;
+}
+
+static inline bool boxesOverlap(b2AABB a, b2AABB b) {
+    return a.lowerBound.x <= b.upperBound.x && b.lowerBound.x <= a.upperBound.x &&
+           a.lowerBound.y <= b.upperBound.y && b.lowerBound.y <= a.upperBound.y;
+}
+
+// At least a square meter, so point queries still weigh something when merging
+static inline float boxArea(b2AABB box) {
+    return fmaxf((box.upperBound.x - box.lowerBound.x) * (box.upperBound.y - box.lowerBound.y), 1.0f);
+}
+
+static inline bool sameFilter(b2QueryFilter a, b2QueryFilter b) {
+    return a.categoryBits == b.categoryBits && a.maskBits == b.maskBits;
+}
+
+static bool sameQuery(const SpatialQuery* a, const SpatialQuery* b) {
+    return a->box.lowerBound.x == b->box.lowerBound.x && a->box.lowerBound.y == b->box.lowerBound.y &&
+           a->box.upperBound.x == b->box.upperBound.x && a->box.upperBound.y == b->box.upperBound.y &&
+           a->center.x == b->center.x && a->center.y == b->center.y && a->radius == b->radius &&
+           sameFilter(a->filter, b->filter);
+}
+
+static uint64_t hashQuery(const SpatialQuery* query) {
+    float fields[7] = {query->box.lowerBound.x, query->box.lowerBound.y, query->box.upperBound.x,
+                       query->box.upperBound.y, query->center.x, query->center.y, query->radius};
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (int i = 0; i < 7; i++) {
+        uint32_t bits;
+        memcpy(&bits, &fields[i], sizeof(bits));
+        h = (h ^ bits) * 0x100000001B3ull;
+    }
+    h = (h ^ (uint64_t)query->filter.categoryBits) * 0x100000001B3ull;
+    h = (h ^ (uint64_t)query->filter.maskBits) * 0x100000001B3ull;
+    return h;
+}
+
+// Entry holding this query this tick, or NULL
+static SpatialQueryMemo* findMemo(SpatialQueryService* service, const SpatialQuery* query, uint64_t hash) {
+    for (int probe = 0; probe < SPATIAL_QUERY_MEMO_PROBES; probe++) {
+        SpatialQueryMemo* memo = &service->memo[(hash + probe) & (SPATIAL_QUERY_MEMO_SLOTS - 1)];
+        if (memo->generation != service->generation) return NULL;
+        if (memo->hash == hash && sameQuery(&memo->query, query)) return memo;
+    }
+    return NULL;
+}
+
+// Probe window full of this tick's queries - the result just isn't memoized
+static void storeMemo(SpatialQueryService* service, const SpatialQuery* query, uint64_t hash,
+                      SpatialQueryResult result) {
+    for (int probe = 0; probe < SPATIAL_QUERY_MEMO_PROBES; probe++) {
+        SpatialQueryMemo* memo = &service->memo[(hash + probe) & (SPATIAL_QUERY_MEMO_SLOTS - 1)];
+        if (memo->generation != service->generation ||
+            (memo->hash == hash && sameQuery(&memo->query, query))) {
+            memo->generation = service->generation;
+            memo->hash = hash;
+            memo->query = *query;
+            memo->result = result;
+            return;
+        }
+    }
+}
+
+static bool alreadyHit(const SpatialQueryService* service, int first, b2BodyId body) {
+    for (int i = first; i < service->hitCount; i++) {
+        if (B2_ID_EQUALS(service->hits[i].body, body)) return true;
+    }
+    return false;
+}
+
+// Shared by both paths, so a batched query returns what a direct one would
+static void addQueryHit(SpatialQueryService* service, const SpatialQuery* query, int first, b2AABB bounds,
+                        const SpatialQueryHit* hit) {
+    if (!boxesOverlap(bounds, query->box)) return;
+    if (query->radius > 0.0f) {
+        float dx = hit->position.x - query->center.x;
+        float dy = hit->position.y - query->center.y;
+        if (dx * dx + dy * dy > query->radius * query->radius) return;
+    }
+    if (alreadyHit(service, first, hit->body) || !reserveHits(service, service->hitCount + 1)) return;
+    service->hits[service->hitCount++] = *hit;
+}
+
+// Global bounds and identity of a tracked shape's body, false for ghost proxies
+static bool describeShape(b2ShapeId shapeId, SpatialQueryHit* hit, b2AABB* bounds) {
+    b2BodyId body = b2Shape_GetBody(shapeId);
+    void* tag = b2Body_GetUserData(body);
+    if (!tag) return false;
+
+    b2Vec2 origin = worldCellOrigin(body);
+    b2Vec2 position = b2Body_GetPosition(body);
+    b2AABB local = b2Shape_GetAABB(shapeId);
+    *bounds = (b2AABB){
+        {local.lowerBound.x + origin.x, local.lowerBound.y + origin.y},
+        {local.upperBound.x + origin.x, local.upperBound.y + origin.y}
+    };
+    *hit = (SpatialQueryHit){
+        .body = body,
+        .position = {position.x + origin.x, position.y + origin.y},
+        .kind = ENTITY_MIRROR_TAG_KIND(tag),
+        .slot = ENTITY_MIRROR_TAG_SLOT(tag)
+    };
+    return true;
+}
+
+static bool collectQueryShape(b2ShapeId shapeId, void* context) {
+    SpatialQueryCollector* collector = context;
+    SpatialQueryHit hit;
+    b2AABB bounds;
+    if (describeShape(shapeId, &hit, &bounds)) {
+        addQueryHit(collector->service, collector->query, collector->first, bounds, &hit);
+    }
+    return true;
+}
+
+static bool collectCandidateShape(b2ShapeId shapeId, void* context) {
+    SpatialQueryService* service = context;
+    SpatialQueryHit hit;
+    b2AABB bounds;
+    if (!describeShape(shapeId, &hit, &bounds) || !reserveCandidates(service, service->candidateCount + 1)) {
+        return true;
+    }
+    service->candidates[service->candidateCount] = hit;
+    service->candidateBounds[service->candidateCount] = bounds;
+    service->candidateCount++;
+    return true;
+}
+
+static SpatialQueryResult resolveQuery(SpatialQueryService* service, const SpatialQuery* query) {
+    SpatialQueryCollector collector = {service, query, service->hitCount};
+    overlapWorldCellsAABB(service->cells, query->box, query->filter, collectQueryShape, &collector);
+    service->overlapCalls++;
+    return (SpatialQueryResult){collector.first, service->hitCount - collector.first};
+}
+
+static SpatialQueryResult runQuery(SpatialQueryService* service, const SpatialQuery* query) {
+    service->queryCount++;
+    uint64_t hash = hashQuery(query);
+    const SpatialQueryMemo* memo = findMemo(service, query, hash);
+    if (memo) {
+        service->memoHits++;
+        return memo->result;
+    }
+
+    SpatialQueryResult result = resolveQuery(service, query);
+    storeMemo(service, query, hash, result);
+    return result;
+}
+
+SpatialQueryResult querySpatialAABB(SpatialQueryService* service, b2AABB box, b2QueryFilter filter) {
+    SpatialQuery query = {.box = box, .filter = filter};
+    return runQuery(service, &query);
+}
+
+SpatialQueryResult querySpatialRadius(SpatialQueryService* service, b2Vec2 center, float radius,
+                                      b2QueryFilter filter) {
+    SpatialQuery query = {
+        .box = {{center.x - radius, center.y - radius}, {center.x + radius, center.y + radius}},
+        .center = center,
+        .radius = radius,
+        .filter = filter
+    };
+    return runQuery(service, &query);
+}
+
+static int queueQuery(SpatialQueryService* service, const SpatialQuery* query) {
+    if (!reserveBatch(service, service->batchCount + 1)) return -1;
+    int handle = service->batchCount++;
+    service->batch[handle] = *query;
+    service->batchResults[handle] = (SpatialQueryResult){0, 0};
+    return handle;
+}
+
+int queueSpatialAABB(SpatialQueryService* service, b2AABB box, b2QueryFilter filter) {
+    SpatialQuery query = {.box = box, .filter = filter};
+    return queueQuery(service, &query);
+}
+
+int queueSpatialRadius(SpatialQueryService* service, b2Vec2 center, float radius, b2QueryFilter filter) {
+    SpatialQuery query = {
+        .box = {{center.x - radius, center.y - radius}, {center.x + radius, center.y + radius}},
+        .center = center,
+        .radius = radius,
+        .filter = filter
+    };
+    return queueQuery(service, &query);
+}
+
+// Batch grouping - same cell and filter, then queue order so runs repeat exactly
+static SpatialQueryBatchKey batchKey(const SpatialQueryService* service, int index) {
+    const SpatialQuery* query = &service->batch[index];
+    float x = (query->box.lowerBound.x + query->box.upperBound.x) * 0.5f;
+    float y = (query->box.lowerBound.y + query->box.upperBound.y) * 0.5f;
+    return (SpatialQueryBatchKey){
+        .cx = (int32_t)floorf(x * service->cells->invCellSize + 0.5f),
+        .cy = (int32_t)floorf(y * service->cells->invCellSize + 0.5f),
+        .categoryBits = (uint64_t)query->filter.categoryBits,
+        .maskBits = (uint64_t)query->filter.maskBits,
+        .index = index
+    };
+}
+
+static inline bool sameGroup(const SpatialQueryBatchKey* a, const SpatialQueryBatchKey* b) {
+    return a->cx == b->cx && a->cy == b->cy && a->categoryBits == b->categoryBits && a->maskBits == b->maskBits;
+}
+
+static int compareBatchKeys(const void* a, const void* b) {
+    const SpatialQueryBatchKey* ka = a;
+    const SpatialQueryBatchKey* kb = b;
+    if (ka->cx != kb->cx) return ka->cx < kb->cx ? -1 : 1;
+    if (ka->cy != kb->cy) return ka->cy < kb->cy ? -1 : 1;
+    if (ka->categoryBits != kb->categoryBits) return ka->categoryBits < kb->categoryBits ? -1 : 1;
+    if (ka->maskBits != kb->maskBits) return ka->maskBits < kb->maskBits ? -1 : 1;
+    return (ka->index > kb->index) - (ka->index < kb->index);
+}
+
+// One broadphase pass over the group's combined box when the queries are
+// close enough, otherwise each query on its own
+static void resolveGroup(SpatialQueryService* service, const SpatialQueryBatchKey* group, int count) {
+    b2AABB combined = service->batch[group[0].index].box;
+    float areaSum = 0.0f;
+    for (int i = 0; i < count; i++) {
+        b2AABB box = service->batch[group[i].index].box;
+        combined.lowerBound.x = fminf(combined.lowerBound.x, box.lowerBound.x);
+        combined.lowerBound.y = fminf(combined.lowerBound.y, box.lowerBound.y);
+        combined.upperBound.x = fmaxf(combined.upperBound.x, box.upperBound.x);
+        combined.upperBound.y = fmaxf(combined.upperBound.y, box.upperBound.y);
+        areaSum += boxArea(box);
+    }
+
+    if (count < 2 || boxArea(combined) > areaSum * SPATIAL_QUERY_MERGE_RATIO) {
+        for (int i = 0; i < count; i++) {
+            service->batchResults[group[i].index] = resolveQuery(service, &service->batch[group[i].index]);
+        }
+        return;
+    }
+
+    service->candidateCount = 0;
+    overlapWorldCellsAABB(service->cells, combined, service->batch[group[0].index].filter, collectCandidateShape,
+                          service);
+    service->overlapCalls++;
+    for (int i = 0; i < count; i++) {
+        const SpatialQuery* query = &service->batch[group[i].index];
+        int first = service->hitCount;
+        for (int c = 0; c < service->candidateCount; c++) {
+            addQueryHit(service, query, first, service->candidateBounds[c], &service->candidates[c]);
+        }
+        service->batchResults[group[i].index] = (SpatialQueryResult){first, service->hitCount - first};
+    }
+}
+
+void runSpatialQueryBatch(SpatialQueryService* service) {
+    int pending = 0;
+    for (int i = service->batchResolved; i < service->batchCount; i++) {
+        const SpatialQuery* query = &service->batch[i];
+        service->queryCount++;
+        uint64_t hash = hashQuery(query);
+        const SpatialQueryMemo* memo = findMemo(service, query, hash);
+        if (memo) {
+            service->memoHits++;
+            // A repeat within this batch points at the query that will resolve it
+            service->batchResults[i] = memo->result;
+            continue;
+        }
+        storeMemo(service, query, hash, (SpatialQueryResult){SPATIAL_QUERY_PENDING, i});
+        service->batchResults[i] = (SpatialQueryResult){SPATIAL_QUERY_PENDING, i};
+        service->batchKeys[pending++] = batchKey(service, i);
+    }
+
+    qsort(service->batchKeys, pending, sizeof(SpatialQueryBatchKey), compareBatchKeys);
+    for (int start = 0; start < pending;) {
+        int end = start + 1;
+        while (end < pending && sameGroup(&service->batchKeys[start], &service->batchKeys[end])) end++;
+        resolveGroup(service, &service->batchKeys[start], end - start);
+        start = end;
+    }
+
+    // Pending entries and repeats take their resolver's result
+    for (int i = service->batchResolved; i < service->batchCount; i++) {
+        SpatialQueryResult result = service->batchResults[i];
+        if (result.first == SPATIAL_QUERY_PENDING) {
+            service->batchResults[i] = service->batchResults[result.count];
+        }
+    }
+    for (int p = 0; p < pending; p++) {
+        int i = service->batchKeys[p].index;
+        const SpatialQuery* query = &service->batch[i];
+        storeMemo(service, query, hashQuery(query), service->batchResults[i]);
+    }
+    service->batchResolved = service->batchCount;
+}
+
+SpatialQueryResult spatialQueryBatchResult(const SpatialQueryService* service, int handle) {
+    if (handle < 0 || handle >= service->batchResolved) return (SpatialQueryResult){0, 0};
+    return service->batchResults[handle];
+}
@@ -0,0 +1,110 @@
+#ifndef SPATIAL_QUERY_H
+#define SPATIAL_QUERY_H
+
+#include <box2d/box2d.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../world/world_cells.h"
+
+// "Who is near X" for gameplay code - boarding range, cannon arcs, harbor
+// zones - answered from the room's world cells. Hits go into an arena that
+// is reset at the start of every tick, and a query repeated within a tick is
+// answered from the first result. Queries can also be queued and run as one
+// batch, where queries close together in a cell share a single broadphase
+// pass over their combined bounds.
+//
+// Hits are bodies, not shapes, with global positions. A body is hit when one
+// of its shapes' bounds overlaps the query box; radius queries also require
+// the body's origin within the radius. Only bodies tagged by the entity
+// mirror are reported, so ghost proxies never show up twice.
+#define SPATIAL_QUERY_MEMO_SLOTS 1024     // Power of two, distinct queries per tick before memoization thins out
+#define SPATIAL_QUERY_MEMO_PROBES 8
+#define SPATIAL_QUERY_MERGE_RATIO 4.0f    // A batch group merges while its combined box is at most this much larger
+
+typedef struct {
+    b2BodyId body;
+    b2Vec2 position;                      // Global
+    uint8_t kind;                         // ENTITY_TYPE_*
+    int slot;                             // Entity mirror slot
+} SpatialQueryHit;
+
+typedef struct {
+    int first;                            // Into the arena, see spatialQueryHits
+    int count;
+} SpatialQueryResult;
+
+typedef struct {
+    b2AABB box;                           // Global bounds
+    b2Vec2 center;                        // Radius queries only
+    float radius;                         // 0 for box queries
+    b2QueryFilter filter;
+} SpatialQuery;
+
+typedef struct {
+    uint64_t hash;
+    uint32_t generation;                  // Valid only while it matches the service's
+    SpatialQuery query;
+    SpatialQueryResult result;
+} SpatialQueryMemo;
+
+typedef struct {
+    int32_t cx;                           // Cell of the query's center
+    int32_t cy;
+    uint64_t categoryBits;
+    uint64_t maskBits;
+    int index;                            // Into the batch
+} SpatialQueryBatchKey;
+
+typedef struct {
+    const WorldCells* cells;
+    uint32_t tick;
+    uint32_t generation;                  // Bumped every tick, expires the memo in O(1)
+
+    SpatialQueryHit* hits;                // Arena
+    int hitCount;
+    int hitCapacity;
+
+    SpatialQueryMemo* memo;               // SPATIAL_QUERY_MEMO_SLOTS entries
+
+    SpatialQuery* batch;                  // Queued since the last run
+    SpatialQueryResult* batchResults;
+    SpatialQueryBatchKey* batchKeys;      // Unresolved queries, sorted into groups
+    int batchCount;
+    int batchResolved;                    // Queued queries before this one have results
+    int batchCapacity;
+
+    SpatialQueryHit* candidates;          // Shapes found by a merged pass
+    b2AABB* candidateBounds;
+    int candidateCount;
+    int candidateCapacity;
+
+    // This tick, for profiling
+    uint32_t queryCount;
+    uint32_t memoHits;
+    uint32_t overlapCalls;
+} SpatialQueryService;
+
+bool initSpatialQueryService(SpatialQueryService* service, const WorldCells* cells);
+void cleanupSpatialQueryService(SpatialQueryService* service);
+
+// Once per tick, after the mirror sync - drops last tick's results
+void beginSpatialQueryTick(SpatialQueryService* service, uint32_t tick);
+
+SpatialQueryResult querySpatialAABB(SpatialQueryService* service, b2AABB box, b2QueryFilter filter);
+SpatialQueryResult querySpatialRadius(SpatialQueryService* service, b2Vec2 center, float radius,
+                                      b2QueryFilter filter);
+
+// Batched - queue, run once, then read each handle's result
+int queueSpatialAABB(SpatialQueryService* service, b2AABB box, b2QueryFilter filter);
+int queueSpatialRadius(SpatialQueryService* service, b2Vec2 center, float radius, b2QueryFilter filter);
+void runSpatialQueryBatch(SpatialQueryService* service);
+SpatialQueryResult spatialQueryBatchResult(const SpatialQueryService* service, int handle);
+
+// Valid until the next query adds hits, the arena can move as it grows
+static inline const SpatialQueryHit* spatialQueryHits(const SpatialQueryService* service,
+                                                      SpatialQueryResult result) {
+    return service->hits + result.first;
+}
+
+#endif // SPATIAL_QUERY_H
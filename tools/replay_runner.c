@@ -0,0 +1,456 @@
+// Re-simulate a room from its input journal - headless, no network, no
+// frame pacing. Each tick runs the same steps as the room, in the same
+// order, so tick times profile the recorded traffic and an optional state
+// hash log can be compared with the live one (or another build's replay).
+//
+//   replay_runner <journal> [--hash-log <path>] [--threads <n>] [--json]
+#include <box2d/box2d.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../core/game_state.h"
+#include "../core/input_journal.h"
+#include "../core/state_hash.h"
+#include "../physics/collision_layers.h"
+#include "../physics/dormancy.h"
+#include "../physics/player/player_physics.h"
+#include "../physics/projectile.h"
+#include "../physics/ship/ship_deck.h"
+#include "../physics/ship/ship_sailing.h"
+#include "../physics/ship/ship_shapes.h"
+#include "../world/wind_field.h"
+#include "../world/world_cells.h"
+
+typedef struct {
+    uint32_t id;
+    b2BodyId body;
+    uint16_t flags;                      // Applied input flags, held until the journal changes them
+    bool suspended;
+    uint32_t nextFireTick;
+    DeckPosition deck;
+} ReplayPlayer;
+
+typedef struct {
+    WorldCells cells;
+    ShipArray ships;
+    ReplayPlayer* players;
+    int playerCount;
+    int playerCapacity;
+    EntityStateMirror mirror;
+    ProjectileSystem projectiles;
+    DormancySystem dormancy;
+    PlayerMovementBatch movement;
+    DeckCrewBatch crew;
+    WindField wind;
+    SailingBatch sailing;
+    uint32_t tick;
+    bool wake;
+} ReplayRoom;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Ship and coordinate helpers log through the server's logDebug - a replay
+// stays quiet, tick times are what it reports
+void logDebug(const char* format, ...) {
+    (void)format;
+}
+
+// Same ship bookkeeping as the server's, entity ids handed out from 1
+void initShipArray(ShipArray* array, int initialCapacity) {
+    array->ships = malloc(initialCapacity * sizeof(Ship));
+    array->capacity = initialCapacity;
+    array->count = 0;
+    array->nextEntityId = 1;
+}
+
+void addShip(ShipArray* array, Ship ship) {
+    if (array->count >= array->capacity) {
+        array->capacity *= 2;
+        array->ships = realloc(array->ships, array->capacity * sizeof(Ship));
+    }
+    if (ship.entity_id == 0) {
+        ship.entity_id = array->nextEntityId++;
+    }
+    if (!(ship.flags & (SHIP_FLAG_ANCHORED | SHIP_FLAG_SAILING))) {
+        ship.flags |= SHIP_FLAG_ANCHORED;
+    }
+    array->ships[array->count++] = ship;
+}
+
+static int findReplayPlayer(const ReplayRoom* room, uint32_t id) {
+    for (int i = 0; i < room->playerCount; i++) {
+        if (room->players[i].id == id) return i;
+    }
+    return -1;
+}
+
+static bool reserveReplayPlayers(ReplayRoom* room, int count) {
+    if (room->playerCapacity >= count) return true;
+
+    int new_capacity = room->playerCapacity ? room->playerCapacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+    ReplayPlayer* players = realloc(room->players, new_capacity * sizeof(ReplayPlayer));
+    if (!players) return false;
+    room->players = players;
+    room->playerCapacity = new_capacity;
+    return true;
+}
+
+// Same lookup as the room's: the tagged slot, or a search when leaves and
+// ship deletes shifted owners since the last slot pass
+static bool onReplayBodyMigrated(void* context, b2BodyId from, b2BodyId to) {
+    ReplayRoom* room = context;
+    void* tag = b2Body_GetUserData(to);
+    int slot = ENTITY_MIRROR_TAG_SLOT(tag);
+
+    switch (ENTITY_MIRROR_TAG_KIND(tag)) {
+        case ENTITY_TYPE_PLAYER:
+            if (slot < 0 || slot >= room->playerCount || !B2_ID_EQUALS(room->players[slot].body, from)) {
+                for (slot = 0; slot < room->playerCount && !B2_ID_EQUALS(room->players[slot].body, from); slot++);
+            }
+            if (slot < room->playerCount) {
+                room->players[slot].body = to;
+                return true;
+            }
+            break;
+        case ENTITY_TYPE_SHIP:
+            if (slot < 0 || slot >= room->ships.count || !B2_ID_EQUALS(room->ships.ships[slot].id, from)) {
+                for (slot = 0; slot < room->ships.count && !B2_ID_EQUALS(room->ships.ships[slot].id, from); slot++);
+            }
+            if (slot < room->ships.count) {
+                room->ships.ships[slot].id = to;
+                return true;
+            }
+            break;
+    }
+    fprintf(stderr, "[Replay] Migrated body has no owner at tick %u, left in its cell\n", room->tick);
+    return false;
+}
+
+static void applyJournalEvent(ReplayRoom* room, const InputJournalEvent* event) {
+    int slot;
+    switch (event->type) {
+        case JOURNAL_PLAYER_JOIN: {
+            if (!reserveReplayPlayers(room, room->playerCount + 1)) {
+                fprintf(stderr, "[Replay] Out of memory for player %u\n", event->id);
+                return;
+            }
+            b2Vec2 spawn;
+            b2WorldId world = worldCellWorldAt(&room->cells, (b2Vec2){0.0f, 0.0f}, &spawn);
+            room->players[room->playerCount++] = (ReplayPlayer){
+                .id = event->id,
+                .body = createPlayerBody(world, spawn.x, spawn.y),
+                .deck = {.shipSlot = -1}
+            };
+            break;
+        }
+        case JOURNAL_PLAYER_LEAVE:
+            slot = findReplayPlayer(room, event->id);
+            if (slot < 0) break;
+            if (b2Body_IsValid(room->players[slot].body)) b2DestroyBody(room->players[slot].body);
+            // Order kept, like the server's in-place compaction
+            memmove(&room->players[slot], &room->players[slot + 1],
+                    (room->playerCount - slot - 1) * sizeof(ReplayPlayer));
+            room->playerCount--;
+            break;
+        case JOURNAL_PLAYER_SUSPEND:
+            slot = findReplayPlayer(room, event->id);
+            if (slot < 0) break;
+            b2Body_SetLinearVelocity(room->players[slot].body, (b2Vec2){0.0f, 0.0f});
+            b2Body_SetAngularVelocity(room->players[slot].body, 0.0f);
+            b2Body_Disable(room->players[slot].body);
+            room->players[slot].flags = 0;
+            room->players[slot].suspended = true;
+            break;
+        case JOURNAL_PLAYER_RESUME:
+            slot = findReplayPlayer(room, event->id);
+            if (slot < 0) break;
+            if (room->players[slot].deck.shipId == 0) b2Body_Enable(room->players[slot].body);
+            room->players[slot].suspended = false;
+            break;
+        case JOURNAL_PLAYER_INPUT:
+            slot = findReplayPlayer(room, event->id);
+            if (slot >= 0) room->players[slot].flags = event->flags;
+            break;
+        case JOURNAL_SHIP_ADD: {
+            b2Vec2 position = {event->x, event->y};
+            b2Vec2 local;
+            b2WorldId world = worldCellWorldAt(&room->cells, position, &local);
+            b2BodyId body = createShipHull(world, local.x, local.y, (b2Rot){1.0f, 0.0f});
+            if (b2Body_IsValid(body)) {
+                addShip(&room->ships, (Ship){.id = body, .physicsPos = position});
+            }
+            break;
+        }
+        case JOURNAL_SHIP_DELETE:
+            if (event->id >= (uint32_t)room->ships.count) break;
+            b2DestroyBody(room->ships.ships[event->id].id);
+            memmove(&room->ships.ships[event->id], &room->ships.ships[event->id + 1],
+                    (room->ships.count - event->id - 1) * sizeof(Ship));
+            room->ships.count--;
+            break;
+        case JOURNAL_SHIP_FLAGS:
+            if (event->id >= (uint32_t)room->ships.count) break;
+            room->ships.ships[event->id].flags = (uint8_t)event->flags;
+            break;
+        case JOURNAL_WAKE_ALL:
+            room->wake = true;
+            break;
+        case JOURNAL_PLAYER_BOARD:
+            slot = findReplayPlayer(room, event->id);
+            if (slot < 0) break;
+            if (!boardShip(&room->players[slot].deck, room->players[slot].body, &room->mirror.players, slot,
+                           &room->mirror.ships, event->target)) {
+                fprintf(stderr, "[Replay] Player %u could not board ship %u at tick %u, replay has diverged\n",
+                        event->id, event->target, room->tick);
+            }
+            break;
+        case JOURNAL_PLAYER_DISEMBARK:
+            slot = findReplayPlayer(room, event->id);
+            if (slot < 0) break;
+            room->players[slot].body = leaveShip(&room->players[slot].deck, room->players[slot].body, &room->cells,
+                                                 &room->mirror.players, slot);
+            break;
+    }
+}
+
+// The room's mirror sync, over replay players
+static void syncReplayMirror(ReplayRoom* room) {
+    EntityStateMirror* mirror = &room->mirror;
+    applyEntityMoveEvents(mirror, &room->cells, room->tick);
+    updateWorldCellBorders(&room->cells);
+
+    if (reserveEntityStateArrays(&mirror->players, room->playerCount)) {
+        for (int i = 0; i < room->playerCount; i++) {
+            const ReplayPlayer* player = &room->players[i];
+            syncPlayerStateSlot(mirror, i, player->body, player->id, player->suspended, player->deck.shipId != 0,
+                                room->tick);
+        }
+        finishPlayerStateSlots(mirror, room->playerCount, room->tick);
+    }
+    syncShipStateSlots(mirror, &room->ships, room->tick);
+}
+
+// Crew fire from their mirrored deck pose, like the server's
+static uint32_t fireReplayPlayer(ReplayRoom* room, ReplayPlayer* player, int slot) {
+    if (player->deck.shipId == 0) return fireProjectileFromBody(&room->projectiles, player->body, room->tick);
+
+    const EntityStateArrays* players = &room->mirror.players;
+    if (!entityStateSlotMatches(players, slot, player->body)) return 0;
+    return fireProjectileFrom(&room->projectiles, (b2Vec2){players->x[slot], players->y[slot]}, players->rot[slot],
+                              (b2Vec2){players->vx[slot], players->vy[slot]}, player->deck.shipId, room->tick);
+}
+
+// Deck pass of the room, over replay players
+static void stepReplayCrew(ReplayRoom* room, float dt) {
+    EntityStateMirror* mirror = &room->mirror;
+    DeckCrewBatch* crew = &room->crew;
+    crew->count = 0;
+
+    for (int i = 0; i < room->playerCount; i++) {
+        ReplayPlayer* player = &room->players[i];
+        if (player->deck.shipId == 0 || !entityStateSlotMatches(&mirror->players, i, player->body)) continue;
+
+        int ship = resolveDeckShip(&player->deck, &mirror->ships);
+        if (ship < 0) {
+            player->body = leaveShip(&player->deck, player->body, &room->cells, &mirror->players, i);
+            if (player->suspended && b2Body_IsValid(player->body)) b2Body_Disable(player->body);
+            repointEntityStateSlot(mirror, &mirror->players, ENTITY_TYPE_PLAYER, i, player->body, player->id,
+                                   room->tick);
+            continue;
+        }
+        addDeckCrew(crew, &player->deck, i, player->suspended ? 0 : player->flags, &mirror->ships,
+                    mirror->ships.bodies[ship]);
+    }
+
+    stepDeckCrewBatch(crew, dt);
+    applyDeckCrewBatch(crew, mirror, room->tick);
+}
+
+// One room tick, in the room's order
+static void stepReplayRoom(ReplayRoom* room, float dt) {
+    PlayerMovementBatch* movement = &room->movement;
+    movement->count = 0;
+    reservePlayerMovementBatch(movement, room->playerCount);
+    for (int i = 0; i < room->playerCount; i++) {
+        ReplayPlayer* player = &room->players[i];
+        if (player->suspended || !b2Body_IsValid(player->body)) continue;
+        if (player->deck.shipId == 0) addPlayerMovement(movement, player->body, player->flags);
+        if ((player->flags & INPUT_ACTION1) && room->tick >= player->nextFireTick &&
+            fireReplayPlayer(room, player, i)) {
+            player->nextFireTick = room->tick + PROJECTILE_FIRE_COOLDOWN;
+        }
+    }
+    computePlayerMovementForces(movement);
+    applyPlayerMovementBatch(movement);
+
+    stepWorldCells(&room->cells, dt, 1);
+    room->tick++;
+    updateWindField(&room->wind, room->tick);
+    syncReplayMirror(room);
+    stepReplayCrew(room, dt);
+    if (room->wake) {
+        room->wake = false;
+        wakeAllDormant(&room->dormancy, &room->mirror, room->tick);
+    }
+    updateDormancy(&room->dormancy, &room->mirror, room->projectiles.lastX, room->projectiles.lastY,
+                   room->projectiles.count, room->tick);
+    collectSailingShips(&room->sailing, &room->ships, &room->mirror.ships, &room->wind);
+    computeSailingForces(&room->sailing);
+    applySailingForces(&room->sailing);
+    stepProjectiles(&room->projectiles, &room->cells, &room->mirror, room->tick, dt);
+    clearProjectileEvents(&room->projectiles);
+}
+
+typedef struct {
+    double* seconds;
+    int count;
+    int capacity;
+} TickTimes;
+
+static bool runReplayTick(ReplayRoom* room, float dt, TickTimes* times, StateHashLog* hashLog) {
+    if (times->count == times->capacity) {
+        int new_capacity = times->capacity ? times->capacity * 2 : 4096;
+        double* seconds = realloc(times->seconds, new_capacity * sizeof(double));
+        if (!seconds) {
+            fprintf(stderr, "[Replay] Out of memory for tick times at tick %u\n", room->tick);
+            return false;
+        }
+        times->seconds = seconds;
+        times->capacity = new_capacity;
+    }
+
+    double start = nowSeconds();
+    stepReplayRoom(room, dt);
+    times->seconds[times->count++] = nowSeconds() - start;
+    recordStateHash(hashLog, room->tick, hashEntityState(&room->mirror));
+    return true;
+}
+
+static int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <journal> [--hash-log <path>] [--threads <n>] [--json]\n", argv[0]);
+        return 2;
+    }
+    const char* hashPath = NULL;
+    int threads = -1;
+    bool json = false;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--hash-log") == 0 && i + 1 < argc) {
+            hashPath = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else {
+            fprintf(stderr, "[Replay] Unknown argument %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    FILE* file = fopen(argv[1], "rb");
+    InputJournalHeader header;
+    if (!file || !readInputJournalHeader(file, &header)) {
+        fprintf(stderr, "[Replay] %s is not an input journal\n", argv[1]);
+        if (file) fclose(file);
+        return 2;
+    }
+    float dt = 1.0f / (header.tickRate ? header.tickRate : 60);
+
+    // Same world settings as the room that wrote the journal
+    ReplayRoom room = {0};
+    room.tick = header.startTick;
+    b2WorldDef worldDef = b2DefaultWorldDef();
+    worldDef.gravity = (b2Vec2){0.0f, 0.0f};
+    worldDef.enableSleep = true;
+    initShipPrototypes();
+    setCollisionMatrix(header.collisionMatrix);
+    if (!initWorldCells(&room.cells, header.cellSize, &worldDef, threads >= 0 ? threads : header.cellThreads,
+                        header.maxCells) ||
+        !initProjectileSystem(&room.projectiles, header.projectilePool) ||
+        !initDormancySystem(&room.dormancy, header.dormancyIdle, dt)) {
+        fprintf(stderr, "[Replay] Failed to set up the room\n");
+        fclose(file);
+        return 2;
+    }
+    initWindField(&room.wind, header.windSpeed, room.tick);
+    room.cells.onMigrate = onReplayBodyMigrated;
+    room.cells.migrateContext = &room;
+    initShipArray(&room.ships, 10);
+
+    StateHashLog hashLog = {0};
+    if (hashPath) openStateHashLog(&hashLog, hashPath, header.room, header.tickRate);
+
+    TickTimes times = {0};
+    uint32_t events = 0;
+    uint32_t endTick = 0;
+    bool ended = false;
+
+    InputJournalEvent event;
+    bool hasEvent = readInputJournalEvent(file, &event);
+    double started = nowSeconds();
+    for (;;) {
+        // Everything tagged for this tick goes in before it's simulated
+        while (hasEvent && event.type != JOURNAL_END && event.tick <= room.tick) {
+            applyJournalEvent(&room, &event);
+            events++;
+            hasEvent = readInputJournalEvent(file, &event);
+        }
+        if (hasEvent && event.type == JOURNAL_END) {
+            endTick = event.tick;
+            ended = true;
+            hasEvent = false;
+        }
+        // Run up to the next event, then on to where a cleanly closed room stopped
+        if (!hasEvent && (!ended || room.tick >= endTick)) break;
+        if (!runReplayTick(&room, dt, &times, &hashLog)) break;
+    }
+    double elapsed = nowSeconds() - started;
+    fclose(file);
+    if (!ended) fprintf(stderr, "[Replay] Journal has no end marker, the room did not shut down cleanly\n");
+
+    int tickCount = times.count;
+    double p50 = 0.0, p99 = 0.0, worst = 0.0;
+    if (tickCount > 0) {
+        qsort(times.seconds, tickCount, sizeof(double), compareDoubles);
+        p50 = times.seconds[tickCount / 2];
+        p99 = times.seconds[(int)(tickCount * 0.99)];
+        worst = times.seconds[tickCount - 1];
+    }
+    if (json) {
+        printf("{\"room\":\"%s\",\"ticks\":%d,\"events\":%u,\"seconds\":%.3f,"
+               "\"p50_ms\":%.4f,\"p99_ms\":%.4f,\"max_ms\":%.4f,\"players\":%d,\"ships\":%d}\n",
+               header.room, tickCount, events, elapsed, p50 * 1e3, p99 * 1e3, worst * 1e3, room.playerCount,
+               room.ships.count);
+    } else {
+        printf("Room '%s': %d ticks, %u events in %.3fs (%.0f ticks/s)\n", header.room, tickCount, events, elapsed,
+               elapsed > 0.0 ? tickCount / elapsed : 0.0);
+        printf("Tick time p50 %.3f ms, p99 %.3f ms, max %.3f ms\n", p50 * 1e3, p99 * 1e3, worst * 1e3);
+        printf("Final state: %d players, %d ships\n", room.playerCount, room.ships.count);
+    }
+
+    closeStateHashLog(&hashLog);
+    free(times.seconds);
+    free(room.players);
+    free(room.ships.ships);
+    freePlayerMovementBatch(&room.movement);
+    freeDeckCrewBatch(&room.crew);
+    freeSailingBatch(&room.sailing);
+    cleanupEntityStateMirror(&room.mirror);
+    cleanupProjectileSystem(&room.projectiles);
+    cleanupDormancySystem(&room.dormancy);
+    cleanupWorldCells(&room.cells);
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Compare two state hash logs tick by tick - exits 0 when every shared tick
+// matches, 1 on the first divergence, 2 when a log can't be read.
+//
+//   state_hash_compare run_a.hash run_b.hash [max_reported]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../core/state_hash.h"
+
+#define DEFAULT_MAX_REPORTED 10
+
+static FILE* openLog(const char* path, StateHashFileHeader* header) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "[StateHash] Can't open %s\n", path);
+        return NULL;
+    }
+    if (fread(header, sizeof(*header), 1, file) != 1 || header->magic != STATE_HASH_MAGIC) {
+        fprintf(stderr, "[StateHash] %s is not a state hash log\n", path);
+        fclose(file);
+        return NULL;
+    }
+    if (header->version != STATE_HASH_VERSION) {
+        fprintf(stderr, "[StateHash] %s is version %u, expected %u\n", path, header->version, STATE_HASH_VERSION);
+        fclose(file);
+        return NULL;
+    }
+    header->room[sizeof(header->room) - 1] = '\0';
+    return file;
+}
+
+static int readRecord(FILE* file, StateHashRecord* record) {
+    return fread(record, sizeof(*record), 1, file) == 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <a.hash> <b.hash> [max_reported]\n", argv[0]);
+        return 2;
+    }
+    int maxReported = argc > 3 ? atoi(argv[3]) : DEFAULT_MAX_REPORTED;
+
+    StateHashFileHeader headerA, headerB;
+    FILE* a = openLog(argv[1], &headerA);
+    FILE* b = a ? openLog(argv[2], &headerB) : NULL;
+    if (!a || !b) {
+        if (a) fclose(a);
+        return 2;
+    }
+    if (headerA.tickRate != headerB.tickRate) {
+        printf("Tick rates differ: %u Hz vs %u Hz\n", headerA.tickRate, headerB.tickRate);
+    }
+
+    // Both logs are in tick order; walk them together and compare shared ticks
+    StateHashRecord ra, rb;
+    int hasA = readRecord(a, &ra);
+    int hasB = readRecord(b, &rb);
+    unsigned long compared = 0, mismatched = 0, onlyA = 0, onlyB = 0;
+    long firstDivergence = -1;
+    while (hasA && hasB) {
+        if (ra.tick < rb.tick) {
+            onlyA++;
+            hasA = readRecord(a, &ra);
+            continue;
+        }
+        if (rb.tick < ra.tick) {
+            onlyB++;
+            hasB = readRecord(b, &rb);
+            continue;
+        }
+        compared++;
+        if (ra.hash != rb.hash) {
+            if (firstDivergence < 0) firstDivergence = ra.tick;
+            if ((long)mismatched < maxReported) {
+                printf("Tick %u: %016llx != %016llx\n", ra.tick, (unsigned long long)ra.hash,
+                       (unsigned long long)rb.hash);
+            }
+            mismatched++;
+        }
+        hasA = readRecord(a, &ra);
+        hasB = readRecord(b, &rb);
+    }
+    while (hasA) {
+        onlyA++;
+        hasA = readRecord(a, &ra);
+    }
+    while (hasB) {
+        onlyB++;
+        hasB = readRecord(b, &rb);
+    }
+    fclose(a);
+    fclose(b);
+
+    printf("Room '%s' vs '%s': %lu ticks compared, %lu mismatched, %lu only in A, %lu only in B\n", headerA.room,
+           headerB.room, compared, mismatched, onlyA, onlyB);
+    if (firstDivergence >= 0) {
+        printf("First divergence at tick %ld\n", firstDivergence);
+        return 1;
+    }
+    printf("Identical\n");
+    return 0;
+}
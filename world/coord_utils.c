@@ -15,11 +15,9 @@ b2Vec2 screenToPhysics(Vector2 screenPos, const Camera2DState* camera) {
     float physX = ((screenPos.x - GetScreenWidth() / 2.0f - camera->offset.x) / (zoom * PIXELS_PER_METER));
     float physY = ((GetScreenHeight() / 2.0f - screenPos.y + camera->offset.y) / (zoom * PIXELS_PER_METER));
     
-    // Validate and clamp coordinates
+    // Validate coordinates - world cells take any finite position
     if (!isfinite(physX)) physX = 0.0f;
     if (!isfinite(physY)) physY = 0.0f;
-    physX = fmaxf(fminf(physX, 1000.0f), -1000.0f);
-    physY = fmaxf(fminf(physY, 1000.0f), -1000.0f);
     
     logDebug("Screen->Physics conversion: (%f,%f) -> (%f,%f)", screenPos.x, screenPos.y, physX, physY);
     
@@ -0,0 +1,124 @@
+#include "spatial_grid.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+static inline int32_t cellCoord(const SpatialGrid* grid, float v) {
+    return (int32_t)floorf(v * grid->invCellSize);
+}
+
+static inline int cellBucket(const SpatialGrid* grid, int32_t cx, int32_t cy) {
+    uint32_t h = (uint32_t)cx * 73856093u ^ (uint32_t)cy * 19349663u;
+    return (int)(h & (uint32_t)grid->bucketMask);
+}
+
+bool initSpatialGrid(SpatialGrid* grid, float cellSize, int bucketCount) {
+    memset(grid, 0, sizeof(SpatialGrid));
+    if (!(cellSize > 0.0f) || bucketCount <= 0 || (bucketCount & (bucketCount - 1)) != 0) {
+        fprintf(stderr, "[Grid] Invalid grid parameters: cell=%.2f buckets=%d\n", cellSize, bucketCount);
+        return false;
+    }
+
+    grid->cellSize = cellSize;
+    grid->invCellSize = 1.0f / cellSize;
+    grid->bucketMask = bucketCount - 1;
+    grid->bucketStart = calloc(bucketCount + 1, sizeof(int));
+    return grid->bucketStart != NULL;
+}
+
+void cleanupSpatialGrid(SpatialGrid* grid) {
+    if (!grid) return;
+    free(grid->bucketStart);
+    free(grid->items);
+    free(grid->itemBucket);
+    free(grid->positions);
+    memset(grid, 0, sizeof(SpatialGrid));
+}
+
+static bool reserveGridItems(SpatialGrid* grid, int count) {
+    if (grid->capacity >= count) return true;
+
+    int new_capacity = grid->capacity ? grid->capacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    int* items = realloc(grid->items, new_capacity * sizeof(int));
+    if (items) grid->items = items;
+    int* buckets = realloc(grid->itemBucket, new_capacity * sizeof(int));
+    if (buckets) grid->itemBucket = buckets;
+    b2Vec2* positions = realloc(grid->positions, new_capacity * sizeof(b2Vec2));
+    if (positions) grid->positions = positions;
+
+    if (!items || !buckets || !positions) {
+        fprintf(stderr, "[Grid] Failed to grow grid to %d items\n", new_capacity);
+        return false;
+    }
+    grid->capacity = new_capacity;
+    return true;
+}
+
+// Counting sort of items by bucket
+void rebuildSpatialGrid(SpatialGrid* grid, const b2Vec2* positions, int count) {
+    int bucketCount = grid->bucketMask + 1;
+    if (!reserveGridItems(grid, count)) count = grid->capacity;
+    grid->count = count;
+
+    memset(grid->bucketStart, 0, (bucketCount + 1) * sizeof(int));
+    for (int i = 0; i < count; i++) {
+        grid->positions[i] = positions[i];
+        int bucket = cellBucket(grid, cellCoord(grid, positions[i].x), cellCoord(grid, positions[i].y));
+        grid->itemBucket[i] = bucket;
+        grid->bucketStart[bucket + 1]++;
+    }
+    for (int b = 0; b < bucketCount; b++) {
+        grid->bucketStart[b + 1] += grid->bucketStart[b];
+    }
+
+    // Scatter using the next free slot of each bucket, then restore the offsets
+    for (int i = 0; i < count; i++) {
+        grid->items[grid->bucketStart[grid->itemBucket[i]]++] = i;
+    }
+    for (int b = bucketCount; b > 0; b--) {
+        grid->bucketStart[b] = grid->bucketStart[b - 1];
+    }
+    grid->bucketStart[0] = 0;
+}
+
+bool moveSpatialGridItem(SpatialGrid* grid, int item, b2Vec2 position) {
+    if (item < 0 || item >= grid->count) return false;
+
+    // Queries filter by the stored position, so a same-bucket move needs nothing else
+    grid->positions[item] = position;
+    int bucket = cellBucket(grid, cellCoord(grid, position.x), cellCoord(grid, position.y));
+    return bucket == grid->itemBucket[item];
+}
+
+int querySpatialGrid(const SpatialGrid* grid, b2Vec2 center, float radius, int* out, int maxOut) {
+    int32_t minX = cellCoord(grid, center.x - radius);
+    int32_t maxX = cellCoord(grid, center.x + radius);
+    int32_t minY = cellCoord(grid, center.y - radius);
+    int32_t maxY = cellCoord(grid, center.y + radius);
+    float radiusSq = radius * radius;
+    int found = 0;
+
+    for (int32_t cy = minY; cy <= maxY; cy++) {
+        for (int32_t cx = minX; cx <= maxX; cx++) {
+            int bucket = cellBucket(grid, cx, cy);
+            for (int i = grid->bucketStart[bucket]; i < grid->bucketStart[bucket + 1]; i++) {
+                int item = grid->items[i];
+                b2Vec2 p = grid->positions[item];
+
+                // Buckets are shared by colliding cells, so filter by the real cell too
+                if (cellCoord(grid, p.x) != cx || cellCoord(grid, p.y) != cy) continue;
+
+                float dx = p.x - center.x;
+                float dy = p.y - center.y;
+                if (dx * dx + dy * dy > radiusSq) continue;
+
+                if (found >= maxOut) return found;
+                out[found++] = item;
+            }
+        }
+    }
+    return found;
+}
@@ -0,0 +1,37 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <box2d/box2d.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Uniform spatial hash over points. Cells are hashed into a fixed
+// power-of-two bucket table, so the world needs no bounds.
+#define SPATIAL_GRID_DEFAULT_BUCKETS 4096
+
+typedef struct {
+    float cellSize;
+    float invCellSize;
+    int bucketMask;        // bucketCount - 1
+    int* bucketStart;      // bucketCount + 1 offsets into items
+    int* items;            // Item indices grouped by bucket
+    int* itemBucket;       // Bucket of each item
+    b2Vec2* positions;     // Item positions as of the last rebuild
+    int count;
+    int capacity;
+} SpatialGrid;
+
+bool initSpatialGrid(SpatialGrid* grid, float cellSize, int bucketCount);
+void cleanupSpatialGrid(SpatialGrid* grid);
+
+// Rebuild from scratch - O(count + buckets)
+void rebuildSpatialGrid(SpatialGrid* grid, const b2Vec2* positions, int count);
+
+// Move one item without a rebuild. Returns false when it changed bucket,
+// in which case the position is stored but a rebuild is needed.
+bool moveSpatialGridItem(SpatialGrid* grid, int item, b2Vec2 position);
+
+// Collect indices of items within radius of center, returns number written
+int querySpatialGrid(const SpatialGrid* grid, b2Vec2 center, float radius, int* out, int maxOut);
+
+#endif // SPATIAL_GRID_H
@@ -0,0 +1,123 @@
+#include "wind_field.h"
+
+#include <math.h>
+#include <string.h>
+
+#define WIND_TWO_PI 6.28318530718f
+
+// Seeded per cell and epoch, the same on every run and platform
+static uint32_t hashCell(uint32_t cell, uint32_t epoch, uint32_t salt) {
+    uint32_t h = cell * 0x9E3779B1u ^ epoch * 0x85EBCA77u ^ salt * 0xC2B2AE3Du;
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return h;
+}
+
+// -1..1, smoothstepped from one epoch's value to the next
+static float blendedNoise(int cell, uint32_t tick, uint32_t epochTicks, uint32_t salt) {
+    uint32_t epoch = tick / epochTicks;
+    float f = (float)(tick % epochTicks) / (float)epochTicks;
+    float s = f * f * (3.0f - 2.0f * f);
+    float a = (float)(hashCell((uint32_t)cell, epoch, salt) & 0xFFFFFF) / (float)0x800000 - 1.0f;
+    float b = (float)(hashCell((uint32_t)cell, epoch + 1, salt) & 0xFFFFFF) / (float)0x800000 - 1.0f;
+    return a + (b - a) * s;
+}
+
+static float prevailingDirection(uint32_t tick) {
+    float phase = (float)(tick % WIND_SWING_TICKS) / (float)WIND_SWING_TICKS;
+    return WIND_SWING * sinf(WIND_TWO_PI * phase);
+}
+
+static void refreshWindRow(WindField* field, int row, uint32_t tick) {
+    float prevailing = prevailingDirection(tick);
+
+    for (int cell = row * WIND_GRID_DIM; cell < (row + 1) * WIND_GRID_DIM; cell++) {
+        float direction = prevailing + WIND_VEER * blendedNoise(cell, tick, WIND_EPOCH_TICKS, 1);
+        float speed = field->meanSpeed * (1.0f + WIND_GUST * blendedNoise(cell, tick, WIND_EPOCH_TICKS, 2));
+        field->windX[cell] = cosf(direction) * speed;
+        field->windY[cell] = sinf(direction) * speed;
+        field->currentX[cell] = CURRENT_SPEED * blendedNoise(cell, tick, CURRENT_EPOCH_TICKS, 3);
+        field->currentY[cell] = CURRENT_SPEED * blendedNoise(cell, tick, CURRENT_EPOCH_TICKS, 4);
+
+        if (field->changedFlag[cell]) continue;
+        // Below the speed threshold the direction is noise
+        float turned = fabsf(remainderf(direction - field->sentDirection[cell], WIND_TWO_PI));
+        if (fabsf(speed - field->sentSpeed[cell]) >= WIND_SEND_SPEED ||
+            (speed >= WIND_SEND_SPEED && turned >= WIND_SEND_DIRECTION)) {
+            field->changedFlag[cell] = 1;
+            field->changed[field->changedCount++] = (uint16_t)cell;
+        }
+    }
+}
+
+void initWindField(WindField* field, float meanSpeed, uint32_t tick) {
+    memset(field, 0, sizeof(WindField));
+    field->meanSpeed = meanSpeed > 0.0f ? meanSpeed : 0.0f;
+
+    // Each row as of its last refresh, so a field built at any tick matches
+    // one that has been updating since tick 0
+    for (int row = 0; row < WIND_GRID_DIM; row++) {
+        uint32_t refreshed = tick >= (uint32_t)row ? tick - (tick - (uint32_t)row) % WIND_GRID_DIM : 0;
+        refreshWindRow(field, row, refreshed);
+    }
+    for (int cell = 0; cell < WIND_GRID_CELLS; cell++) {
+        field->sentDirection[cell] = windCellDirection(field, cell);
+        field->sentSpeed[cell] = windCellSpeed(field, cell);
+        field->changedFlag[cell] = 0;
+    }
+    field->changedCount = 0;
+}
+
+void updateWindField(WindField* field, uint32_t tick) {
+    refreshWindRow(field, (int)(tick % WIND_GRID_DIM), tick);
+}
+
+void sampleWindField(const WindField* field, float x, float y, b2Vec2* wind, b2Vec2* current) {
+    float gx = x / WIND_CELL_SIZE - 0.5f;
+    float gy = y / WIND_CELL_SIZE - 0.5f;
+    float fx = floorf(gx);
+    float fy = floorf(gy);
+    float tx = gx - fx;
+    float ty = gy - fy;
+    int x0 = ((int)fx % WIND_GRID_DIM + WIND_GRID_DIM) % WIND_GRID_DIM;
+    int y0 = ((int)fy % WIND_GRID_DIM + WIND_GRID_DIM) % WIND_GRID_DIM;
+    int x1 = (x0 + 1) % WIND_GRID_DIM;
+    int y1 = (y0 + 1) % WIND_GRID_DIM;
+
+    int c00 = y0 * WIND_GRID_DIM + x0;
+    int c10 = y0 * WIND_GRID_DIM + x1;
+    int c01 = y1 * WIND_GRID_DIM + x0;
+    int c11 = y1 * WIND_GRID_DIM + x1;
+    float w00 = (1.0f - tx) * (1.0f - ty);
+    float w10 = tx * (1.0f - ty);
+    float w01 = (1.0f - tx) * ty;
+    float w11 = tx * ty;
+
+    wind->x = field->windX[c00] * w00 + field->windX[c10] * w10 + field->windX[c01] * w01 + field->windX[c11] * w11;
+    wind->y = field->windY[c00] * w00 + field->windY[c10] * w10 + field->windY[c01] * w01 + field->windY[c11] * w11;
+    current->x = field->currentX[c00] * w00 + field->currentX[c10] * w10 +
+                 field->currentX[c01] * w01 + field->currentX[c11] * w11;
+    current->y = field->currentY[c00] * w00 + field->currentY[c10] * w10 +
+                 field->currentY[c01] * w01 + field->currentY[c11] * w11;
+}
+
+float windCellDirection(const WindField* field, int cell) {
+    return atan2f(field->windY[cell], field->windX[cell]);
+}
+
+float windCellSpeed(const WindField* field, int cell) {
+    return sqrtf(field->windX[cell] * field->windX[cell] + field->windY[cell] * field->windY[cell]);
+}
+
+void markWindChangesSent(WindField* field) {
+    for (int i = 0; i < field->changedCount; i++) {
+        int cell = field->changed[i];
+        field->sentDirection[cell] = windCellDirection(field, cell);
+        field->sentSpeed[cell] = windCellSpeed(field, cell);
+        field->changedFlag[cell] = 0;
+    }
+    field->changedCount = 0;
+}
@@ -0,0 +1,58 @@
+#ifndef WIND_FIELD_H
+#define WIND_FIELD_H
+
+#include <box2d/box2d.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Wind and surface current over a coarse grid that wraps around, so any
+// world position samples it without bounds. One row of cells is refreshed
+// per tick, and every cell's value is a pure function of the tick it was
+// refreshed at, so a replay started at any tick rebuilds the same field.
+// Wind is a prevailing direction that swings slowly over the match, with
+// per-cell gusts and veers blending between seeded values. Vectors point
+// where the air or water is going, in meters/second.
+#define WIND_GRID_DIM 32
+#define WIND_GRID_CELLS (WIND_GRID_DIM * WIND_GRID_DIM)
+#define WIND_CELL_SIZE 500.0f                 // meters, the field repeats every 16km
+#define WIND_DEFAULT_SPEED 8.0f               // Mean wind, meters/second
+#define WIND_GUST 0.35f                       // Cell speed varies by this fraction of the mean
+#define WIND_VEER 0.6f                        // radians either side of the prevailing direction
+#define WIND_SWING 0.8f                       // Prevailing direction swings this far either way
+#define WIND_SWING_TICKS (60 * 60 * 20)       // One swing per 20 minutes at 60Hz
+#define WIND_EPOCH_TICKS 1800                 // Gusts blend to new values every 30s
+#define CURRENT_SPEED 0.6f                    // Strongest surface current per axis, meters/second
+#define CURRENT_EPOCH_TICKS 6000
+
+// Clients hear about a cell once it drifts this far from what they were sent
+#define WIND_SEND_DIRECTION 0.175f            // radians, 10 degrees
+#define WIND_SEND_SPEED 1.0f                  // meters/second
+
+typedef struct {
+    float meanSpeed;
+    float windX[WIND_GRID_CELLS];
+    float windY[WIND_GRID_CELLS];
+    float currentX[WIND_GRID_CELLS];
+    float currentY[WIND_GRID_CELLS];
+    float sentDirection[WIND_GRID_CELLS];     // As clients last heard it
+    float sentSpeed[WIND_GRID_CELLS];
+    uint16_t changed[WIND_GRID_CELLS];        // Cells past the send thresholds
+    uint8_t changedFlag[WIND_GRID_CELLS];
+    int changedCount;
+} WindField;
+
+// Fills every cell as it stands at tick. 0 mean speed is a calm sea,
+// currents still run.
+void initWindField(WindField* field, float meanSpeed, uint32_t tick);
+// Refresh the tick's row, once per tick after the clock advances
+void updateWindField(WindField* field, uint32_t tick);
+
+// Bilinear between cell centers
+void sampleWindField(const WindField* field, float x, float y, b2Vec2* wind, b2Vec2* current);
+
+float windCellDirection(const WindField* field, int cell);
+float windCellSpeed(const WindField* field, int cell);
+// After the changed cells went out: they become the new reference
+void markWindChangesSent(WindField* field);
+
+#endif // WIND_FIELD_H
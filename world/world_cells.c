@@ -0,0 +1,519 @@
+#include "world_cells.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+// Frame of every live cell world, by Box2D world index. Written only when a
+// cell is created or destroyed, between steps.
+static b2Vec2 worldCellOrigins[WORLD_CELL_WORLD_SLOTS];
+
+// Box2D's world table is process-wide and unlocked, and every room's cells
+// come out of it. Creating and destroying worlds is serialised here.
+static pthread_mutex_t worldTableLock = PTHREAD_MUTEX_INITIALIZER;
+static int worldTableUsed;
+
+static inline int32_t cellCoord(const WorldCells* cells, float v) {
+    return (int32_t)floorf(v * cells->invCellSize + 0.5f);
+}
+
+static int findWorldCell(const WorldCells* cells, int32_t cx, int32_t cy) {
+    for (int i = 0; i < cells->cellCount; i++) {
+        if (cells->cells[i].cx == cx && cells->cells[i].cy == cy) return i;
+    }
+    return -1;
+}
+
+static int createWorldCell(WorldCells* cells, int32_t cx, int32_t cy) {
+    if (cells->cellCount >= cells->maxCells) {
+        fprintf(stderr, "[Cells] Cell limit %d reached, can't open cell (%d,%d)\n", cells->maxCells, cx, cy);
+        return -1;
+    }
+
+    pthread_mutex_lock(&worldTableLock);
+    if (worldTableUsed >= WORLD_CELL_WORLD_SLOTS) {
+        pthread_mutex_unlock(&worldTableLock);
+        fprintf(stderr, "[Cells] All %d worlds in use, can't open cell (%d,%d)\n", WORLD_CELL_WORLD_SLOTS, cx, cy);
+        return -1;
+    }
+    b2WorldId worldId = b2CreateWorld(&cells->worldDef);
+    if (!b2World_IsValid(worldId) || worldId.index1 > WORLD_CELL_WORLD_SLOTS) {
+        if (b2World_IsValid(worldId)) b2DestroyWorld(worldId);
+        pthread_mutex_unlock(&worldTableLock);
+        fprintf(stderr, "[Cells] Failed to create world for cell (%d,%d)\n", cx, cy);
+        return -1;
+    }
+    worldTableUsed++;
+    worldCellOrigins[worldId.index1 - 1] = (b2Vec2){cx * cells->cellSize, cy * cells->cellSize};
+    pthread_mutex_unlock(&worldTableLock);
+
+    int index = cells->cellCount++;
+    WorldCell* cell = &cells->cells[index];
+    cell->cx = cx;
+    cell->cy = cy;
+    cell->origin = worldCellOrigins[worldId.index1 - 1];
+    cell->worldId = worldId;
+    cells->worldIds[index] = worldId;
+    return index;
+}
+
+static int worldCellAtCoord(WorldCells* cells, int32_t cx, int32_t cy) {
+    int index = findWorldCell(cells, cx, cy);
+    return index >= 0 ? index : createWorldCell(cells, cx, cy);
+}
+
+static void stepClaimedCells(WorldCells* cells) {
+    for (;;) {
+        int i = atomic_fetch_add(&cells->nextCell, 1);
+        if (i >= cells->stepCount) return;
+        b2World_Step(cells->worldIds[i], cells->stepDt, cells->subSteps);
+        if (atomic_fetch_sub(&cells->remaining, 1) == 1) {
+            pthread_mutex_lock(&cells->lock);
+            pthread_cond_signal(&cells->done);
+            pthread_mutex_unlock(&cells->lock);
+        }
+    }
+}
+
+static void* worldCellWorker(void* data) {
+    WorldCells* cells = data;
+    uint32_t seen = 0;
+
+    pthread_mutex_lock(&cells->lock);
+    for (;;) {
+        while (cells->generation == seen && !cells->stopping) {
+            pthread_cond_wait(&cells->start, &cells->lock);
+        }
+        if (cells->stopping) break;
+        seen = cells->generation;
+        pthread_mutex_unlock(&cells->lock);
+        stepClaimedCells(cells);
+        pthread_mutex_lock(&cells->lock);
+    }
+    pthread_mutex_unlock(&cells->lock);
+    return NULL;
+}
+
+bool initWorldCells(WorldCells* cells, float cellSize, const b2WorldDef* worldDef, int threadCount, int maxCells) {
+    memset(cells, 0, sizeof(WorldCells));
+    if (!(cellSize > 4.0f * WORLD_CELL_GHOST_MARGIN)) {
+        fprintf(stderr, "[Cells] Invalid cell size %.1f, using %.1f\n", cellSize, WORLD_CELL_DEFAULT_SIZE);
+        cellSize = WORLD_CELL_DEFAULT_SIZE;
+    }
+    cells->cellSize = cellSize;
+    cells->maxCells = maxCells > 0 && maxCells < WORLD_CELL_MAX ? maxCells : WORLD_CELL_MAX;
+    cells->invCellSize = 1.0f / cellSize;
+    cells->worldDef = *worldDef;
+    pthread_mutex_init(&cells->lock, NULL);
+    pthread_cond_init(&cells->start, NULL);
+    pthread_cond_init(&cells->done, NULL);
+
+    if (createWorldCell(cells, 0, 0) < 0) return false;
+
+    if (threadCount < 0) threadCount = 0;
+    if (threadCount > WORLD_CELL_MAX_THREADS) threadCount = WORLD_CELL_MAX_THREADS;
+    for (int i = 0; i < threadCount; i++) {
+        if (pthread_create(&cells->threads[i], NULL, worldCellWorker, cells) != 0) {
+            fprintf(stderr, "[Cells] Started %d of %d step workers\n", i, threadCount);
+            break;
+        }
+        cells->threadCount++;
+    }
+    return true;
+}
+
+void cleanupWorldCells(WorldCells* cells) {
+    if (!cells) return;
+
+    pthread_mutex_lock(&cells->lock);
+    cells->stopping = true;
+    pthread_cond_broadcast(&cells->start);
+    pthread_mutex_unlock(&cells->lock);
+    for (int i = 0; i < cells->threadCount; i++) {
+        pthread_join(cells->threads[i], NULL);
+    }
+
+    // Proxies go with their worlds
+    pthread_mutex_lock(&worldTableLock);
+    for (int i = 0; i < cells->cellCount; i++) {
+        b2WorldId worldId = cells->cells[i].worldId;
+        worldCellOrigins[worldId.index1 - 1] = (b2Vec2){0.0f, 0.0f};
+        b2DestroyWorld(worldId);
+    }
+    worldTableUsed -= cells->cellCount;
+    pthread_mutex_unlock(&worldTableLock);
+    free(cells->ghosts);
+    pthread_mutex_destroy(&cells->lock);
+    pthread_cond_destroy(&cells->start);
+    pthread_cond_destroy(&cells->done);
+    memset(cells, 0, sizeof(WorldCells));
+}
+
+int worldCellAt(WorldCells* cells, b2Vec2 position) {
+    return worldCellAtCoord(cells, cellCoord(cells, position.x), cellCoord(cells, position.y));
+}
+
+b2WorldId worldCellWorldAt(WorldCells* cells, b2Vec2 position, b2Vec2* local) {
+    int index = worldCellAt(cells, position);
+    if (index < 0) return b2_nullWorldId;
+
+    const WorldCell* cell = &cells->cells[index];
+    if (local) *local = (b2Vec2){position.x - cell->origin.x, position.y - cell->origin.y};
+    return cell->worldId;
+}
+
+b2Vec2 worldCellOrigin(b2BodyId body) {
+    return body.world0 < WORLD_CELL_WORLD_SLOTS ? worldCellOrigins[body.world0] : (b2Vec2){0.0f, 0.0f};
+}
+
+b2Vec2 worldCellBodyPosition(b2BodyId body) {
+    b2Vec2 origin = worldCellOrigin(body);
+    b2Vec2 p = b2Body_GetPosition(body);
+    return (b2Vec2){origin.x + p.x, origin.y + p.y};
+}
+
+b2Transform worldCellBodyTransform(b2BodyId body) {
+    b2Vec2 origin = worldCellOrigin(body);
+    b2Transform xf = b2Body_GetTransform(body);
+    xf.p.x += origin.x;
+    xf.p.y += origin.y;
+    return xf;
+}
+
+void stepWorldCells(WorldCells* cells, float dt, int subSteps) {
+    if (cells->threadCount == 0 || cells->cellCount == 1) {
+        for (int i = 0; i < cells->cellCount; i++) {
+            b2World_Step(cells->worldIds[i], dt, subSteps);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&cells->lock);
+    cells->stepCount = cells->cellCount;
+    cells->stepDt = dt;
+    cells->subSteps = subSteps;
+    atomic_store(&cells->nextCell, 0);
+    atomic_store(&cells->remaining, cells->cellCount);
+    cells->generation++;
+    pthread_cond_broadcast(&cells->start);
+    pthread_mutex_unlock(&cells->lock);
+
+    stepClaimedCells(cells);
+
+    pthread_mutex_lock(&cells->lock);
+    while (atomic_load(&cells->remaining) > 0) {
+        pthread_cond_wait(&cells->done, &cells->lock);
+    }
+    pthread_mutex_unlock(&cells->lock);
+}
+
+// Same shapes on a new body in another world. Proxies are kinematic and
+// untagged, so nothing else mistakes them for the real body.
+static b2BodyId cloneCellBody(b2BodyId source, b2WorldId worldId, b2Vec2 position, b2Rot rotation, bool proxy) {
+    b2BodyDef bodyDef = b2DefaultBodyDef();
+    bodyDef.position = position;
+    bodyDef.rotation = rotation;
+    if (proxy) {
+        bodyDef.type = b2_kinematicBody;
+    } else {
+        bodyDef.type = b2Body_GetType(source);
+        bodyDef.linearVelocity = b2Body_GetLinearVelocity(source);
+        bodyDef.angularVelocity = b2Body_GetAngularVelocity(source);
+        bodyDef.linearDamping = b2Body_GetLinearDamping(source);
+        bodyDef.angularDamping = b2Body_GetAngularDamping(source);
+        bodyDef.gravityScale = b2Body_GetGravityScale(source);
+        bodyDef.fixedRotation = b2Body_IsFixedRotation(source);
+        bodyDef.isBullet = b2Body_IsBullet(source);
+        bodyDef.userData = b2Body_GetUserData(source);
+    }
+
+    b2BodyId body = b2CreateBody(worldId, &bodyDef);
+    if (!b2Body_IsValid(body)) return b2_nullBodyId;
+
+    b2ShapeId shapes[WORLD_CELL_MAX_SHAPES];
+    int shapeCount = b2Body_GetShapes(source, shapes, WORLD_CELL_MAX_SHAPES);
+    for (int i = 0; i < shapeCount; i++) {
+        b2ShapeDef shapeDef = b2DefaultShapeDef();
+        shapeDef.userData = b2Shape_GetUserData(shapes[i]);
+        shapeDef.density = b2Shape_GetDensity(shapes[i]);
+        shapeDef.friction = b2Shape_GetFriction(shapes[i]);
+        shapeDef.restitution = b2Shape_GetRestitution(shapes[i]);
+        shapeDef.filter = b2Shape_GetFilter(shapes[i]);
+        shapeDef.isSensor = b2Shape_IsSensor(shapes[i]);
+        shapeDef.enableContactEvents = b2Shape_AreContactEventsEnabled(shapes[i]);
+        shapeDef.enableSensorEvents = b2Shape_AreSensorEventsEnabled(shapes[i]);
+
+        switch (b2Shape_GetType(shapes[i])) {
+            case b2_circleShape: {
+                b2Circle circle = b2Shape_GetCircle(shapes[i]);
+                b2CreateCircleShape(body, &shapeDef, &circle);
+                break;
+            }
+            case b2_capsuleShape: {
+                b2Capsule capsule = b2Shape_GetCapsule(shapes[i]);
+                b2CreateCapsuleShape(body, &shapeDef, &capsule);
+                break;
+            }
+            case b2_polygonShape: {
+                b2Polygon polygon = b2Shape_GetPolygon(shapes[i]);
+                b2CreatePolygonShape(body, &shapeDef, &polygon);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return body;
+}
+
+static bool reserveGhosts(WorldCells* cells, int count) {
+    if (cells->ghostCapacity >= count) return true;
+
+    int new_capacity = cells->ghostCapacity ? cells->ghostCapacity : 64;
+    while (new_capacity < count) new_capacity *= 2;
+
+    WorldCellGhost* ghosts = realloc(cells->ghosts, new_capacity * sizeof(WorldCellGhost));
+    if (!ghosts) {
+        fprintf(stderr, "[Cells] Failed to grow ghost proxies to %d\n", new_capacity);
+        return false;
+    }
+    cells->ghosts = ghosts;
+    cells->ghostCapacity = new_capacity;
+    return true;
+}
+
+// First ghost with key in the sorted prefix [0, sorted)
+static int lowerBoundGhost(const WorldCells* cells, uint64_t key, int sorted) {
+    int lo = 0, hi = sorted;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (cells->ghosts[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Removed ghosts stay in place until the pass ends, so lookups hold
+static void removeGhost(WorldCells* cells, int g) {
+    WorldCellGhost* ghost = &cells->ghosts[g];
+    if (b2Body_IsValid(ghost->proxy)) b2DestroyBody(ghost->proxy);
+    ghost->cell = -1;
+}
+
+static bool dropGhosts(WorldCells* cells, uint64_t key, int sorted) {
+    bool removed = false;
+    for (int g = lowerBoundGhost(cells, key, sorted); g < sorted && cells->ghosts[g].key == key; g++) {
+        if (cells->ghosts[g].cell < 0) continue;
+        removeGhost(cells, g);
+        removed = true;
+    }
+    return removed;
+}
+
+static void placeGhost(const WorldCells* cells, const WorldCellGhost* ghost, b2Vec2 global, b2Rot rotation,
+                       b2Vec2 velocity, float angularVelocity) {
+    b2Vec2 origin = cells->cells[ghost->cell].origin;
+    b2Body_SetTransform(ghost->proxy, (b2Vec2){global.x - origin.x, global.y - origin.y}, rotation);
+    b2Body_SetLinearVelocity(ghost->proxy, velocity);
+    b2Body_SetAngularVelocity(ghost->proxy, angularVelocity);
+}
+
+// Proxies in each neighbor whose border the body is within the margin of
+static bool refreshGhosts(WorldCells* cells, int home, const b2BodyMoveEvent* event, int sorted) {
+    const WorldCell* cell = &cells->cells[home];
+    float inner = cells->cellSize * 0.5f - WORLD_CELL_GHOST_MARGIN;
+    b2Vec2 p = event->transform.p;
+    int dx[2] = {0, 0}, dy[2] = {0, 0};
+    int nx = 1, ny = 1;
+    if (p.x > inner) dx[nx++] = 1;
+    else if (p.x < -inner) dx[nx++] = -1;
+    if (p.y > inner) dy[ny++] = 1;
+    else if (p.y < -inner) dy[ny++] = -1;
+
+    int wanted[3];
+    int wantedCount = 0;
+    for (int i = 0; i < nx; i++) {
+        for (int j = 0; j < ny; j++) {
+            if (dx[i] == 0 && dy[j] == 0) continue;
+            int neighbor = worldCellAtCoord(cells, cell->cx + dx[i], cell->cy + dy[j]);
+            if (neighbor >= 0) wanted[wantedCount++] = neighbor;
+        }
+    }
+
+    b2Vec2 global = {cell->origin.x + p.x, cell->origin.y + p.y};
+    b2Vec2 velocity = {0.0f, 0.0f};
+    float angularVelocity = 0.0f;
+    if (!event->fellAsleep) {
+        velocity = b2Body_GetLinearVelocity(event->bodyId);
+        angularVelocity = b2Body_GetAngularVelocity(event->bodyId);
+    }
+
+    uint64_t key = b2StoreBodyId(event->bodyId);
+    bool have[3] = {false, false, false};
+    bool changed = false;
+    for (int g = lowerBoundGhost(cells, key, sorted); g < sorted && cells->ghosts[g].key == key; g++) {
+        if (cells->ghosts[g].cell < 0) continue;
+        int w = 0;
+        while (w < wantedCount && wanted[w] != cells->ghosts[g].cell) w++;
+        if (w == wantedCount) {
+            removeGhost(cells, g);
+            changed = true;
+            continue;
+        }
+        have[w] = true;
+        placeGhost(cells, &cells->ghosts[g], global, event->transform.q, velocity, angularVelocity);
+    }
+
+    // New proxies go past the sorted prefix until the pass ends
+    for (int w = 0; w < wantedCount; w++) {
+        if (have[w] || !reserveGhosts(cells, cells->ghostCount + 1)) continue;
+        b2Vec2 origin = cells->cells[wanted[w]].origin;
+        b2BodyId proxy = cloneCellBody(event->bodyId, cells->cells[wanted[w]].worldId,
+                                       (b2Vec2){global.x - origin.x, global.y - origin.y}, event->transform.q, true);
+        if (!b2Body_IsValid(proxy)) continue;
+
+        WorldCellGhost* ghost = &cells->ghosts[cells->ghostCount++];
+        *ghost = (WorldCellGhost){key, event->bodyId, proxy, wanted[w]};
+        b2Body_SetLinearVelocity(proxy, velocity);
+        b2Body_SetAngularVelocity(proxy, angularVelocity);
+        changed = true;
+    }
+    return changed;
+}
+
+// Recreate the body in the cell it moved into, the old one is destroyed
+static bool migrateBody(WorldCells* cells, int home, const b2BodyMoveEvent* event, int sorted) {
+    b2Vec2 origin = cells->cells[home].origin;
+    b2Vec2 global = {origin.x + event->transform.p.x, origin.y + event->transform.p.y};
+    int target = worldCellAt(cells, global);
+    if (target < 0 || target == home) return false;
+
+    b2Vec2 targetOrigin = cells->cells[target].origin;
+    b2BodyId moved = cloneCellBody(event->bodyId, cells->cells[target].worldId,
+                                   (b2Vec2){global.x - targetOrigin.x, global.y - targetOrigin.y},
+                                   event->transform.q, false);
+    if (!b2Body_IsValid(moved)) return false;
+    // Never destroy a body someone may still hold
+    if (cells->onMigrate && !cells->onMigrate(cells->migrateContext, event->bodyId, moved)) {
+        b2DestroyBody(moved);
+        return false;
+    }
+
+    dropGhosts(cells, b2StoreBodyId(event->bodyId), sorted);
+    b2DestroyBody(event->bodyId);
+    cells->lastMigrations++;
+    return true;
+}
+
+static int compareGhosts(const void* a, const void* b) {
+    uint64_t ka = ((const WorldCellGhost*)a)->key;
+    uint64_t kb = ((const WorldCellGhost*)b)->key;
+    return (ka > kb) - (ka < kb);
+}
+
+void updateWorldCellBorders(WorldCells* cells) {
+    cells->lastMigrations = 0;
+    float inner = cells->cellSize * 0.5f - WORLD_CELL_GHOST_MARGIN;
+    float handoff = cells->cellSize * 0.5f + WORLD_CELL_HANDOFF_MARGIN;
+    int sorted = cells->ghostCount;
+    bool changed = false;
+
+    // Sources destroyed or disabled by their owners since the last pass. A
+    // disabled body sends no more move events, so its proxy would keep
+    // sliding at its last velocity. Proxies come back from the first move
+    // event after the body is enabled again.
+    for (int g = 0; g < sorted; g++) {
+        b2BodyId source = cells->ghosts[g].source;
+        if (cells->ghosts[g].cell >= 0 && (!b2Body_IsValid(source) || !b2Body_IsEnabled(source))) {
+            removeGhost(cells, g);
+            changed = true;
+        }
+    }
+
+    // Only moved bodies can cross a border. Cells opened during the pass
+    // haven't stepped and have no events yet.
+    int cellCount = cells->cellCount;
+    for (int c = 0; c < cellCount; c++) {
+        b2BodyEvents events = b2World_GetBodyEvents(cells->cells[c].worldId);
+        for (int i = 0; i < events.moveCount; i++) {
+            const b2BodyMoveEvent* event = &events.moveEvents[i];
+            // Untagged bodies are proxies. Bodies disabled after the step
+            // stay where they are, without proxies.
+            if (!event->userData || !b2Body_IsValid(event->bodyId) || !b2Body_IsEnabled(event->bodyId)) continue;
+
+            b2Vec2 p = event->transform.p;
+            if ((fabsf(p.x) > handoff || fabsf(p.y) > handoff) && migrateBody(cells, c, event, sorted)) {
+                changed = true;
+                continue;
+            }
+            if (fabsf(p.x) <= inner && fabsf(p.y) <= inner) {
+                if (sorted > 0) changed |= dropGhosts(cells, b2StoreBodyId(event->bodyId), sorted);
+                continue;
+            }
+            changed |= refreshGhosts(cells, c, event, sorted);
+        }
+    }
+
+    if (!changed) return;
+    int kept = 0;
+    for (int g = 0; g < cells->ghostCount; g++) {
+        if (cells->ghosts[g].cell >= 0) cells->ghosts[kept++] = cells->ghosts[g];
+    }
+    cells->ghostCount = kept;
+    qsort(cells->ghosts, kept, sizeof(WorldCellGhost), compareGhosts);
+}
+
+typedef struct {
+    b2CastResultFcn* fcn;
+    void* context;
+    b2Vec2 origin;
+} WorldCellRayContext;
+
+static float worldCellRayCallback(b2ShapeId shapeId, b2Vec2 point, b2Vec2 normal, float fraction, void* context) {
+    WorldCellRayContext* ray = context;
+    b2Vec2 global = {point.x + ray->origin.x, point.y + ray->origin.y};
+    return ray->fcn(shapeId, global, normal, fraction, ray->context);
+}
+
+void castWorldCellsRay(const WorldCells* cells, b2Vec2 origin, b2Vec2 translation, b2QueryFilter filter,
+                       b2CastResultFcn* fcn, void* context) {
+    // Bodies reach at most the ghost margin past their cell's border
+    float minX = fminf(origin.x, origin.x + translation.x) - WORLD_CELL_GHOST_MARGIN;
+    float maxX = fmaxf(origin.x, origin.x + translation.x) + WORLD_CELL_GHOST_MARGIN;
+    float minY = fminf(origin.y, origin.y + translation.y) - WORLD_CELL_GHOST_MARGIN;
+    float maxY = fmaxf(origin.y, origin.y + translation.y) + WORLD_CELL_GHOST_MARGIN;
+
+    for (int32_t cx = cellCoord(cells, minX); cx <= cellCoord(cells, maxX); cx++) {
+        for (int32_t cy = cellCoord(cells, minY); cy <= cellCoord(cells, maxY); cy++) {
+            int index = findWorldCell(cells, cx, cy);
+            if (index < 0) continue;
+
+            const WorldCell* cell = &cells->cells[index];
+            WorldCellRayContext ray = {fcn, context, cell->origin};
+            b2Vec2 local = {origin.x - cell->origin.x, origin.y - cell->origin.y};
+            b2World_CastRay(cell->worldId, local, translation, filter, worldCellRayCallback, &ray);
+        }
+    }
+}
+
+void overlapWorldCellsAABB(const WorldCells* cells, b2AABB box, b2QueryFilter filter, b2OverlapResultFcn* fcn,
+                           void* context) {
+    float minX = box.lowerBound.x - WORLD_CELL_GHOST_MARGIN;
+    float maxX = box.upperBound.x + WORLD_CELL_GHOST_MARGIN;
+    float minY = box.lowerBound.y - WORLD_CELL_GHOST_MARGIN;
+    float maxY = box.upperBound.y + WORLD_CELL_GHOST_MARGIN;
+
+    for (int32_t cx = cellCoord(cells, minX); cx <= cellCoord(cells, maxX); cx++) {
+        for (int32_t cy = cellCoord(cells, minY); cy <= cellCoord(cells, maxY); cy++) {
+            int index = findWorldCell(cells, cx, cy);
+            if (index < 0) continue;
+
+            b2Vec2 origin = cells->cells[index].origin;
+            b2AABB local = {
+                {box.lowerBound.x - origin.x, box.lowerBound.y - origin.y},
+                {box.upperBound.x - origin.x, box.upperBound.y - origin.y}
+            };
+            b2World_OverlapAABB(cells->cells[index].worldId, local, filter, fcn, context);
+        }
+    }
+}
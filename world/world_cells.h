@@ -0,0 +1,119 @@
+#ifndef WORLD_CELLS_H
+#define WORLD_CELLS_H
+
+#include <box2d/box2d.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// The world is split into fixed-size square cells, each its own b2World with
+// a frame centered on the cell, so positions keep full float precision at
+// any distance and the cells step side by side on worker threads. Global
+// position = cell origin + local position. Cell (0,0) is centered on the
+// global origin and always exists; the rest are created on demand.
+//
+// A body crossing a border by more than the handoff margin is recreated in
+// the neighbor cell. A body within the ghost margin of a border gets a
+// kinematic proxy in the neighbor, so bodies on either side still collide -
+// each side is pushed by the other's proxy. Disabled bodies lose their
+// proxies until they move again.
+#define WORLD_CELL_DEFAULT_SIZE 1000.0f
+#define WORLD_CELL_MAX 64                // Per set of cells
+#define WORLD_CELL_WORLD_SLOTS 128       // Box2D's live world limit, shared by every set in the process
+#define WORLD_CELL_GHOST_MARGIN 8.0f     // Must cover the largest body's extent plus a step of travel
+#define WORLD_CELL_HANDOFF_MARGIN 2.0f   // Past the border before a body migrates, avoids ping-pong
+#define WORLD_CELL_MAX_SHAPES 16         // Per migrated or ghosted body
+#define WORLD_CELL_MAX_THREADS 8
+
+typedef struct {
+    int32_t cx;
+    int32_t cy;
+    b2Vec2 origin;                       // Global position of local (0,0)
+    b2WorldId worldId;
+} WorldCell;
+
+typedef struct {
+    uint64_t key;                        // b2StoreBodyId of the source
+    b2BodyId source;                     // Real body in its home cell
+    b2BodyId proxy;                      // Kinematic copy
+    int cell;                            // Cell holding the proxy, -1 once removed
+} WorldCellGhost;
+
+// Called when a body is recreated in another cell. Owners holding the old
+// id must switch to the new one; user data is carried over. Returning false
+// means nothing owns it: the copy is destroyed and the original stays put.
+typedef bool WorldCellMigrateFcn(void* context, b2BodyId from, b2BodyId to);
+
+typedef struct {
+    float cellSize;
+    float invCellSize;
+    b2WorldDef worldDef;                 // Template for new cells
+    WorldCell cells[WORLD_CELL_MAX];
+    int cellCount;
+    int maxCells;                        // This set's share of the world table
+    b2WorldId worldIds[WORLD_CELL_MAX];  // Parallel to cells
+
+    WorldCellGhost* ghosts;              // Sorted by key between border passes
+    int ghostCount;
+    int ghostCapacity;
+
+    WorldCellMigrateFcn* onMigrate;
+    void* migrateContext;
+    int lastMigrations;                  // Bodies handed off by the last border pass
+
+    // Step workers - the calling thread claims cells too
+    pthread_t threads[WORLD_CELL_MAX_THREADS];
+    int threadCount;
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    uint32_t generation;
+    bool stopping;
+    int stepCount;
+    float stepDt;
+    int subSteps;
+    atomic_int nextCell;
+    atomic_int remaining;
+} WorldCells;
+
+// maxCells caps the cells this set may open, 0 for WORLD_CELL_MAX. Sets
+// sharing the process should split WORLD_CELL_WORLD_SLOTS between them;
+// cells beyond what the table has left are refused either way.
+bool initWorldCells(WorldCells* cells, float cellSize, const b2WorldDef* worldDef, int threadCount, int maxCells);
+void cleanupWorldCells(WorldCells* cells);
+
+// Index of the cell containing a global position, creating it if needed.
+// -1 once the set is at maxCells or the world table is full.
+int worldCellAt(WorldCells* cells, b2Vec2 position);
+
+// World to create a body in for a global position, with the local position
+// to create it at. b2_nullWorldId when no cell can hold it.
+b2WorldId worldCellWorldAt(WorldCells* cells, b2Vec2 position, b2Vec2* local);
+
+// Global frame of any body - Box2D ids carry their world index, so this is
+// one table lookup. Bodies of worlds outside a cell set read as global.
+b2Vec2 worldCellOrigin(b2BodyId body);
+b2Vec2 worldCellBodyPosition(b2BodyId body);
+b2Transform worldCellBodyTransform(b2BodyId body);
+
+// Step every cell, in parallel when workers are running
+void stepWorldCells(WorldCells* cells, float dt, int subSteps);
+
+// After the step's move events are consumed: hand off bodies that left
+// their cell and refresh proxies near borders
+void updateWorldCellBorders(WorldCells* cells);
+
+// Ray cast in global coordinates across every cell the ray comes near.
+// Points reach the callback in global coordinates; each cell is cast
+// separately, so the callback must keep the closest hit itself.
+void castWorldCellsRay(const WorldCells* cells, b2Vec2 origin, b2Vec2 translation, b2QueryFilter filter,
+                       b2CastResultFcn* fcn, void* context);
+
+// AABB overlap in global coordinates across every cell the box comes near.
+// Shapes reach the callback from their own cell's world; worldCellOrigin of
+// the shape's body gives its frame. Returning false stops the current cell.
+void overlapWorldCellsAABB(const WorldCells* cells, b2AABB box, b2QueryFilter filter, b2OverlapResultFcn* fcn,
+                           void* context);
+
+#endif // WORLD_CELLS_H